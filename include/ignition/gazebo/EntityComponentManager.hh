@@ -20,6 +20,8 @@
 #include <ignition/msgs/serialized.pb.h>
 #include <ignition/msgs/serialized_map.pb.h>
 
+#include <cstddef>
+#include <functional>
 #include <map>
 #include <memory>
 #include <optional>
@@ -32,6 +34,7 @@
 #include <vector>
 
 #include <ignition/common/Console.hh>
+#include <ignition/math/Pose3.hh>
 #include <ignition/math/graph/Graph.hh>
 #include "ignition/gazebo/Entity.hh"
 #include "ignition/gazebo/Export.hh"
@@ -48,6 +51,7 @@ namespace ignition
     inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     // Forward declarations.
     class IGNITION_GAZEBO_HIDDEN EntityComponentManagerPrivate;
+    class ThreadPool;
 
     /// \brief Type alias for the graph that holds entities.
     /// Each vertex is an entity, and the direction points from the parent to
@@ -151,6 +155,25 @@ namespace ignition
       /// \return True if successful. Will fail if entities don't exist.
       public: bool SetParentEntity(const Entity _child, const Entity _parent);
 
+      /// \brief Get the pose of an entity in the world frame. This composes
+      /// the `components::Pose` of the entity with those of its ancestors,
+      /// following `components::ParentEntity` up to the first entity without
+      /// a parent or a pose.
+      ///
+      /// \details Results are cached, so repeated lookups are cheap. Use
+      /// the worldPose() helper instead for a pose computed from the current
+      /// components on every call. The cache is invalidated whenever a
+      /// `Pose` or `ParentEntity` component is created, removed, set through
+      /// SetComponentData or marked as changed through SetChanged, and by
+      /// the simulation runner before each update phase. A pose modified
+      /// directly through a component pointer, for example within Each, is
+      /// not reflected until the next phase unless it's marked as changed
+      /// through SetChanged.
+      /// \param[in] _entity Entity to get the world pose for.
+      /// \return World pose, or std::nullopt if the entity doesn't have a
+      /// `Pose` component.
+      public: std::optional<math::Pose3d> WorldPose(const Entity _entity) const;
+
       /// \brief Get whether a component type has ever been created.
       /// \param[in] _typeId ID of the component type to check.
       /// \return True if the provided _typeId has been created.
@@ -353,6 +376,26 @@ namespace ignition
               std::vector<Entity> ChildrenByComponents(Entity _parent,
                    const ComponentTypeTs &..._desiredComponents) const;
 
+      /// \brief Maintain an index on the value of components of the given
+      /// type, so that EntityByComponents and EntitiesByComponents queries
+      /// which include such a component don't need to go through all
+      /// entities. For example:
+      ///
+      ///  ecm.EnableComponentIndex<components::Name>();
+      ///  auto entity = ecm.EntityByComponents(components::Name("name"),
+      ///    components::Model());
+      ///
+      /// \details The component's data type must be hashable with
+      /// `std::hash`. The index is updated when components are created or
+      /// removed, set with SetComponentData or SetState, or flagged with
+      /// SetChanged. Values modified through a pointer, such as those
+      /// returned by Component or passed to the callbacks of the non-const
+      /// Each, EachNew and EachParallel, must be flagged with SetChanged to
+      /// be picked up, otherwise queries may miss the entity. This function
+      /// must not be called concurrently with other calls to the ECM.
+      public: template<typename ComponentTypeT>
+              void EnableComponentIndex();
+
       /// why is this required?
       private: template <typename T>
                struct identity;  // NOLINT
@@ -425,6 +468,45 @@ namespace ignition
                   bool(const Entity &_entity,
                        ComponentTypeTs *...)>>::type _f);
 
+      /// \brief Parallel version of Each(). The matching entities are split
+      /// into chunks which are processed concurrently on a pool of worker
+      /// threads, including the calling thread, and the call returns once all
+      /// entities have been visited. The order of the callbacks is undefined.
+      ///
+      /// Since callbacks run concurrently, they may only:
+      /// * Read the components they receive;
+      /// * Read other components and ECM state through const functions, as
+      /// long as no callback writes to them;
+      /// * Keep their results in per-entity or thread-safe storage.
+      ///
+      /// Anything which modifies the ECM, such as creating or removing
+      /// entities and components, calling SetChanged or calling Each, must
+      /// be done after EachParallel returns.
+      /// \param[in] _f Callback function to be called for each matching
+      /// entity. The function parameter are all the desired component types,
+      /// in the order they're listed on the template.
+      /// \tparam ComponentTypeTs All the desired component types.
+      /// \warning This function should not be called outside of System's
+      /// PreUpdate, Update, or PostUpdate callbacks.
+      public: template<typename ...ComponentTypeTs>
+              void EachParallel(typename identity<std::function<
+                  void(const Entity &_entity,
+                       const ComponentTypeTs *...)>>::type _f) const;
+
+      /// \brief Parallel version of Each() with mutable components. The
+      /// same rules as the const version apply, plus callbacks may modify
+      /// the components they receive, and only those.
+      /// \param[in] _f Callback function to be called for each matching
+      /// entity. The function parameter are all the desired component types,
+      /// in the order they're listed on the template.
+      /// \tparam ComponentTypeTs All the desired mutable component types.
+      /// \warning This function should not be called outside of System's
+      /// PreUpdate, Update, or PostUpdate callbacks.
+      public: template<typename ...ComponentTypeTs>
+              void EachParallel(typename identity<std::function<
+                  void(const Entity &_entity,
+                       ComponentTypeTs *...)>>::type _f);
+
       /// \brief Call a function for each parameter in a pack.
       /// \param[in] _f Function to be called.
       /// \param[in] _components Parameters which should be passed to the
@@ -766,6 +848,61 @@ namespace ignition
           Entity _entity,
           const std::unordered_set<ComponentTypeId> &_types = {}) const;
 
+      /// \brief Process the range [0, _count) in chunks on the thread pool,
+      /// blocking until all chunks are done. Used by EachParallel.
+      /// \param[in] _count Number of items.
+      /// \param[in] _f Function called with each half-open range of items.
+      private: void ParallelFor(const size_t _count,
+          const std::function<void(size_t _begin, size_t _end)> &_f) const;
+
+      /// \brief Invalidate cached world poses if a component type affects
+      /// them.
+      /// \param[in] _typeId Type of the component that was modified.
+      private: void InvalidateWorldPoses(const ComponentTypeId _typeId);
+
+      /// \brief Invalidate all cached world poses. Called by the runners
+      /// before update phases, to pick up poses modified through component
+      /// pointers.
+      private: void InvalidateWorldPoses();
+
+      /// \brief Implementation of EnableComponentIndex.
+      /// \param[in] _typeId Type of the indexed component.
+      /// \param[in] _hash Function which hashes a component's value.
+      private: void EnableComponentIndex(const ComponentTypeId _typeId,
+          std::function<std::size_t(const components::BaseComponent *)>
+          _hash);
+
+      /// \brief Get the entities whose component of the given type has a
+      /// value with the given hash, according to the index.
+      /// \param[in] _typeId Component type.
+      /// \param[in] _hash Hash of the component value.
+      /// \return Candidate entities in ascending order, which still need to
+      /// be compared against the value, or nullopt if the type isn't
+      /// indexed.
+      private: std::optional<std::vector<Entity>> IndexedEntities(
+          const ComponentTypeId _typeId, const std::size_t _hash) const;
+
+      /// \brief Flag a component to be re-indexed by the next indexed
+      /// query, if its type is indexed.
+      /// \param[in] _entity Entity whose component may have changed.
+      /// \param[in] _typeId Type of the component.
+      private: void MarkIndexDirty(const Entity _entity,
+          const ComponentTypeId _typeId);
+
+      /// \brief Get the candidate entities for a query from the index of
+      /// the first indexed component among the desired components.
+      /// \param[in] _desiredComponents Components being queried.
+      /// \return Candidate entities, or nullopt if none of the components
+      /// is indexed.
+      private: template<typename ...ComponentTypeTs>
+               std::optional<std::vector<Entity>> IndexCandidates(
+                   const ComponentTypeTs &..._desiredComponents) const;
+
+      /// \brief Set the thread pool used by EachParallel. If never set, a
+      /// pool is created the first time one is needed.
+      /// \param[in] _pool Thread pool, usually owned by the runner.
+      private: void SetThreadPool(std::shared_ptr<ThreadPool> _pool);
+
       /// \brief Private data pointer.
       private: std::unique_ptr<EntityComponentManagerPrivate> dataPtr;
 
@@ -228,6 +228,23 @@ namespace ignition
       /// \sa SetNetworkRole(const std::string &_role)
       public: std::string NetworkRole() const;
 
+      /// \brief Set the number of steps network secondaries may run ahead
+      /// of the primary. With the default of zero, the primary waits for all
+      /// secondaries to finish a step before stepping its own systems. With
+      /// a larger value, secondaries compute the following steps while the
+      /// primary merges their previous states, so the primary sees the
+      /// secondaries' entities up to this many steps late. This value is
+      /// valid only when SetNetworkRole("primary") is also used.
+      /// \param[in] _staleness Maximum number of unacknowledged steps.
+      /// \sa NetworkMaxStaleness() const
+      public: void SetNetworkMaxStaleness(unsigned int _staleness);
+
+      /// \brief Get the number of steps network secondaries may run ahead
+      /// of the primary.
+      /// \return Maximum number of unacknowledged steps.
+      /// \sa SetNetworkMaxStaleness(unsigned int _staleness)
+      public: unsigned int NetworkMaxStaleness() const;
+
       /// \brief Get whether the server is recording states
       /// \return True if the server is set to record states
       public: bool UseLogRecord() const;
@@ -299,6 +316,20 @@ namespace ignition
       /// \param[in] _seed The seed.
       public: void SetSeed(unsigned int _seed);
 
+      /// \brief Get the number of worker threads used for parallel work,
+      /// such as EntityComponentManager::EachParallel and state
+      /// serialization.
+      /// \return The number of worker threads, or 0 if it should be chosen
+      /// based on the hardware.
+      public: unsigned int WorkerThreads() const;
+
+      /// \brief Set the number of worker threads used for parallel work.
+      /// The thread which calls into the pool also takes part in the work,
+      /// so 1 worker thread means up to 2 threads working.
+      /// \param[in] _threads Number of worker threads, or 0 to choose based
+      /// on the hardware.
+      public: void SetWorkerThreads(unsigned int _threads);
+
       /// \brief Get the update period duration.
       /// \return The desired update period, or nullopt if
       /// an UpdateRate has not been set.
@@ -18,6 +18,7 @@
 #define IGNITION_GAZEBO_SYSTEM_HH_
 
 #include <memory>
+#include <unordered_set>
 
 #include <ignition/gazebo/config.hh>
 #include <ignition/gazebo/EntityComponentManager.hh>
@@ -114,6 +115,55 @@ namespace ignition
                                   EntityComponentManager &_ecm) = 0;
     };
 
+    /// \class ISystemComponentAccess ISystem.hh ignition/gazebo/System.hh
+    /// \brief Optional interface for systems which declare the component
+    /// types they access during PreUpdate and Update.
+    ///
+    /// Within each of those phases, systems are normally called one at a
+    /// time, in the order they were loaded. Systems implementing this
+    /// interface may instead run concurrently with other systems implementing
+    /// it, as long as neither of them writes a component type the other one
+    /// reads or writes. Conflicting systems keep their load order. Systems
+    /// which don't implement this interface are never run concurrently with
+    /// other systems.
+    ///
+    /// To be run concurrently, a system's PreUpdate and Update must:
+    ///  * Only access components of the declared types.
+    ///  * Not create or remove entities or components, unless
+    ///    NeedsExclusiveAccess returned true before that phase.
+    ///
+    /// Components may be marked as changed with
+    /// EntityComponentManager::SetChanged.
+    class ISystemComponentAccess {
+      /// \brief Component types which are read, but not modified, during
+      /// PreUpdate and Update.
+      /// \return Component type ids.
+      public: virtual std::unordered_set<ComponentTypeId>
+                  ReadComponents() const = 0;
+
+      /// \brief Component types which are modified during PreUpdate and
+      /// Update.
+      /// \return Component type ids.
+      public: virtual std::unordered_set<ComponentTypeId>
+                  WriteComponents() const = 0;
+
+      /// \brief Called before each PreUpdate and Update phase the system
+      /// takes part in. If any system of the phase returns true, all systems
+      /// of that phase are run one at a time, in the order they were loaded,
+      /// so they may access any component and create or remove entities and
+      /// components.
+      /// \param[in] _ecm Entity component manager, as it will be at the
+      /// start of the phase.
+      /// \return True if the system needs exclusive access to the entity
+      /// component manager during the coming phase.
+      public: virtual bool NeedsExclusiveAccess(
+                  const EntityComponentManager &_ecm)
+      {
+        (void)_ecm;
+        return false;
+      }
+    };
+
     /// \class ISystemPostUpdate ISystem.hh ignition/gazebo/System.hh
     /// \brief Interface for a system that uses the PostUpdate phase
     class ISystemPostUpdate{
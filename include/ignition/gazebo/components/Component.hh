@@ -18,9 +18,13 @@
 #define IGNITION_GAZEBO_COMPONENTS_COMPONENT_HH_
 
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <sstream>
+#include <streambuf>
+#include <type_traits>
+#include <typeinfo>
 #include <utility>
 
 #include <ignition/common/Console.hh>
@@ -96,6 +100,131 @@ namespace traits
     public: static constexpr bool value =  // NOLINT
                 decltype(Test<Stream, DataType>(0))::value;
   };
+
+  /// \brief Type trait that determines if `Serializer` can serialize
+  /// `DataType` straight into a string, i.e, it checks if the function
+  /// `static void Serializer::Serialize(std::string&, const DataType&)`
+  /// exists. For serializers of components without data, leave `DataTypes`
+  /// empty.
+  template <typename Serializer, typename ...DataTypes>
+  class HasStringSerialize
+  {
+    private: template <typename SerializerArg>
+    static auto Test(int _test)
+      -> decltype(SerializerArg::Serialize(std::declval<std::string &>(),
+                      std::declval<const DataTypes &>()...),
+                  std::true_type());
+
+    private: template <typename>
+    static auto Test(...) -> std::false_type;
+
+    public: static constexpr bool value =  // NOLINT
+                decltype(Test<Serializer>(0))::value;
+  };
+}
+
+namespace serializers
+{
+  /// \brief Stream buffer which appends everything written to it to a
+  /// string. Writes are gathered in a small local buffer, so that stream
+  /// operators which write one character at a time stay cheap.
+  class StringStreamBuffer : public std::streambuf
+  {
+    /// \brief Constructor
+    /// \param[in] _str String to append to.
+    public: explicit StringStreamBuffer(std::string &_str) : str(_str)
+    {
+      this->setp(this->buffer, this->buffer + sizeof(this->buffer));
+    }
+
+    /// \brief Destructor. Flushes pending characters to the string.
+    public: ~StringStreamBuffer() override
+    {
+      this->Flush();
+    }
+
+    /// \brief Append the buffered characters to the string.
+    public: void Flush()
+    {
+      this->str.append(this->pbase(), this->pptr() - this->pbase());
+      this->setp(this->buffer, this->buffer + sizeof(this->buffer));
+    }
+
+    // Documentation inherited
+    protected: int_type overflow(int_type _c) override
+    {
+      this->Flush();
+      if (!traits_type::eq_int_type(_c, traits_type::eof()))
+        this->str.push_back(traits_type::to_char_type(_c));
+      return traits_type::not_eof(_c);
+    }
+
+    // Documentation inherited
+    protected: std::streamsize xsputn(const char *_s,
+                   std::streamsize _n) override
+    {
+      if (_n > this->epptr() - this->pptr())
+      {
+        this->Flush();
+        this->str.append(_s, static_cast<size_t>(_n));
+      }
+      else
+      {
+        std::memcpy(this->pptr(), _s, static_cast<size_t>(_n));
+        this->pbump(static_cast<int>(_n));
+      }
+      return _n;
+    }
+
+    // Documentation inherited
+    protected: int sync() override
+    {
+      this->Flush();
+      return 0;
+    }
+
+    /// \brief String being written to.
+    private: std::string &str;
+
+    /// \brief Characters not yet appended to the string.
+    private: char buffer[256];
+  };
+
+  /// \brief Call a stream based serialization function, writing its output
+  /// straight into a string instead of going through an intermediate
+  /// std::ostringstream. The stream is reused across calls on the same
+  /// thread, with its formatting reset to the defaults.
+  /// \param[out] _out String which will hold the output. Its previous
+  /// contents are discarded, but its capacity is reused.
+  /// \param[in] _f Function which writes to the std::ostream it receives.
+  template <typename FunctionT>
+  void StreamToString(std::string &_out, const FunctionT &_f)
+  {
+    _out.clear();
+    StringStreamBuffer buffer(_out);
+
+    // Constructing a stream initializes its locale, so reuse one per thread
+    // unless a serializer calls this recursively.
+    static thread_local std::ostream stream(nullptr);
+    static thread_local bool inUse{false};
+    if (inUse)
+    {
+      std::ostream nested(&buffer);
+      _f(nested);
+      return;
+    }
+
+    inUse = true;
+    stream.rdbuf(&buffer);
+    stream.clear();
+    stream.flags(std::ios_base::skipws | std::ios_base::dec);
+    stream.precision(6);
+    stream.width(0);
+    stream.fill(' ');
+    _f(stream);
+    stream.rdbuf(nullptr);
+    inUse = false;
+  }
 }
 
 namespace serializers
@@ -151,6 +280,40 @@ namespace serializers
       return _out;
     }
 
+    /// \brief Serialization straight into a string. Produces the same
+    /// output as the stream version, skipping the stream for integers,
+    /// booleans and strings.
+    /// \param[out] _out String to hold the serialized data. Its previous
+    /// contents are replaced.
+    /// \param[in] _data Data to serialize.
+    public: static void Serialize(std::string &_out, const DataType &_data)
+    {
+      if constexpr (std::is_same_v<DataType, bool>)
+      {
+        // Streams print booleans as numbers unless std::boolalpha is set
+        _out.assign(1, _data ? '1' : '0');
+      }
+      else if constexpr (std::is_integral_v<DataType> &&
+          sizeof(DataType) > 1 &&
+          !std::is_same_v<DataType, wchar_t> &&
+          !std::is_same_v<DataType, char16_t> &&
+          !std::is_same_v<DataType, char32_t>)
+      {
+        _out = std::to_string(_data);
+      }
+      else if constexpr (std::is_same_v<DataType, std::string>)
+      {
+        _out = _data;
+      }
+      else
+      {
+        StreamToString(_out, [&_data](std::ostream &_stream)
+        {
+          Serialize(_stream, _data);
+        });
+      }
+    }
+
     /// \brief Deserialization
     /// \param[in] _in In stream.
     /// \param[in] _data Data resulting from deserialization.
@@ -217,6 +380,11 @@ namespace serializers
       return _out;
     }
 
+    public: static void Serialize(std::string &_out)
+    {
+      _out.assign(1, '-');
+    }
+
     public: static std::istream &Deserialize(std::istream &_in)
     {
       return _in;
@@ -254,6 +422,21 @@ namespace components
       }
     };
 
+    /// \brief Fills a string with a serialized version of the component,
+    /// such as the `component` field of a protobuf message. The output is
+    /// the same as Serialize(std::ostream &), but no intermediate stream or
+    /// copy is needed.
+    ///
+    /// \param[out] _out String to be filled. Its previous contents are
+    /// replaced, but its capacity is reused.
+    public: virtual void SerializeToString(std::string &_out) const
+    {
+      serializers::StreamToString(_out, [this](std::ostream &_stream)
+      {
+        this->Serialize(_stream);
+      });
+    }
+
     /// \brief Fills a component based on a stream with a serialized data.
     /// By default, it will do nothing. Derived classes should
     /// override this function to support deserialization.
@@ -348,6 +531,9 @@ namespace components
     // Documentation inherited
     public: void Serialize(std::ostream &_out) const override;
 
+    // Documentation inherited
+    public: void SerializeToString(std::string &_out) const override;
+
     // Documentation inherited
     public: void Deserialize(std::istream &_in) override;
 
@@ -414,6 +600,9 @@ namespace components
     // Documentation inherited
     public: void Serialize(std::ostream &_out) const override;
 
+    // Documentation inherited
+    public: void SerializeToString(std::string &_out) const override;
+
     // Documentation inherited
     public: void Deserialize(std::istream &_in) override;
 
@@ -482,6 +671,24 @@ namespace components
     Serializer::Serialize(_out, this->Data());
   }
 
+  //////////////////////////////////////////////////
+  template <typename DataType, typename Identifier, typename Serializer>
+  void Component<DataType, Identifier, Serializer>::SerializeToString(
+      std::string &_out) const
+  {
+    // Classes deriving from Component may have overridden Serialize, in
+    // which case the serializer can't be used directly.
+    if constexpr (traits::HasStringSerialize<Serializer, DataType>::value)
+    {
+      if (typeid(*this) == typeid(Component))
+      {
+        Serializer::Serialize(_out, this->Data());
+        return;
+      }
+    }
+    BaseComponent::SerializeToString(_out);
+  }
+
   //////////////////////////////////////////////////
   template <typename DataType, typename Identifier, typename Serializer>
   void Component<DataType, Identifier, Serializer>::Deserialize(
@@ -528,6 +735,22 @@ namespace components
     Serializer::Serialize(_out);
   }
 
+  //////////////////////////////////////////////////
+  template <typename Identifier, typename Serializer>
+  void Component<NoData, Identifier, Serializer>::SerializeToString(
+      std::string &_out) const
+  {
+    if constexpr (traits::HasStringSerialize<Serializer>::value)
+    {
+      if (typeid(*this) == typeid(Component))
+      {
+        Serializer::Serialize(_out);
+        return;
+      }
+    }
+    BaseComponent::SerializeToString(_out);
+  }
+
   //////////////////////////////////////////////////
   template <typename Identifier, typename Serializer>
   void Component<NoData, Identifier, Serializer>::Deserialize(
@@ -22,6 +22,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include <ignition/common/SingletonT.hh>
@@ -78,16 +79,22 @@ namespace components
 
   /// \brief A class for an object responsible for creating storages.
   /// \tparam ComponentTypeT type of component that the storage will hold.
-  template <typename ComponentTypeT>
+  /// \tparam StorageTypeT type of storage, which must derive from
+  /// ComponentStorageBase. Defaults to ComponentStorage<ComponentTypeT>.
+  template <typename ComponentTypeT,
+            typename StorageTypeT = ComponentStorage<ComponentTypeT>>
   class StorageDescriptor
     : public StorageDescriptorBase
   {
+    static_assert(std::is_base_of<ComponentStorageBase, StorageTypeT>::value,
+        "StorageTypeT must derive from ComponentStorageBase");
+
     /// \brief Create an instance of a storage that holds ComponentTypeT
     /// components.
     /// \return Pointer to a component.
     public: std::unique_ptr<ComponentStorageBase> Create() const override
     {
-      return std::make_unique<ComponentStorage<ComponentTypeT>>();
+      return std::make_unique<StorageTypeT>();
     }
   };
 
@@ -327,6 +334,22 @@ namespace components
   /// \param[in] _compType Component type name.
   /// \param[in] _classname Class name for component.
   #define IGN_GAZEBO_REGISTER_COMPONENT(_compType, _classname) \
+  IGN_GAZEBO_REGISTER_COMPONENT_WITH_STORAGE(_compType, _classname, \
+      ignition::gazebo::ComponentStorage<_classname>)
+
+  /// \brief Static component registration macro which also selects the
+  /// storage used to hold all components of that type.
+  ///
+  /// Use this macro instead of IGN_GAZEBO_REGISTER_COMPONENT for component
+  /// types that need a custom storage, such as one tuned for a particular
+  /// access pattern.
+  ///
+  /// \param[in] _compType Component type name.
+  /// \param[in] _classname Class name for component.
+  /// \param[in] _storageType Storage class, deriving from
+  /// ComponentStorageBase.
+  #define IGN_GAZEBO_REGISTER_COMPONENT_WITH_STORAGE(_compType, _classname, \
+      _storageType) \
   class IgnGazeboComponents##_classname \
   { \
     public: IgnGazeboComponents##_classname() \
@@ -335,7 +358,8 @@ namespace components
         return; \
       using namespace ignition;\
       using Desc = gazebo::components::ComponentDescriptor<_classname>; \
-      using StorageDesc = gazebo::components::StorageDescriptor<_classname>; \
+      using StorageDesc = \
+          gazebo::components::StorageDescriptor<_classname, _storageType>; \
       gazebo::components::Factory::Instance()->Register<_classname>(\
         _compType, new Desc(), new StorageDesc());\
     } \
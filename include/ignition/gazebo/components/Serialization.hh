@@ -53,6 +53,13 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
 ///                                                DataType &_data)
 ///     };
 /// \endcode
+/// Optionally, it can also implement a `Serialize` overload which replaces
+/// the contents of a string with the same output, which is used by
+/// BaseComponent::SerializeToString to skip the stream:
+/// \code
+///       public: static void Serialize(std::string &_out,
+///                                     const DataType &_data);
+/// \endcode
 
 namespace serializers
 {
@@ -83,6 +90,15 @@ namespace serializers
       return _out;
     }
 
+    /// \brief Serialization straight into a string.
+    /// \param[out] _out String to hold the serialized data.
+    /// \param[in] _data Data to serialize.
+    public: static void Serialize(std::string &_out, const DataType &_data)
+    {
+      auto msg = ignition::gazebo::convert<MsgType>(_data);
+      msg.SerializeToString(&_out);
+    }
+
     /// \brief Deserialization
     /// \param[in] _in Input stream.
     /// \param[out] _data data to populate
@@ -117,6 +133,17 @@ namespace serializers
       return _out;
     }
 
+    /// \brief Serialization straight into a string.
+    /// \param[out] _out String to hold the serialized data.
+    /// \param[in] _vec Vector to serialize.
+    public: static void Serialize(std::string &_out,
+                                  const std::vector<double> &_vec)
+    {
+      ignition::msgs::Double_V msg;
+      *msg.mutable_data() = {_vec.begin(), _vec.end()};
+      msg.SerializeToString(&_out);
+    }
+
     /// \brief Deserialization
     /// \param[in] _in Input stream.
     /// \param[in] _vec Vector to populate
@@ -146,6 +173,15 @@ namespace serializers
       return _out;
     }
 
+    /// \brief Serialization straight into a string.
+    /// \param[out] _out String to hold the serialized data.
+    /// \param[in] _msg Message to serialize.
+    public: static void Serialize(std::string &_out,
+        const google::protobuf::Message &_msg)
+    {
+      _msg.SerializeToString(&_out);
+    }
+
     /// \brief Deserialization
     /// \param[in] _in Input stream.
     /// \param[in] _msg Message to populate
@@ -172,6 +208,14 @@ namespace serializers
       return _out;
     }
 
+    /// \brief Serialization straight into a string.
+    /// \param[out] _out String to hold the serialized data.
+    /// \param[in] _data Data to serialize.
+    public: static void Serialize(std::string &_out, const std::string &_data)
+    {
+      _out = _data;
+    }
+
     /// \brief Deserialization
     /// \param[in] _in Input stream.
     /// \param[in] _data Data to populate.
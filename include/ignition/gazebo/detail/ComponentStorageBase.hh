@@ -17,7 +17,10 @@
 #ifndef IGNITION_GAZEBO_DETAIL_COMPONENTSTORAGEBASE_HH_
 #define IGNITION_GAZEBO_DETAIL_COMPONENTSTORAGEBASE_HH_
 
-#include <map>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
 #include <utility>
 #include <vector>
 #include "ignition/gazebo/components/Component.hh"
@@ -76,14 +79,169 @@ namespace ignition
       /// \return First component or nullptr if there are no components.
       public: virtual components::BaseComponent *First() = 0;
 
+      /// \brief Set the change state of a component. Safe to call
+      /// concurrently for any components, as long as components aren't
+      /// being created or removed at the same time.
+      /// \param[in] _id Id of the component.
+      /// \param[in] _state New change state.
+      public: void SetChangeState(const ComponentId _id,
+                  const ComponentState _state)
+      {
+        const size_t slot = static_cast<size_t>(_id & kIndexMask);
+        const size_t word = slot / 64;
+        if (_id < 0 || word >= this->oneTimeChanged.size())
+          return;
+
+        const uint64_t bit = uint64_t{1} << (slot % 64);
+        UpdateBit(this->oneTimeChanged[word], bit,
+            _state == ComponentState::OneTimeChange, this->oneTimeCount);
+        UpdateBit(this->periodicChanged[word], bit,
+            _state == ComponentState::PeriodicChange, this->periodicCount);
+      }
+
+      /// \brief Get the change state of a component.
+      /// \param[in] _id Id of the component.
+      /// \return The change state, or NoChange if the id is invalid.
+      public: ComponentState ChangeState(const ComponentId _id) const
+      {
+        const size_t slot = static_cast<size_t>(_id & kIndexMask);
+        const size_t word = slot / 64;
+        if (_id < 0 || word >= this->oneTimeChanged.size())
+          return ComponentState::NoChange;
+
+        const uint64_t bit = uint64_t{1} << (slot % 64);
+        if (this->oneTimeChanged[word] & bit)
+          return ComponentState::OneTimeChange;
+        if (this->periodicChanged[word] & bit)
+          return ComponentState::PeriodicChange;
+        return ComponentState::NoChange;
+      }
+
+      /// \brief Mark all components as unchanged.
+      public: void SetAllUnchanged()
+      {
+        if (this->oneTimeCount == 0 && this->periodicCount == 0)
+          return;
+
+        for (auto &word : this->oneTimeChanged)
+          word = 0;
+        for (auto &word : this->periodicChanged)
+          word = 0;
+        this->oneTimeCount = 0;
+        this->periodicCount = 0;
+      }
+
+      /// \brief Whether any component has a one-time change.
+      /// \return True if there are one-time changes.
+      public: bool HasOneTimeChanges() const
+      {
+        return this->oneTimeCount > 0;
+      }
+
+      /// \brief Whether any component has a periodic change.
+      /// \return True if there are periodic changes.
+      public: bool HasPeriodicChanges() const
+      {
+        return this->periodicCount > 0;
+      }
+
+      /// \brief Make room for the change state of components up to a slot
+      /// index. Must not be called concurrently with SetChangeState.
+      /// \param[in] _slotCount Number of slots in use.
+      protected: void ResizeChangeStates(const size_t _slotCount)
+      {
+        const size_t words = (_slotCount + 63) / 64;
+        if (words <= this->oneTimeChanged.size())
+          return;
+
+        // Atomics can't be moved, so the words are copied into new vectors
+        const size_t capacity =
+            std::max(words, this->oneTimeChanged.size() * 2);
+        for (auto *bits : {&this->oneTimeChanged, &this->periodicChanged})
+        {
+          std::vector<std::atomic<uint64_t>> grown(capacity);
+          for (size_t i = 0; i < bits->size(); ++i)
+            grown[i] = (*bits)[i].load();
+          bits->swap(grown);
+        }
+      }
+
+      /// \brief Clear all change states, used when all components are
+      /// removed.
+      protected: void ClearChangeStates()
+      {
+        this->oneTimeChanged.clear();
+        this->periodicChanged.clear();
+        this->oneTimeCount = 0;
+        this->periodicCount = 0;
+      }
+
+      /// \brief Set or clear a bit, keeping track of how many bits are set.
+      /// \param[in] _word Word holding the bit.
+      /// \param[in] _bit Mask with the bit.
+      /// \param[in] _set True to set the bit, false to clear it.
+      /// \param[in] _count Number of set bits, updated on transitions.
+      private: static void UpdateBit(std::atomic<uint64_t> &_word,
+                   const uint64_t _bit, const bool _set,
+                   std::atomic<size_t> &_count)
+      {
+        if (_set)
+        {
+          if (!(_word.fetch_or(_bit) & _bit))
+            ++_count;
+        }
+        else if (_word & _bit)
+        {
+          if (_word.fetch_and(~_bit) & _bit)
+            --_count;
+        }
+      }
+
+      /// \brief Number of bits of a ComponentId used for the slot index.
+      public: static constexpr int kIndexBits = 24;
+
+      /// \brief Mask to extract the slot index from a ComponentId.
+      public: static constexpr ComponentId kIndexMask = (1 << kIndexBits) - 1;
+
       /// \brief Mutex used to prevent data corruption.
       protected: mutable std::mutex mutex;
+
+      /// \brief One bit per slot, set if the component in that slot has a
+      /// one-time change.
+      private: std::vector<std::atomic<uint64_t>> oneTimeChanged;
+
+      /// \brief One bit per slot, set if the component in that slot has a
+      /// periodic change.
+      private: std::vector<std::atomic<uint64_t>> periodicChanged;
+
+      /// \brief Number of bits set in oneTimeChanged.
+      private: std::atomic<size_t> oneTimeCount{0};
+
+      /// \brief Number of bits set in periodicChanged.
+      private: std::atomic<size_t> periodicCount{0};
     };
 
     /// \brief Templated implementation of component storage.
+    ///
+    /// Components are packed contiguously in the `components` vector, and
+    /// addressed through a slot map so that creation, lookup and removal are
+    /// all O(1). A ComponentId encodes a slot index in its lower
+    /// `kIndexBits` bits and the slot's generation in the remaining bits.
+    /// The generation is bumped every time a slot is released, so stale
+    /// ComponentIds of removed components are rejected instead of aliasing
+    /// the component that later reuses the slot.
+    ///
+    /// Reads are lock-free. The storage must not be modified concurrently
+    /// with reads, which matches the ECM contract of only mutating entities
+    /// and components during PreUpdate and Update.
     template<typename ComponentTypeT>
     class IGNITION_GAZEBO_HIDDEN ComponentStorage : public ComponentStorageBase
     {
+      /// \brief Mask applied to generations so that ComponentIds stay
+      /// positive.
+      public: static constexpr ComponentId kGenerationMask =
+          (1 << (31 - kIndexBits)) - 1;
+
       /// \brief Constructor
       public: explicit ComponentStorage()
               : ComponentStorageBase()
@@ -99,6 +257,7 @@ namespace ignition
         // See also this class's Create() function, which expands the value
         // of components vector whenever the capacity is reached.
         this->components.reserve(100);
+        this->denseIds.reserve(100);
       }
 
       // Documentation inherited.
@@ -106,71 +265,96 @@ namespace ignition
       {
         std::lock_guard<std::mutex> lock(this->mutex);
 
-        // Get an iterator to the component that should be removed.
-        auto iter = this->idMap.find(_id);
+        const int denseIndex = this->DenseIndex(_id);
 
         // Make sure the component exists.
-        if (iter != this->idMap.end())
+        if (denseIndex < 0)
+          return false;
+
+        // Move the last component into the hole left by the removed one, so
+        // that components stay packed, and repoint its slot.
+        const int lastIndex = static_cast<int>(this->components.size()) - 1;
+        if (denseIndex != lastIndex)
         {
-          // Handle the case where there are more components than the
-          // component to be removed
-          if (this->components.size() > 1)
-          {
-            // Swap the component to be removed with the component at the
-            // back of the vector.
-            std::swap(this->components[iter->second],
-                      this->components.back());
-
-            // After the swap, we have to fix all the id mappings.
-            for (auto idIter =this->idMap.begin();
-                idIter != this->idMap.end(); ++idIter)
-            {
-              if (static_cast<unsigned int>(idIter->second) ==
-                  this->components.size()-1)
-              {
-                idIter->second = iter->second;
-              }
-            }
-          }
+          this->components[denseIndex] =
+              std::move(this->components[lastIndex]);
+          this->denseIds[denseIndex] = this->denseIds[lastIndex];
+          this->slots[this->denseIds[denseIndex] & kIndexMask].dense =
+              denseIndex;
+        }
+        this->components.pop_back();
+        this->denseIds.pop_back();
 
-          // Remove the component.
-          this->components.pop_back();
+        // Release the slot and invalidate all outstanding ids that refer
+        // to it.
+        this->SetChangeState(_id, ComponentState::NoChange);
+        const int slotIndex = _id & kIndexMask;
+        Slot &slot = this->slots[slotIndex];
+        slot.dense = -1;
+        slot.generation = (slot.generation + 1) & kGenerationMask;
+        this->freeSlots.push_back(slotIndex);
 
-          // Remove the id mapping.
-          this->idMap.erase(iter);
-          return true;
-        }
-        return false;
+        return true;
       }
 
       // Documentation inherited.
       public: void RemoveAll() final
       {
-        this->idCounter = 0;
-        this->idMap.clear();
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->slots.clear();
+        this->freeSlots.clear();
+        this->denseIds.clear();
         this->components.clear();
+        this->ClearChangeStates();
       }
 
       // Documentation inherited.
       public: std::pair<ComponentId, bool> Create(
                   const components::BaseComponent *_data) final
       {
-        ComponentId result;  // = kComponentIdInvalid;
+        std::lock_guard<std::mutex> lock(this->mutex);
+
         bool expanded = false;
         if (this->components.size() == this->components.capacity())
         {
-          this->components.reserve(this->components.capacity() + 100);
+          // Grow geometrically so that creating many components doesn't
+          // trigger a view rebuild every 100 creations.
+          const size_t capacity = std::max<size_t>(100,
+              this->components.capacity() * 2);
+          this->components.reserve(capacity);
+          this->denseIds.reserve(capacity);
           expanded = true;
         }
 
-        std::lock_guard<std::mutex> lock(this->mutex);
-        // cppcheck-suppress unmatchedSuppression
-        // cppcheck-suppress postfixOperator
-        result = this->idCounter++;
-        this->idMap[result] = this->components.size();
+        int slotIndex;
+        if (!this->freeSlots.empty())
+        {
+          slotIndex = this->freeSlots.back();
+          this->freeSlots.pop_back();
+        }
+        else
+        {
+          if (this->slots.size() > static_cast<size_t>(kIndexMask))
+          {
+            ignerr << "Reached maximum number of components ["
+                   << kIndexMask + 1 << "] for a single type." << std::endl;
+            return {kComponentIdInvalid, false};
+          }
+          slotIndex = static_cast<int>(this->slots.size());
+          this->slots.push_back(Slot());
+          this->ResizeChangeStates(this->slots.size());
+        }
+
+        Slot &slot = this->slots[slotIndex];
+        slot.dense = static_cast<int>(this->components.size());
+
+        const ComponentId result =
+            (slot.generation << kIndexBits) | slotIndex;
+
         // Copy the component
-        this->components.push_back(std::move(
-              ComponentTypeT(*static_cast<const ComponentTypeT *>(_data))));
+        this->components.push_back(
+              ComponentTypeT(*static_cast<const ComponentTypeT *>(_data)));
+        this->denseIds.push_back(result);
 
         return {result, expanded};
       }
@@ -184,35 +368,66 @@ namespace ignition
               this)->Component(_id));
       }
 
+      // Documentation inherited.
       public: components::BaseComponent *Component(const ComponentId _id) final
       {
-        std::lock_guard<std::mutex> lock(this->mutex);
-
-        auto iter = this->idMap.find(_id);
+        const int denseIndex = this->DenseIndex(_id);
+        if (denseIndex < 0)
+          return nullptr;
 
-        if (iter != this->idMap.end())
-        {
-          return static_cast<components::BaseComponent *>(
-              &this->components.at(iter->second));
-        }
-        return nullptr;
+        return static_cast<components::BaseComponent *>(
+            &this->components[denseIndex]);
       }
 
       // Documentation inherited.
       public: components::BaseComponent *First() final
       {
-        std::lock_guard<std::mutex> lock(this->mutex);
         if (!this->components.empty())
           return static_cast<components::BaseComponent *>(&this->components[0]);
         return nullptr;
       }
 
-      /// \brief The id counter is used to get unique ids within this
-      /// storage class.
-      private: ComponentId idCounter = 0;
+      /// \brief Get the position of a component in the `components` vector.
+      /// \param[in] _id Id of the component.
+      /// \return Index into `components`, or -1 if the id is invalid, stale,
+      /// or refers to a removed component.
+      private: int DenseIndex(const ComponentId _id) const
+      {
+        if (_id < 0)
+          return -1;
+
+        const size_t slotIndex = static_cast<size_t>(_id & kIndexMask);
+        if (slotIndex >= this->slots.size())
+          return -1;
+
+        const Slot &slot = this->slots[slotIndex];
+        if (slot.generation != (_id >> kIndexBits))
+          return -1;
+
+        return slot.dense;
+      }
+
+      /// \brief An entry of the slot map.
+      private: struct Slot
+      {
+        /// \brief Index into the `components` vector, or -1 if the slot is
+        /// free.
+        int dense{-1};
+
+        /// \brief Generation of the slot, bumped on every removal.
+        ComponentId generation{0};
+      };
+
+      /// \brief Slot map from the index part of a ComponentId to the
+      /// position of the component in the `components` vector.
+      private: std::vector<Slot> slots;
+
+      /// \brief Indices of slots that can be reused.
+      private: std::vector<int> freeSlots;
 
-      /// \brief Map of ComponentId to Components (see the components vector).
-      private: std::map<ComponentId, int> idMap;
+      /// \brief Id of each component in the `components` vector, used to
+      /// repoint slots when components are moved during removal.
+      private: std::vector<ComponentId> denseIds;
 
       /// \brief Sequential storage of components.
       public: std::vector<ComponentTypeT> components;
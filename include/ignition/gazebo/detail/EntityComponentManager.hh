@@ -18,6 +18,7 @@
 #define IGNITION_GAZEBO_DETAIL_ENTITYCOMPONENTMANAGER_HH_
 
 #include <cstring>
+#include <functional>
 #include <map>
 #include <optional>
 #include <set>
@@ -55,6 +56,22 @@ namespace traits
       value = !std::is_same<decltype(*(T*)(0) == *(T*)(0)), TestEqualityOperator>::value // NOLINT
     };
   };
+
+  /// \brief Type trait that determines if a component holds data which can
+  /// be hashed with `std::hash`, and therefore can be indexed.
+  template<typename ComponentTypeT, typename = void>
+  struct HasHashableData : std::false_type
+  {
+  };
+
+  /// \brief Specialization for components with hashable data.
+  template<typename ComponentTypeT>
+  struct HasHashableData<ComponentTypeT, std::void_t<
+      decltype(std::hash<typename ComponentTypeT::Type>()(
+          std::declval<const typename ComponentTypeT::Type &>()))>>
+    : std::true_type
+  {
+  };
 }
 
 //////////////////////////////////////////////////
@@ -167,7 +184,12 @@ bool EntityComponentManager::SetComponentData(const Entity _entity,
     return true;
   }
 
-  return comp->SetData(_data, CompareData<typename ComponentTypeT::Type>);
+  if (!comp->SetData(_data, CompareData<typename ComponentTypeT::Type>))
+    return false;
+
+  this->MarkIndexDirty(_entity, ComponentTypeT::typeId);
+  this->InvalidateWorldPoses(ComponentTypeT::typeId);
+  return true;
 }
 
 //////////////////////////////////////////////////
@@ -186,17 +208,61 @@ ComponentTypeT *EntityComponentManager::First()
       this->First(ComponentTypeT::typeId));
 }
 
+//////////////////////////////////////////////////
+template<typename ComponentTypeT>
+void EntityComponentManager::EnableComponentIndex()
+{
+  static_assert(traits::HasHashableData<ComponentTypeT>::value,
+      "Only components whose data can be hashed with std::hash can be "
+      "indexed.");
+
+  this->EnableComponentIndex(ComponentTypeT::typeId,
+      [](const components::BaseComponent *_component)
+      {
+        return std::hash<typename ComponentTypeT::Type>()(
+            static_cast<const ComponentTypeT *>(_component)->Data());
+      });
+}
+
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs>
+std::optional<std::vector<Entity>> EntityComponentManager::IndexCandidates(
+    const ComponentTypeTs &..._desiredComponents) const
+{
+  std::optional<std::vector<Entity>> result;
+  ForEach([&](const auto &_desiredComponent)
+  {
+    using ComponentTypeT = std::remove_cv_t<std::remove_reference_t<
+        decltype(_desiredComponent)>>;
+
+    if constexpr (traits::HasHashableData<ComponentTypeT>::value)
+    {
+      if (!result)
+      {
+        result = this->IndexedEntities(ComponentTypeT::typeId,
+            std::hash<typename ComponentTypeT::Type>()(
+            _desiredComponent.Data()));
+      }
+    }
+  }, _desiredComponents...);
+
+  return result;
+}
+
 //////////////////////////////////////////////////
 template<typename ...ComponentTypeTs>
 Entity EntityComponentManager::EntityByComponents(
     const ComponentTypeTs &..._desiredComponents) const
 {
-  // Get all entities which have components of the desired types
-  const auto &view = this->FindView<ComponentTypeTs...>();
+  // Get all entities which have components of the desired types, or only
+  // those with a matching hash if one of the components is indexed.
+  const auto candidates = this->IndexCandidates(_desiredComponents...);
+  const auto entities = candidates ? detail::View::EntityRange(*candidates) :
+      this->FindView<ComponentTypeTs...>().Entities();
 
   // Iterate over entities
   Entity result{kNullEntity};
-  for (const Entity entity : view.entities)
+  for (const Entity entity : entities)
   {
     bool different{false};
 
@@ -208,7 +274,7 @@ Entity EntityComponentManager::EntityByComponents(
           std::remove_cv_t<std::remove_reference_t<
               decltype(_desiredComponent)>>>(entity);
 
-      if (*entityComponent != _desiredComponent)
+      if (nullptr == entityComponent || *entityComponent != _desiredComponent)
       {
         different = true;
       }
@@ -229,12 +295,15 @@ template<typename ...ComponentTypeTs>
 std::vector<Entity> EntityComponentManager::EntitiesByComponents(
     const ComponentTypeTs &..._desiredComponents) const
 {
-  // Get all entities which have components of the desired types
-  const auto &view = this->FindView<ComponentTypeTs...>();
+  // Get all entities which have components of the desired types, or only
+  // those with a matching hash if one of the components is indexed.
+  const auto candidates = this->IndexCandidates(_desiredComponents...);
+  const auto entities = candidates ? detail::View::EntityRange(*candidates) :
+      this->FindView<ComponentTypeTs...>().Entities();
 
   // Iterate over entities
   std::vector<Entity> result;
-  for (const Entity entity : view.entities)
+  for (const Entity entity : entities)
   {
     bool different{false};
 
@@ -246,7 +315,7 @@ std::vector<Entity> EntityComponentManager::EntitiesByComponents(
           std::remove_cv_t<std::remove_reference_t<
               decltype(_desiredComponent)>>>(entity);
 
-      if (*entityComponent != _desiredComponent)
+      if (nullptr == entityComponent || *entityComponent != _desiredComponent)
       {
         different = true;
       }
@@ -274,7 +343,7 @@ std::vector<Entity> EntityComponentManager::ChildrenByComponents(Entity _parent,
 
   // Iterate over entities
   std::vector<Entity> result;
-  for (const Entity entity : view.entities)
+  for (const Entity entity : view.Entities())
   {
     if (children.find(entity) == children.end())
     {
@@ -365,13 +434,7 @@ void EntityComponentManager::Each(typename identity<std::function<
 
   // Iterate over the entities in the view, and invoke the callback
   // function.
-  for (const Entity entity : view.entities)
-  {
-    if (!_f(entity, view.Component<ComponentTypeTs>(entity, this)...))
-    {
-      break;
-    }
-  }
+  view.Each<ComponentTypeTs...>(_f, this);
 }
 
 //////////////////////////////////////////////////
@@ -385,13 +448,37 @@ void EntityComponentManager::Each(typename identity<std::function<
 
   // Iterate over the entities in the view, and invoke the callback
   // function.
-  for (const Entity entity : view.entities)
-  {
-    if (!_f(entity, view.Component<ComponentTypeTs>(entity, this)...))
-    {
-      break;
-    }
-  }
+  view.Each<ComponentTypeTs...>(_f, this);
+}
+
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs>
+void EntityComponentManager::EachParallel(typename identity<std::function<
+    void(const Entity &_entity, const ComponentTypeTs *...)>>::type _f) const
+{
+  detail::View &view = this->FindView<ComponentTypeTs...>();
+
+  view.EachParallel<ComponentTypeTs...>(_f, this,
+      [this](const size_t _count,
+             const std::function<void(size_t, size_t)> &_chunk)
+      {
+        this->ParallelFor(_count, _chunk);
+      });
+}
+
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs>
+void EntityComponentManager::EachParallel(typename identity<std::function<
+    void(const Entity &_entity, ComponentTypeTs *...)>>::type _f)
+{
+  detail::View &view = this->FindView<ComponentTypeTs...>();
+
+  view.EachParallel<ComponentTypeTs...>(_f, this,
+      [this](const size_t _count,
+             const std::function<void(size_t, size_t)> &_chunk)
+      {
+        this->ParallelFor(_count, _chunk);
+      });
 }
 
 //////////////////////////////////////////////////
@@ -414,13 +501,7 @@ void EntityComponentManager::EachNew(typename identity<std::function<
   // Iterate over the entities in the view and in the newly created
   // entities list, and invoke the callback
   // function.
-  for (const Entity entity : view.newEntities)
-  {
-    if (!_f(entity, view.Component<ComponentTypeTs>(entity, this)...))
-    {
-      break;
-    }
-  }
+  view.EachOf<ComponentTypeTs...>(view.NewEntities(), _f, this);
 }
 
 //////////////////////////////////////////////////
@@ -435,13 +516,7 @@ void EntityComponentManager::EachNew(typename identity<std::function<
   // Iterate over the entities in the view and in the newly created
   // entities list, and invoke the callback
   // function.
-  for (const Entity entity : view.newEntities)
-  {
-    if (!_f(entity, view.Component<ComponentTypeTs>(entity, this)...))
-    {
-      break;
-    }
-  }
+  view.EachOf<ComponentTypeTs...>(view.NewEntities(), _f, this);
 }
 
 //////////////////////////////////////////////////
@@ -456,13 +531,7 @@ void EntityComponentManager::EachRemoved(typename identity<std::function<
   // Iterate over the entities in the view and in the newly created
   // entities list, and invoke the callback
   // function.
-  for (const Entity entity : view.toRemoveEntities)
-  {
-    if (!_f(entity, view.Component<ComponentTypeTs>(entity, this)...))
-    {
-      break;
-    }
-  }
+  view.EachOf<ComponentTypeTs...>(view.ToRemoveEntities(), _f, this);
 }
 
 //////////////////////////////////////////////////
@@ -526,7 +595,7 @@ detail::View &EntityComponentManager::FindView() const
   // Find the view. If the view doesn't exist, then create a new view.
   if (!this->FindView(types, viewIter))
   {
-    detail::View view;
+    detail::View view(types);
     // Add all the entities that match the component types to the
     // view.
     for (const auto &vertex : this->Entities().Vertices())
@@ -17,10 +17,15 @@
 #ifndef IGNITION_GAZEBO_DETAIL_VIEW_HH_
 #define IGNITION_GAZEBO_DETAIL_VIEW_HH_
 
-#include <map>
+#include <array>
+#include <atomic>
+#include <limits>
+#include <mutex>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 #include "ignition/gazebo/components/Component.hh"
 #include "ignition/gazebo/Entity.hh"
 #include "ignition/gazebo/Export.hh"
@@ -45,9 +50,34 @@ using ComponentTypeKey = std::set<ComponentTypeId>;
 /// use a cache to improve performance. The assumption is that entities
 /// and the types of components assigned to entities change infrequently
 /// compared to the frequency of queries performed by systems.
+///
+/// Entities are kept in a contiguous vector sorted by entity id. For each
+/// entity, the view keeps one row holding the ids of its components and
+/// pointers to them, with one column per component type in the view's key.
+/// Iterating a view is therefore a linear scan that doesn't need to look up
+/// components in their storages.
+///
+/// Component pointers are resolved lazily. They are invalidated when a
+/// storage moves its components in memory, which happens when it
+/// reallocates or when a component is removed from it, and re-resolved from
+/// the component ids the next time the view is accessed.
+///
+/// Entities can be added to or removed from a view while it is being
+/// iterated. Added entities are appended to the end of the view, and removed
+/// entities are replaced by kNullEntity, so that iteration can continue
+/// safely. The view is sorted and compacted once the iteration is over.
 class IGNITION_GAZEBO_VISIBLE View
 {
-  /// Get a pointer to a component for an entity based on a component type.
+  /// \brief Constructor
+  /// \param[in] _types Component types of the entities in this view.
+  public: explicit View(const ComponentTypeKey &_types = {});
+
+  /// \brief Move constructor
+  /// \param[in] _view View to move.
+  public: View(View &&_view);
+
+  /// \brief Get a pointer to a component for an entity based on a component
+  /// type.
   /// \param[in] _entity The entity.
   /// \param[in] _ecm Pointer to the entity component manager.
   /// \return Pointer to the component.
@@ -60,7 +90,8 @@ class IGNITION_GAZEBO_VISIBLE View
         this->ComponentImplementation(_entity, typeId, _ecm));
   }
 
-  /// Get a pointer to a component for an entity based on a component type.
+  /// \brief Get a pointer to a component for an entity based on a component
+  /// type.
   /// \param[in] _entity The entity.
   /// \param[in] _ecm Pointer to the entity component manager.
   /// \return Pointer to the component.
@@ -74,7 +105,211 @@ class IGNITION_GAZEBO_VISIBLE View
           this->ComponentImplementation(_entity, typeId, _ecm)));
   }
 
-  /// \brief Add an entity to the view.
+  /// \brief Invoke a callback on all the entities in the view, in order.
+  /// \param[in] _f Callback which receives an entity and pointers to its
+  /// components, and returns false to stop iterating.
+  /// \param[in] _ecm Pointer to the entity component manager.
+  /// \tparam ComponentTypeTs Component types passed to the callback, which
+  /// must all be part of the view's key.
+  public: template<typename ...ComponentTypeTs, typename FunctionT>
+          void Each(const FunctionT &_f, const EntityComponentManager *_ecm)
+  {
+    const std::array<size_t, sizeof...(ComponentTypeTs)> columns{
+        {this->ColumnIndex(ComponentTypeTs::typeId)...}};
+
+    IterationGuard guard(*this);
+    for (size_t row = 0; row < this->entities.size(); ++row)
+    {
+      // Skip entities removed during this iteration.
+      if (this->entities[row] == kNullEntity)
+        continue;
+
+      // A previous callback may have caused components to move.
+      this->Refresh(_ecm);
+
+      if (!this->Invoke<ComponentTypeTs...>(_f, row, columns,
+          std::index_sequence_for<ComponentTypeTs...>()))
+      {
+        break;
+      }
+    }
+  }
+
+  /// \brief Invoke a callback on a subset of the entities in the view.
+  /// \param[in] _subset Entities to iterate, such as NewEntities(). The
+  /// subset is copied, so it can be modified by the callback.
+  /// \param[in] _f Callback which receives an entity and pointers to its
+  /// components, and returns false to stop iterating.
+  /// \param[in] _ecm Pointer to the entity component manager.
+  /// \tparam ComponentTypeTs Component types passed to the callback, which
+  /// must all be part of the view's key.
+  public: template<typename ...ComponentTypeTs, typename FunctionT>
+          void EachOf(const std::vector<Entity> &_subset, const FunctionT &_f,
+              const EntityComponentManager *_ecm)
+  {
+    const std::array<size_t, sizeof...(ComponentTypeTs)> columns{
+        {this->ColumnIndex(ComponentTypeTs::typeId)...}};
+
+    const std::vector<Entity> subset = _subset;
+
+    IterationGuard guard(*this);
+    for (const Entity entity : subset)
+    {
+      const size_t row = this->Row(entity);
+      if (row == kInvalidRow)
+        continue;
+
+      this->Refresh(_ecm);
+
+      if (!this->Invoke<ComponentTypeTs...>(_f, row, columns,
+          std::index_sequence_for<ComponentTypeTs...>()))
+      {
+        break;
+      }
+    }
+  }
+
+  /// \brief Invoke a callback on all the entities in the view, splitting
+  /// the rows into ranges which are processed concurrently.
+  /// \param[in] _f Callback which receives an entity and pointers to its
+  /// components. It must not add or remove entities or components.
+  /// \param[in] _ecm Pointer to the entity component manager.
+  /// \param[in] _parallelFor Function which calls its second argument
+  /// with non-overlapping ranges covering [0, count), where count is its
+  /// first argument, and blocks until they're all done.
+  /// \tparam ComponentTypeTs Component types passed to the callback, which
+  /// must all be part of the view's key.
+  public: template<typename ...ComponentTypeTs, typename FunctionT,
+                   typename ParallelForT>
+          void EachParallel(const FunctionT &_f,
+              const EntityComponentManager *_ecm,
+              const ParallelForT &_parallelFor)
+  {
+    const std::array<size_t, sizeof...(ComponentTypeTs)> columns{
+        {this->ColumnIndex(ComponentTypeTs::typeId)...}};
+
+    // Resolve pointers up front, the callbacks only read them.
+    this->Refresh(_ecm);
+
+    IterationGuard guard(*this);
+    _parallelFor(this->entities.size(),
+        [&](const size_t _begin, const size_t _end)
+    {
+      for (size_t row = _begin; row < _end; ++row)
+      {
+        if (this->entities[row] == kNullEntity)
+          continue;
+
+        this->Invoke<ComponentTypeTs...>(_f, row, columns,
+            std::index_sequence_for<ComponentTypeTs...>());
+      }
+    });
+  }
+
+  /// \brief Range over the entities of a view, which skips entities removed
+  /// while the view is being iterated.
+  public: class EntityRange
+  {
+    /// \brief Forward iterator over the entities.
+    public: class Iterator
+    {
+      /// \brief Constructor
+      /// \param[in] _it Position in the view's entities.
+      /// \param[in] _end End of the view's entities.
+      public: Iterator(std::vector<Entity>::const_iterator _it,
+                  std::vector<Entity>::const_iterator _end)
+        : it(_it), end(_end)
+      {
+        this->Skip();
+      }
+
+      /// \brief Get the current entity.
+      /// \return Entity.
+      public: Entity operator*() const
+      {
+        return *this->it;
+      }
+
+      /// \brief Advance to the next entity.
+      /// \return This iterator.
+      public: Iterator &operator++()
+      {
+        ++this->it;
+        this->Skip();
+        return *this;
+      }
+
+      /// \brief Inequality operator.
+      /// \param[in] _other Iterator to compare to.
+      /// \return True if the iterators point to different positions.
+      public: bool operator!=(const Iterator &_other) const
+      {
+        return this->it != _other.it;
+      }
+
+      /// \brief Skip removed entities.
+      private: void Skip()
+      {
+        while (this->it != this->end && *this->it == kNullEntity)
+          ++this->it;
+      }
+
+      /// \brief Current position.
+      private: std::vector<Entity>::const_iterator it;
+
+      /// \brief End of the view's entities.
+      private: std::vector<Entity>::const_iterator end;
+    };
+
+    /// \brief Constructor
+    /// \param[in] _entities The view's entities.
+    public: explicit EntityRange(const std::vector<Entity> &_entities)
+      : entities(_entities)
+    {
+    }
+
+    /// \brief Get an iterator to the first entity.
+    /// \return Iterator.
+    public: Iterator begin() const
+    {
+      return Iterator(this->entities.begin(), this->entities.end());
+    }
+
+    /// \brief Get an iterator past the last entity.
+    /// \return Iterator.
+    public: Iterator end() const
+    {
+      return Iterator(this->entities.end(), this->entities.end());
+    }
+
+    /// \brief The view's entities.
+    private: const std::vector<Entity> &entities;
+  };
+
+  /// \brief Get the entities of the view, sorted, except while the view is
+  /// being iterated, during which added entities are at the end.
+  /// \return Range over the entities.
+  public: EntityRange Entities() const
+  {
+    return EntityRange(this->entities);
+  }
+
+  /// \brief Get the newly created entities of the view.
+  /// \return Sorted entities.
+  public: const std::vector<Entity> &NewEntities() const
+  {
+    return this->newEntities;
+  }
+
+  /// \brief Get the entities of the view about to be removed.
+  /// \return Sorted entities.
+  public: const std::vector<Entity> &ToRemoveEntities() const
+  {
+    return this->toRemoveEntities;
+  }
+
+  /// \brief Add an entity to the view. The entity's components must then be
+  /// added with AddComponent.
   /// \param[in] _entity The entity to add.
   /// \param[in] _new Whether to add the entity to the list of new entities.
   /// The new here is to indicate whether the entity is new to the entity
@@ -104,6 +339,15 @@ class IGNITION_GAZEBO_VISIBLE View
                             const ComponentTypeId _compTypeId,
                             const ComponentId _compId);
 
+  /// \brief Mark all component pointers as invalid, so that they're
+  /// resolved again on the next access. This must be called whenever a
+  /// storage holding components of this view moves its components.
+  public: void InvalidateComponents();
+
+  /// \brief Remove all entities and components from the view. The list of
+  /// new entities and entities to be removed are kept.
+  public: void Reset();
+
   /// \brief Implementation of the Component accessor.
   /// \param[in] _entity The entity.
   /// \param[in] _typeId Type id of the component.
@@ -117,18 +361,120 @@ class IGNITION_GAZEBO_VISIBLE View
   /// \brief Clear the list of new entities
   public: void ClearNewEntities();
 
-  /// \brief All the entities that belong to this view.
-  public: std::set<Entity> entities;
+  /// \brief Get the column of a component type.
+  /// \param[in] _typeId Component type id, which must be in the view's key.
+  /// \return Column index.
+  private: size_t ColumnIndex(const ComponentTypeId _typeId) const;
+
+  /// \brief Get the row of an entity.
+  /// \param[in] _entity The entity.
+  /// \return Row index, or kInvalidRow if the entity is not in the view.
+  private: size_t Row(const Entity _entity) const;
+
+  /// \brief Get the component stored at a row and column. Refresh must
+  /// have been called beforehand.
+  /// \param[in] _row Row of the entity.
+  /// \param[in] _column Column of the component type.
+  /// \return Pointer to the component.
+  private: components::BaseComponent *ComponentAt(const size_t _row,
+               const size_t _column) const
+  {
+    return this->componentPtrs[_row * this->types.size() + _column];
+  }
+
+  /// \brief Resolve component pointers which have been invalidated. This
+  /// is cheap when all pointers are valid, and safe to call from multiple
+  /// threads, as long as the view is not being modified.
+  /// \param[in] _ecm Pointer to the EntityComponentManager.
+  private: void Refresh(const EntityComponentManager *_ecm) const;
+
+  /// \brief Sort the view and drop entities which have been removed while
+  /// it was being iterated.
+  private: void Compact();
+
+  /// \brief Call an Each callback on one row.
+  /// \param[in] _f Callback.
+  /// \param[in] _row Row of the entity.
+  /// \param[in] _columns Columns of the callback's component types.
+  /// \return Value returned by the callback.
+  private: template<typename ...ComponentTypeTs, typename FunctionT,
+                    size_t ...Is>
+          decltype(auto) Invoke(const FunctionT &_f, const size_t _row,
+              const std::array<size_t, sizeof...(ComponentTypeTs)> &_columns,
+              std::index_sequence<Is...>)
+  {
+    // Copy the entity, the callback may cause the entities vector to grow.
+    const Entity entity = this->entities[_row];
+    return _f(entity, static_cast<ComponentTypeTs *>(
+        this->ComponentAt(_row, _columns[Is]))...);
+  }
+
+  /// \brief Keeps track of ongoing iterations, and compacts the view when
+  /// the outermost iteration is over.
+  private: class IterationGuard
+  {
+    /// \brief Constructor
+    /// \param[in] _view View being iterated.
+    public: explicit IterationGuard(View &_view) : view(_view)
+    {
+      ++this->view.iterating;
+    }
+
+    /// \brief Destructor
+    public: ~IterationGuard()
+    {
+      if (--this->view.iterating == 0 && this->view.needsCompaction)
+        this->view.Compact();
+    }
+
+    /// \brief View being iterated.
+    private: View &view;
+  };
+
+  /// \brief Row index which indicates an entity is not in the view.
+  private: static constexpr size_t kInvalidRow =
+               std::numeric_limits<size_t>::max();
+
+  /// \brief All the entities that belong to this view, sorted. Entities
+  /// removed while the view is iterated are set to kNullEntity until the
+  /// iteration is over.
+  private: std::vector<Entity> entities;
+
+  /// \brief List of newly created entities, sorted.
+  private: std::vector<Entity> newEntities;
+
+  /// \brief List of entities about to be removed, sorted.
+  private: std::vector<Entity> toRemoveEntities;
+
+  /// \brief Component types of the view, sorted. This defines the columns.
+  private: std::vector<ComponentTypeId> types;
+
+  /// \brief Row of each entity.
+  private: std::unordered_map<Entity, size_t> rows;
+
+  /// \brief Component ids, one row of `types.size()` ids per entity.
+  private: std::vector<ComponentId> componentIds;
+
+  /// \brief Component pointers, laid out like `componentIds`.
+  private: mutable std::vector<components::BaseComponent *> componentPtrs;
+
+  /// \brief Rows whose pointers need to be resolved.
+  private: mutable std::vector<size_t> unresolvedRows;
+
+  /// \brief True if all pointers need to be resolved.
+  private: mutable bool allUnresolved{false};
+
+  /// \brief True if any pointer needs to be resolved.
+  private: mutable std::atomic<bool> unresolved{false};
 
-  /// \brief List of newly created entities
-  public: std::set<Entity> newEntities;
+  /// \brief Number of ongoing iterations over the view.
+  private: std::atomic<int> iterating{0};
 
-  /// \brief List of entities about to be removed
-  public: std::set<Entity> toRemoveEntities;
+  /// \brief True if the view was modified while it was being iterated.
+  private: bool needsCompaction{false};
 
-  /// \brief All of the components for each entity.
-  public: std::map<std::pair<Entity, ComponentTypeId>,
-          ComponentId> components;
+  /// \brief Mutex used to resolve pointers from multiple threads.
+  private: mutable std::mutex refreshMutex;
 };
 /// \endcond
 }
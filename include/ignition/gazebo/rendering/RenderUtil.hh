@@ -72,6 +72,13 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     public: void UpdateECM(const UpdateInfo &_info,
                            EntityComponentManager &_ecm);
 
+    /// \brief Check whether the next UpdateECM call will remove components,
+    /// such as commands which have already been processed.
+    /// \param[in] _ecm The entity component manager
+    /// \return True if UpdateECM will remove components.
+    public: bool UpdateECMRemovesComponents(
+                const EntityComponentManager &_ecm) const;
+
     /// \brief Helper PostUpdate function for updating the scene
     public: void UpdateFromECM(const UpdateInfo &_info,
                                const EntityComponentManager &_ecm);
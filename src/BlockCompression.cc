@@ -0,0 +1,325 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "BlockCompression.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+using namespace ignition::gazebo;
+
+namespace
+{
+/// \brief Size of the header: codec and original size.
+constexpr std::size_t kHeaderSize{5};
+
+/// \brief Shortest match encoded by the LZ codec.
+constexpr std::size_t kMinMatch{4};
+
+/// \brief Farthest match encoded by the LZ codec.
+constexpr std::size_t kMaxOffset{0xFFFF};
+
+/// \brief Number of bits of the LZ codec's hash table.
+constexpr unsigned int kHashBits{14};
+
+/// \brief Read 4 bytes without alignment requirements.
+/// \param[in] _p Pointer to the bytes.
+/// \return Value.
+uint32_t Read32(const unsigned char *_p)
+{
+  uint32_t v;
+  std::memcpy(&v, _p, sizeof(v));
+  return v;
+}
+
+/// \brief Append a length which didn't fit in a token nibble.
+/// \param[in] _len Remaining length, after subtracting 15.
+/// \param[out] _out Output.
+void WriteLength(std::size_t _len, std::string &_out)
+{
+  while (_len >= 255)
+  {
+    _out.push_back(static_cast<char>(255));
+    _len -= 255;
+  }
+  _out.push_back(static_cast<char>(_len));
+}
+
+/// \brief Read a length which didn't fit in a token nibble.
+/// \param[in,out] _p Current input position.
+/// \param[in] _end End of the input.
+/// \param[out] _len Length to add to.
+/// \return False if the input ended.
+bool ReadLength(const unsigned char *&_p, const unsigned char *_end,
+    std::size_t &_len)
+{
+  unsigned char b;
+  do
+  {
+    if (_p == _end)
+      return false;
+    b = *_p++;
+    _len += b;
+  } while (b == 255);
+  return true;
+}
+
+/// \brief Append a sequence of literals followed by an optional match.
+/// \param[in] _literals Start of the literals.
+/// \param[in] _literalCount Number of literals.
+/// \param[in] _offset Distance back to the match, zero for the last
+/// sequence, which has no match.
+/// \param[in] _matchLength Length of the match.
+/// \param[out] _out Output.
+void WriteSequence(const unsigned char *_literals, std::size_t _literalCount,
+    std::size_t _offset, std::size_t _matchLength, std::string &_out)
+{
+  const std::size_t matchCode = _offset == 0 ? 0 : _matchLength - kMinMatch;
+  const unsigned char token = static_cast<unsigned char>(
+      (std::min<std::size_t>(_literalCount, 15) << 4) |
+      std::min<std::size_t>(matchCode, 15));
+  _out.push_back(static_cast<char>(token));
+  if (_literalCount >= 15)
+    WriteLength(_literalCount - 15, _out);
+  _out.append(reinterpret_cast<const char *>(_literals), _literalCount);
+
+  if (_offset == 0)
+    return;
+
+  _out.push_back(static_cast<char>(_offset & 0xFF));
+  _out.push_back(static_cast<char>(_offset >> 8));
+  if (matchCode >= 15)
+    WriteLength(matchCode - 15, _out);
+}
+
+/// \brief Compress with the LZ codec. Each sequence is a token with the
+/// literal count and match length in its nibbles, the literals, and the
+/// match offset. The last sequence only has literals.
+/// \param[in] _in Input.
+/// \param[out] _out Output, appended to.
+void CompressLz(const std::string &_in, std::string &_out)
+{
+  const auto src = reinterpret_cast<const unsigned char *>(_in.data());
+  const std::size_t size = _in.size();
+
+  // Most recent position + 1 of each hashed 4-byte sequence
+  std::vector<uint32_t> table(1u << kHashBits, 0);
+
+  std::size_t anchor{0};
+  std::size_t i{0};
+  while (i + kMinMatch <= size)
+  {
+    const uint32_t v = Read32(src + i);
+    const uint32_t hash = (v * 2654435761u) >> (32 - kHashBits);
+    const std::size_t candidate = table[hash];
+    table[hash] = static_cast<uint32_t>(i + 1);
+
+    if (candidate == 0 || i - (candidate - 1) > kMaxOffset ||
+        Read32(src + candidate - 1) != v)
+    {
+      ++i;
+      continue;
+    }
+
+    const std::size_t match = candidate - 1;
+    std::size_t length{kMinMatch};
+    while (i + length < size && src[match + length] == src[i + length])
+      ++length;
+
+    WriteSequence(src + anchor, i - anchor, i - match, length, _out);
+    i += length;
+    anchor = i;
+  }
+
+  WriteSequence(src + anchor, size - anchor, 0, 0, _out);
+}
+
+/// \brief Decompress with the LZ codec.
+/// \param[in] _in Start of the compressed data.
+/// \param[in] _end End of the compressed data.
+/// \param[in] _size Expected output size.
+/// \param[out] _out Output.
+/// \return False if the input is corrupt.
+bool DecompressLz(const unsigned char *_in, const unsigned char *_end,
+    std::size_t _size, std::string &_out)
+{
+  _out.resize(_size);
+  auto dst = reinterpret_cast<unsigned char *>(&_out[0]);
+  std::size_t pos{0};
+
+  const unsigned char *p = _in;
+  while (p < _end)
+  {
+    const unsigned char token = *p++;
+
+    std::size_t literalCount = token >> 4;
+    if (literalCount == 15 && !ReadLength(p, _end, literalCount))
+      return false;
+    if (literalCount > static_cast<std::size_t>(_end - p) ||
+        literalCount > _size - pos)
+    {
+      return false;
+    }
+    std::memcpy(dst + pos, p, literalCount);
+    p += literalCount;
+    pos += literalCount;
+
+    // Last sequence
+    if (p == _end)
+      break;
+
+    if (_end - p < 2)
+      return false;
+    const std::size_t offset = p[0] | (static_cast<std::size_t>(p[1]) << 8);
+    p += 2;
+    if (offset == 0 || offset > pos)
+      return false;
+
+    std::size_t length = token & 0x0F;
+    if (length == 15 && !ReadLength(p, _end, length))
+      return false;
+    length += kMinMatch;
+    if (length > _size - pos)
+      return false;
+
+    // Matches can overlap the bytes they produce
+    const unsigned char *match = dst + pos - offset;
+    for (std::size_t j = 0; j < length; ++j)
+      dst[pos + j] = match[j];
+    pos += length;
+  }
+
+  return pos == _size;
+}
+}
+
+//////////////////////////////////////////////////
+bool ignition::gazebo::BlockCodecAvailable(BlockCodec _codec)
+{
+  switch (_codec)
+  {
+    case BlockCodec::NONE:
+    case BlockCodec::LZ:
+      return true;
+    case BlockCodec::ZSTD:
+#ifdef HAVE_ZSTD
+      return true;
+#else
+      return false;
+#endif
+  }
+  return false;
+}
+
+//////////////////////////////////////////////////
+bool ignition::gazebo::BlockCodecFromName(const std::string &_name,
+    BlockCodec &_codec)
+{
+  if (_name == "none")
+    _codec = BlockCodec::NONE;
+  else if (_name == "lz")
+    _codec = BlockCodec::LZ;
+  else if (_name == "zstd")
+    _codec = BlockCodec::ZSTD;
+  else
+    return false;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool ignition::gazebo::CompressBlock(const std::string &_in,
+    BlockCodec _codec, std::string &_out)
+{
+  if (!BlockCodecAvailable(_codec) ||
+      _in.size() > std::numeric_limits<uint32_t>::max())
+  {
+    return false;
+  }
+
+  const auto size = static_cast<uint32_t>(_in.size());
+  _out.clear();
+  _out.push_back(static_cast<char>(_codec));
+  for (int i = 0; i < 4; ++i)
+    _out.push_back(static_cast<char>((size >> (8 * i)) & 0xFF));
+
+  switch (_codec)
+  {
+    case BlockCodec::NONE:
+      _out.append(_in);
+      return true;
+    case BlockCodec::LZ:
+      CompressLz(_in, _out);
+      return true;
+    case BlockCodec::ZSTD:
+    {
+#ifdef HAVE_ZSTD
+      _out.resize(kHeaderSize + ZSTD_compressBound(_in.size()));
+      auto written = ZSTD_compress(&_out[kHeaderSize],
+          _out.size() - kHeaderSize, _in.data(), _in.size(), 3);
+      if (ZSTD_isError(written))
+        return false;
+      _out.resize(kHeaderSize + written);
+      return true;
+#else
+      return false;
+#endif
+    }
+  }
+  return false;
+}
+
+//////////////////////////////////////////////////
+bool ignition::gazebo::DecompressBlock(const std::string &_in,
+    std::string &_out)
+{
+  if (_in.size() < kHeaderSize)
+    return false;
+
+  const auto data = reinterpret_cast<const unsigned char *>(_in.data());
+  std::size_t size{0};
+  for (int i = 0; i < 4; ++i)
+    size |= static_cast<std::size_t>(data[1 + i]) << (8 * i);
+
+  switch (static_cast<BlockCodec>(data[0]))
+  {
+    case BlockCodec::NONE:
+      if (_in.size() - kHeaderSize != size)
+        return false;
+      _out.assign(_in, kHeaderSize, size);
+      return true;
+    case BlockCodec::LZ:
+      return DecompressLz(data + kHeaderSize, data + _in.size(), size, _out);
+    case BlockCodec::ZSTD:
+    {
+#ifdef HAVE_ZSTD
+      _out.resize(size);
+      auto read = ZSTD_decompress(&_out[0], size, data + kHeaderSize,
+          _in.size() - kHeaderSize);
+      return !ZSTD_isError(read) && read == size;
+#else
+      return false;
+#endif
+    }
+  }
+  return false;
+}
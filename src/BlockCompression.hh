@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_BLOCKCOMPRESSION_HH_
+#define IGNITION_GAZEBO_BLOCKCOMPRESSION_HH_
+
+#include <cstdint>
+#include <string>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \brief Codecs which can compress a block of bytes, such as a
+    /// serialized message.
+    enum class BlockCodec : uint8_t
+    {
+      /// \brief Stored as is.
+      NONE = 0,
+
+      /// \brief Built-in LZ77 codec, always available. Fast, with a modest
+      /// ratio.
+      LZ = 1,
+
+      /// \brief Zstandard, only available if built with libzstd. Better
+      /// ratio than LZ at a similar speed.
+      ZSTD = 2
+    };
+
+    /// \brief Check whether a codec is available in this build.
+    /// \param[in] _codec Codec to check.
+    /// \return True if blocks can be compressed and decompressed with it.
+    IGNITION_GAZEBO_VISIBLE
+    bool BlockCodecAvailable(BlockCodec _codec);
+
+    /// \brief Get a codec from its name.
+    /// \param[in] _name One of "none", "lz" or "zstd".
+    /// \param[out] _codec The codec.
+    /// \return False if the name is unknown.
+    IGNITION_GAZEBO_VISIBLE
+    bool BlockCodecFromName(const std::string &_name, BlockCodec &_codec);
+
+    /// \brief Compress a block. The result starts with a small header
+    /// holding the codec and the original size, so it can be decompressed
+    /// without knowing how it was compressed.
+    /// \param[in] _in Bytes to compress.
+    /// \param[in] _codec Codec to use.
+    /// \param[out] _out Compressed block.
+    /// \return False if the codec isn't available or the block is too large.
+    IGNITION_GAZEBO_VISIBLE
+    bool CompressBlock(const std::string &_in, BlockCodec _codec,
+        std::string &_out);
+
+    /// \brief Decompress a block created by CompressBlock.
+    /// \param[in] _in Compressed block.
+    /// \param[out] _out Original bytes.
+    /// \return False if the block is corrupt, or was compressed with a codec
+    /// which isn't available.
+    IGNITION_GAZEBO_VISIBLE
+    bool DecompressBlock(const std::string &_in, std::string &_out);
+    }
+  }
+}
+#endif
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BlockCompression.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Blocks which exercise the corner cases of the codecs.
+/// \return Blocks.
+std::vector<std::string> testBlocks()
+{
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int> byte(0, 255);
+
+  std::string random(100000, '\0');
+  for (auto &c : random)
+    c = static_cast<char>(byte(gen));
+
+  // Repeated records with a few changing bytes, like serialized states
+  std::string records;
+  for (int i = 0; i < 10000; ++i)
+  {
+    records += "entity/" + std::to_string(i % 100) + "/pose/";
+    records.push_back(static_cast<char>(byte(gen)));
+  }
+
+  return {"", "a", "abc", "abcd", std::string(1000, 'x'),
+      std::string(70000, 'y') + "z", random, records};
+}
+
+/////////////////////////////////////////////////
+TEST(BlockCompression, RoundTrip)
+{
+  for (auto codec : {BlockCodec::NONE, BlockCodec::LZ, BlockCodec::ZSTD})
+  {
+    if (!BlockCodecAvailable(codec))
+    {
+      std::string out;
+      EXPECT_FALSE(CompressBlock("abc", codec, out));
+      continue;
+    }
+
+    for (const auto &block : testBlocks())
+    {
+      std::string compressed;
+      ASSERT_TRUE(CompressBlock(block, codec, compressed));
+
+      std::string decompressed;
+      ASSERT_TRUE(DecompressBlock(compressed, decompressed));
+      EXPECT_EQ(block, decompressed);
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(BlockCompression, Ratio)
+{
+  std::string block;
+  for (int i = 0; i < 1000; ++i)
+    block += "ign_gazebo_components.Pose " + std::to_string(i % 10);
+
+  std::string compressed;
+  ASSERT_TRUE(CompressBlock(block, BlockCodec::LZ, compressed));
+  EXPECT_LT(compressed.size() * 10, block.size());
+}
+
+/////////////////////////////////////////////////
+TEST(BlockCompression, Corrupt)
+{
+  std::string out;
+  EXPECT_FALSE(DecompressBlock("", out));
+  EXPECT_FALSE(DecompressBlock("abc", out));
+
+  // Unknown codec
+  EXPECT_FALSE(DecompressBlock(std::string("\x7f\0\0\0\0", 5), out));
+
+  std::string compressed;
+  ASSERT_TRUE(CompressBlock(std::string(1000, 'x') + "end", BlockCodec::LZ,
+      compressed));
+
+  // Truncated
+  EXPECT_FALSE(DecompressBlock(
+      compressed.substr(0, compressed.size() - 1), out));
+
+  // Wrong size
+  auto wrongSize = compressed;
+  wrongSize[1] = static_cast<char>(wrongSize[1] + 1);
+  EXPECT_FALSE(DecompressBlock(wrongSize, out));
+}
+
+/////////////////////////////////////////////////
+TEST(BlockCompression, Names)
+{
+  BlockCodec codec;
+  EXPECT_TRUE(BlockCodecFromName("none", codec));
+  EXPECT_EQ(BlockCodec::NONE, codec);
+  EXPECT_TRUE(BlockCodecFromName("lz", codec));
+  EXPECT_EQ(BlockCodec::LZ, codec);
+  EXPECT_TRUE(BlockCodecFromName("zstd", codec));
+  EXPECT_EQ(BlockCodec::ZSTD, codec);
+  EXPECT_FALSE(BlockCodecFromName("gzip", codec));
+}
@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "ignition/gazebo/components/Component.hh"
+#include "ignition/gazebo/detail/ComponentStorageBase.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+using IntComponent = components::Component<int, class IntComponentTag>;
+
+/////////////////////////////////////////////////
+TEST(ComponentStorage, CreateRemove)
+{
+  ComponentStorage<IntComponent> storage;
+
+  std::vector<ComponentId> ids;
+  for (int i = 0; i < 5; ++i)
+  {
+    IntComponent comp(i);
+    auto result = storage.Create(&comp);
+    EXPECT_EQ(i, result.first);
+    ids.push_back(result.first);
+  }
+  ASSERT_EQ(5u, storage.components.size());
+
+  // Remove from the middle, the last component fills the hole
+  EXPECT_TRUE(storage.Remove(ids[1]));
+  EXPECT_FALSE(storage.Remove(ids[1]));
+  EXPECT_EQ(nullptr, storage.Component(ids[1]));
+  ASSERT_EQ(4u, storage.components.size());
+  EXPECT_EQ(4, storage.components[1].Data());
+
+  // All other ids still resolve to their components
+  for (int i : {0, 2, 3, 4})
+  {
+    auto comp = static_cast<const IntComponent *>(storage.Component(ids[i]));
+    ASSERT_NE(nullptr, comp);
+    EXPECT_EQ(i, comp->Data());
+  }
+
+  // Components are packed
+  EXPECT_EQ(&storage.components[0], storage.First());
+  EXPECT_EQ(sizeof(IntComponent),
+      reinterpret_cast<uintptr_t>(&storage.components[1]) -
+      reinterpret_cast<uintptr_t>(&storage.components[0]));
+
+  // Remove last
+  EXPECT_TRUE(storage.Remove(ids[3]));
+  EXPECT_EQ(3u, storage.components.size());
+  EXPECT_EQ(4, static_cast<const IntComponent *>(
+      storage.Component(ids[4]))->Data());
+
+  // Invalid ids
+  EXPECT_EQ(nullptr, storage.Component(kComponentIdInvalid));
+  EXPECT_EQ(nullptr, storage.Component(1000));
+  EXPECT_FALSE(storage.Remove(kComponentIdInvalid));
+}
+
+/////////////////////////////////////////////////
+TEST(ComponentStorage, StaleIds)
+{
+  ComponentStorage<IntComponent> storage;
+
+  IntComponent first(1);
+  auto firstId = storage.Create(&first).first;
+  EXPECT_TRUE(storage.Remove(firstId));
+
+  // The slot is reused, but the id is different
+  IntComponent second(2);
+  auto secondId = storage.Create(&second).first;
+  EXPECT_NE(firstId, secondId);
+  EXPECT_GE(secondId, 0);
+
+  EXPECT_EQ(nullptr, storage.Component(firstId));
+  EXPECT_FALSE(storage.Remove(firstId));
+
+  auto comp = static_cast<const IntComponent *>(storage.Component(secondId));
+  ASSERT_NE(nullptr, comp);
+  EXPECT_EQ(2, comp->Data());
+
+  // Generations wrap around without ids becoming negative
+  for (int i = 0; i < 1000; ++i)
+  {
+    IntComponent comp3(i);
+    auto id = storage.Create(&comp3).first;
+    EXPECT_GE(id, 0);
+    EXPECT_TRUE(storage.Remove(id));
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(ComponentStorage, RemoveAll)
+{
+  ComponentStorage<IntComponent> storage;
+  EXPECT_EQ(nullptr, storage.First());
+
+  bool expanded{false};
+  for (int i = 0; i < 1000; ++i)
+  {
+    IntComponent comp(i);
+    expanded = storage.Create(&comp).second || expanded;
+  }
+  EXPECT_TRUE(expanded);
+  EXPECT_EQ(1000u, storage.components.size());
+
+  storage.RemoveAll();
+  EXPECT_TRUE(storage.components.empty());
+  EXPECT_EQ(nullptr, storage.First());
+  EXPECT_EQ(nullptr, storage.Component(0));
+
+  IntComponent comp(5);
+  EXPECT_EQ(0, storage.Create(&comp).first);
+}
+
+/////////////////////////////////////////////////
+TEST(ComponentStorage, ChangeState)
+{
+  ComponentStorage<IntComponent> storage;
+
+  std::vector<ComponentId> ids;
+  for (int i = 0; i < 200; ++i)
+  {
+    IntComponent comp(i);
+    ids.push_back(storage.Create(&comp).first);
+    EXPECT_EQ(ComponentState::NoChange, storage.ChangeState(ids.back()));
+  }
+  EXPECT_FALSE(storage.HasOneTimeChanges());
+  EXPECT_FALSE(storage.HasPeriodicChanges());
+
+  storage.SetChangeState(ids[3], ComponentState::OneTimeChange);
+  storage.SetChangeState(ids[150], ComponentState::PeriodicChange);
+  EXPECT_EQ(ComponentState::OneTimeChange, storage.ChangeState(ids[3]));
+  EXPECT_EQ(ComponentState::PeriodicChange, storage.ChangeState(ids[150]));
+  EXPECT_EQ(ComponentState::NoChange, storage.ChangeState(ids[4]));
+  EXPECT_TRUE(storage.HasOneTimeChanges());
+  EXPECT_TRUE(storage.HasPeriodicChanges());
+
+  // A component has a single state
+  storage.SetChangeState(ids[3], ComponentState::PeriodicChange);
+  EXPECT_EQ(ComponentState::PeriodicChange, storage.ChangeState(ids[3]));
+  EXPECT_FALSE(storage.HasOneTimeChanges());
+
+  storage.SetChangeState(ids[3], ComponentState::NoChange);
+  EXPECT_EQ(ComponentState::NoChange, storage.ChangeState(ids[3]));
+  EXPECT_TRUE(storage.HasPeriodicChanges());
+
+  // Removed components don't leave their state to the slot's next user
+  EXPECT_TRUE(storage.Remove(ids[150]));
+  EXPECT_FALSE(storage.HasPeriodicChanges());
+  IntComponent comp(1000);
+  auto newId = storage.Create(&comp).first;
+  EXPECT_EQ(ComponentState::NoChange, storage.ChangeState(newId));
+
+  storage.SetChangeState(ids[0], ComponentState::OneTimeChange);
+  storage.SetChangeState(ids[199], ComponentState::PeriodicChange);
+  storage.SetAllUnchanged();
+  for (auto id : {ids[0], ids[199], newId})
+    EXPECT_EQ(ComponentState::NoChange, storage.ChangeState(id));
+  EXPECT_FALSE(storage.HasOneTimeChanges());
+  EXPECT_FALSE(storage.HasPeriodicChanges());
+
+  // Invalid ids
+  storage.SetChangeState(kComponentIdInvalid, ComponentState::OneTimeChange);
+  EXPECT_EQ(ComponentState::NoChange,
+      storage.ChangeState(kComponentIdInvalid));
+  EXPECT_FALSE(storage.HasOneTimeChanges());
+}
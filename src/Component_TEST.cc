@@ -18,7 +18,10 @@
 #include <gtest/gtest.h>
 #include <ignition/msgs/int32.pb.h>
 
+#include <iomanip>
+#include <limits>
 #include <memory>
+#include <string>
 
 #include <sdf/Element.hh>
 #include <ignition/common/Console.hh>
@@ -354,6 +357,93 @@ TEST_F(ComponentTest, OStream)
   }
 }
 
+// Serializer which changes the stream's formatting
+class PrecisionSerializer
+{
+  public: static std::ostream &Serialize(std::ostream &_out,
+      const double &_data)
+  {
+    _out << std::fixed << std::setprecision(2) << _data;
+    return _out;
+  }
+
+  public: static std::istream &Deserialize(std::istream &_in, double &_data)
+  {
+    _in >> _data;
+    return _in;
+  }
+};
+
+//////////////////////////////////////////////////
+/// Serializing into a string must give the same result as the stream
+TEST_F(ComponentTest, SerializeToString)
+{
+  auto expectSame = [](const components::BaseComponent &_comp)
+  {
+    std::ostringstream ostr;
+    _comp.Serialize(ostr);
+
+    // Previous contents are replaced
+    std::string str{"previous contents"};
+    _comp.SerializeToString(str);
+    EXPECT_EQ(ostr.str(), str);
+  };
+
+  // Integers and booleans
+  expectSame(components::Component<int, class CustomTag>(-123));
+  expectSame(components::Component<uint64_t, class CustomTag>(
+      std::numeric_limits<uint64_t>::max()));
+  expectSame(components::Component<int64_t, class CustomTag>(
+      std::numeric_limits<int64_t>::min()));
+  expectSame(components::Component<bool, class CustomTag>(true));
+  expectSame(components::Component<bool, class CustomTag>(false));
+  expectSame(components::Component<char, class CustomTag>('a'));
+
+  // Floating point goes through the stream, keeping its precision
+  expectSame(components::Component<double, class CustomTag>(1.23456789));
+
+  // Strings
+  expectSame(components::Component<std::string, class CustomTag>("banana"));
+  expectSame(components::Component<std::string, class CustomTag,
+      serializers::StringSerializer>("banana"));
+
+  // Long output is flushed in several pieces
+  expectSame(components::Component<std::string, class CustomTag>(
+      std::string(1000, 'x')));
+
+  // Stream operators
+  expectSame(CustomOperator(SimpleOperator()));
+  expectSame(components::Component<math::Inertiald, class CustomTag>(
+      math::Inertiald()));
+  expectSame(components::Component<std::shared_ptr<int>, class CustomTag>(
+      std::make_shared<int>(123)));
+
+  // Custom Serialize function
+  expectSame(InertialWrapper(math::Inertiald()));
+
+  // No data
+  expectSame(components::Component<components::NoData, class CustomTag>());
+
+  // Without Serialize function
+  expectSame(NoSerialize());
+
+  // Protobuf messages
+  {
+    msgs::Int32 data;
+    data.set_data(331);
+    expectSame(components::Component<msgs::Int32, class CustomTag,
+        serializers::MsgSerializer>(data));
+  }
+
+  // Formatting changes don't leak into following calls
+  {
+    using Custom = components::Component<double, class CustomTag,
+        PrecisionSerializer>;
+    expectSame(Custom(1.23456789));
+    expectSame(components::Component<double, class CustomTag>(1.23456789));
+  }
+}
+
 //////////////////////////////////////////////////
 TEST_F(ComponentTest, IStream)
 {
@@ -15,18 +15,28 @@
  *
 */
 
+#include <atomic>
+#include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <set>
+#include <shared_mutex>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include <ignition/common/Profiler.hh>
 #include <ignition/math/graph/GraphAlgorithms.hh>
 #include "ignition/gazebo/components/Component.hh"
 #include "ignition/gazebo/components/Factory.hh"
+#include "ignition/gazebo/components/ParentEntity.hh"
+#include "ignition/gazebo/components/Pose.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
 
+#include "ThreadPool.hh"
+
 using namespace ignition;
 using namespace gazebo;
 
@@ -58,9 +68,17 @@ class ignition::gazebo::EntityComponentManagerPrivate
   public: bool CreateComponentStorage(const ComponentTypeId _typeId);
 
   /// \brief Allots the work for multiple threads prior to running
-  /// `AddEntityToMessage`.
+  /// `AddEntityToMessage`. Must be called with stateChunksMutex locked.
   public: void CalculateStateThreadLoad();
 
+  /// \brief Get the thread pool, creating it if it hasn't been set.
+  /// \return The thread pool.
+  public: std::shared_ptr<ThreadPool> Pool();
+
+  /// \brief Get the thread pool without creating it.
+  /// \return The thread pool, or null if it hasn't been set or created yet.
+  public: std::shared_ptr<ThreadPool> ExistingPool() const;
+
   /// \brief Create a message for the removed components
   /// \param[in] _entity Entity with the removed components
   /// \param[in, out] _msg Entity message
@@ -85,6 +103,45 @@ class ignition::gazebo::EntityComponentManagerPrivate
   /// \param[in] _entity Entity that has component newly modified
   public: void AddModifiedComponent(const Entity &_entity);
 
+  /// \brief Invalidate the component pointers cached by all views which
+  /// contain a component type. This must be called whenever the storage for
+  /// that type moves its components in memory.
+  /// \param[in] _typeId Component type.
+  public: void InvalidateViews(const ComponentTypeId _typeId);
+
+  /// \brief Flag an entity's component to be re-indexed before the next
+  /// indexed query, if its type is indexed.
+  /// \param[in] _entity Entity whose component may have changed.
+  /// \param[in] _typeId Component type.
+  public: void MarkIndexDirty(const Entity _entity,
+      const ComponentTypeId _typeId);
+
+  /// \brief Secondary index on the values of a component type.
+  public: struct ComponentIndex
+  {
+    /// \brief Hashes the value of a component of the indexed type.
+    std::function<std::size_t(const components::BaseComponent *)> hash;
+
+    /// \brief Indexed entities, keyed by the hash of their component.
+    std::unordered_map<std::size_t, std::set<Entity>> entities;
+
+    /// \brief Hash each indexed entity is currently stored under.
+    std::unordered_map<Entity, std::size_t> hashes;
+
+    /// \brief Entities whose component may have changed since it was last
+    /// indexed.
+    std::unordered_set<Entity> dirty;
+  };
+
+  /// \brief Value indexes, keyed by component type. Only modified by
+  /// EnableComponentIndex, so it can be looked up without locking.
+  public: mutable std::unordered_map<ComponentTypeId, ComponentIndex>
+      componentIndexes;
+
+  /// \brief Protects the contents of componentIndexes, which are updated
+  /// from const queries and from concurrently running systems.
+  public: mutable std::mutex componentIndexesMutex;
+
   /// \brief Map of component storage classes. The key is a component
   /// type id, and the value is a pointer to the component storage.
   public: std::unordered_map<ComponentTypeId,
@@ -94,12 +151,6 @@ class ignition::gazebo::EntityComponentManagerPrivate
   /// parenting.
   public: EntityGraph entities;
 
-  /// \brief Components that have been changed through a peridic change.
-  public: std::set<ComponentKey> periodicChangedComponents;
-
-  /// \brief Components that have been changed through a one-time change.
-  public: std::set<ComponentKey> oneTimeChangedComponents;
-
   /// \brief Entities that have just been created
   public: std::unordered_set<Entity> newlyCreatedEntities;
 
@@ -166,6 +217,31 @@ class ignition::gazebo::EntityComponentManagerPrivate
 
   /// \brief Set of entities that are prevented from removal.
   public: std::unordered_set<Entity> pinnedEntities;
+
+  /// \brief Thread pool used by EachParallel. Shared with the runner.
+  public: mutable std::shared_ptr<ThreadPool> threadPool;
+
+  /// \brief Protects the lazy creation of threadPool.
+  public: mutable std::mutex threadPoolMutex;
+
+  /// \brief Protects entityComponentIterators, which are recalculated
+  /// from const functions.
+  public: std::mutex stateChunksMutex;
+
+  /// \brief Protects modifiedComponents from SetChanged, which may be
+  /// called by systems updated concurrently. The change states themselves
+  /// are atomic bits in the component storages.
+  public: std::mutex changedComponentsMutex;
+
+  /// \brief Cache of world poses computed by WorldPose.
+  public: mutable std::unordered_map<Entity, math::Pose3d> worldPoses;
+
+  /// \brief True if worldPoses must be cleared before being used again.
+  public: mutable std::atomic<bool> worldPosesDirty{false};
+
+  /// \brief Protects worldPoses, which is filled from const functions that
+  /// may be called concurrently.
+  public: mutable std::shared_mutex worldPosesMutex;
 };
 
 //////////////////////////////////////////////////
@@ -365,6 +441,15 @@ void EntityComponentManager::ProcessRemoveEntityRequests()
 
     // All views are now invalid.
     this->dataPtr->views.clear();
+
+    std::lock_guard<std::mutex> indexLock(
+        this->dataPtr->componentIndexesMutex);
+    for (auto &index : this->dataPtr->componentIndexes)
+    {
+      index.second.entities.clear();
+      index.second.hashes.clear();
+      index.second.dirty.clear();
+    }
   }
   else
   {
@@ -386,6 +471,8 @@ void EntityComponentManager::ProcessRemoveEntityRequests()
         for (const auto &key : entityIter->second)
         {
           this->dataPtr->components.at(key.first)->Remove(key.second);
+          this->dataPtr->InvalidateViews(key.first);
+          this->dataPtr->MarkIndexDirty(entity, key.first);
         }
 
         // Remove the entry in the entityComponent map
@@ -405,6 +492,8 @@ void EntityComponentManager::ProcessRemoveEntityRequests()
 
   // Reset descendants cache
   this->dataPtr->descendantCache.clear();
+
+  this->InvalidateWorldPoses();
 }
 
 /////////////////////////////////////////////////
@@ -426,10 +515,11 @@ bool EntityComponentManager::RemoveComponent(
     return false;
 
   this->dataPtr->components.at(_key.first)->Remove(_key.second);
+  this->dataPtr->InvalidateViews(_key.first);
   this->dataPtr->entityComponents[_entity].erase(_key.first);
-  this->dataPtr->oneTimeChangedComponents.erase(_key);
-  this->dataPtr->periodicChangedComponents.erase(_key);
   this->dataPtr->entityComponentsDirty = true;
+  this->InvalidateWorldPoses(_key.first);
+  this->dataPtr->MarkIndexDirty(_entity, _key.first);
 
   this->UpdateViews(_entity);
 
@@ -505,20 +595,8 @@ ComponentState EntityComponentManager::ComponentState(const Entity _entity,
   if (typeKey == ecIter->second.end())
     return result;
 
-  ComponentKey key{_typeId, typeKey->second};
-
-  if (this->dataPtr->oneTimeChangedComponents.find(key) !=
-      this->dataPtr->oneTimeChangedComponents.end())
-  {
-    result = ComponentState::OneTimeChange;
-  }
-  else if (this->dataPtr->periodicChangedComponents.find(key) !=
-      this->dataPtr->periodicChangedComponents.end())
-  {
-    result = ComponentState::PeriodicChange;
-  }
-
-  return result;
+  return this->dataPtr->components.at(_typeId)->ChangeState(
+      typeKey->second);
 }
 
 /////////////////////////////////////////////////
@@ -539,7 +617,12 @@ bool EntityComponentManager::HasEntitiesMarkedForRemoval() const
 /////////////////////////////////////////////////
 bool EntityComponentManager::HasOneTimeComponentChanges() const
 {
-  return !this->dataPtr->oneTimeChangedComponents.empty();
+  for (const auto &storage : this->dataPtr->components)
+  {
+    if (storage.second->HasOneTimeChanges())
+      return true;
+  }
+  return false;
 }
 
 /////////////////////////////////////////////////
@@ -547,9 +630,10 @@ std::unordered_set<ComponentTypeId>
     EntityComponentManager::ComponentTypesWithPeriodicChanges() const
 {
   std::unordered_set<ComponentTypeId> periodicComponents;
-  for (const auto& compPair : this->dataPtr->periodicChangedComponents)
+  for (const auto &storage : this->dataPtr->components)
   {
-    periodicComponents.insert(compPair.first);
+    if (storage.second->HasPeriodicChanges())
+      periodicComponents.insert(storage.first);
   }
   return periodicComponents;
 }
@@ -572,6 +656,78 @@ Entity EntityComponentManager::ParentEntity(const Entity _entity) const
   return parents.begin()->first;
 }
 
+/////////////////////////////////////////////////
+std::optional<math::Pose3d> EntityComponentManager::WorldPose(
+    const Entity _entity) const
+{
+  {
+    std::shared_lock<std::shared_mutex> lock(this->dataPtr->worldPosesMutex);
+    if (!this->dataPtr->worldPosesDirty)
+    {
+      auto iter = this->dataPtr->worldPoses.find(_entity);
+      if (iter != this->dataPtr->worldPoses.end())
+        return iter->second;
+    }
+  }
+
+  auto poseComp = this->Component<components::Pose>(_entity);
+  if (nullptr == poseComp)
+    return std::nullopt;
+
+  std::unique_lock<std::shared_mutex> lock(this->dataPtr->worldPosesMutex);
+  if (this->dataPtr->worldPosesDirty)
+  {
+    this->dataPtr->worldPoses.clear();
+    this->dataPtr->worldPosesDirty = false;
+  }
+
+  // Walk up the tree until an ancestor whose world pose is known, then
+  // compose the poses back down, caching them for all entities on the way.
+  std::vector<std::pair<Entity, const math::Pose3d *>> chain;
+  math::Pose3d pose;
+  Entity entity = _entity;
+  while (nullptr != poseComp)
+  {
+    auto cached = this->dataPtr->worldPoses.find(entity);
+    if (cached != this->dataPtr->worldPoses.end())
+    {
+      pose = cached->second;
+      break;
+    }
+    chain.emplace_back(entity, &poseComp->Data());
+
+    auto parentComp = this->Component<components::ParentEntity>(entity);
+    if (nullptr == parentComp)
+      break;
+    entity = parentComp->Data();
+    poseComp = this->Component<components::Pose>(entity);
+  }
+
+  for (auto iter = chain.rbegin(); iter != chain.rend(); ++iter)
+  {
+    pose = *iter->second + pose;
+    this->dataPtr->worldPoses[iter->first] = pose;
+  }
+  return pose;
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::InvalidateWorldPoses(
+    const ComponentTypeId _typeId)
+{
+  if (_typeId == components::Pose::typeId ||
+      _typeId == components::ParentEntity::typeId)
+  {
+    this->InvalidateWorldPoses();
+  }
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::InvalidateWorldPoses()
+{
+  this->dataPtr->worldPosesDirty = true;
+}
+
 /////////////////////////////////////////////////
 bool EntityComponentManager::SetParentEntity(const Entity _child,
     const Entity _parent)
@@ -624,20 +780,25 @@ ComponentKey EntityComponentManager::CreateComponentImplementation(
   this->dataPtr->AddModifiedComponent(_entity);
 
   // Instantiate the new component.
-  std::pair<ComponentId, bool> componentIdPair =
-    this->dataPtr->components[_componentTypeId]->Create(_data);
+  auto &storage = this->dataPtr->components[_componentTypeId];
+  std::pair<ComponentId, bool> componentIdPair = storage->Create(_data);
 
   ComponentKey componentKey{_componentTypeId, componentIdPair.first};
 
   this->dataPtr->entityComponents[_entity].insert(
       {_componentTypeId, componentIdPair.first});
-  this->dataPtr->oneTimeChangedComponents.insert(componentKey);
+  storage->SetChangeState(componentIdPair.first,
+      ComponentState::OneTimeChange);
   this->dataPtr->entityComponentsDirty = true;
+  this->InvalidateWorldPoses(_componentTypeId);
+  this->dataPtr->MarkIndexDirty(_entity, _componentTypeId);
 
+  // Component ids are stable, but the storage's components have moved in
+  // memory if it expanded.
   if (componentIdPair.second)
-    this->RebuildViews();
-  else
-    this->UpdateViews(_entity);
+    this->dataPtr->InvalidateViews(_componentTypeId);
+
+  this->UpdateViews(_entity);
 
   return componentKey;
 }
@@ -709,10 +870,10 @@ components::BaseComponent *EntityComponentManager::ComponentImplementation(
     return nullptr;
 
   auto typeIter = ecIter->second.find(_type);
-  if (typeIter != ecIter->second.end())
-    return this->dataPtr->components.at(_type)->Component(typeIter->second);
+  if (typeIter == ecIter->second.end())
+    return nullptr;
 
-  return nullptr;
+  return this->dataPtr->components.at(_type)->Component(typeIter->second);
 }
 
 /////////////////////////////////////////////////
@@ -842,8 +1003,7 @@ void EntityComponentManager::RebuildViews()
   IGN_PROFILE("EntityComponentManager::RebuildViews");
   for (auto &view : this->dataPtr->views)
   {
-    view.second.entities.clear();
-    view.second.components.clear();
+    view.second.Reset();
     // Add all the entities that match the component types to the
     // view.
     for (const auto &vertex : this->dataPtr->entities.Vertices())
@@ -982,10 +1142,8 @@ void EntityComponentManager::AddEntityToMessage(msgs::SerializedState &_msg,
     auto compBase = this->ComponentImplementation(_entity, type);
     compMsg->set_type(compBase->TypeId());
 
-    std::ostringstream ostr;
-    compBase->Serialize(ostr);
-
-    compMsg->set_component(ostr.str());
+    // Serialize straight into the message
+    compBase->SerializeToString(*compMsg->mutable_component());
   }
 
   // Add a component to the message and set it to be removed if the component
@@ -1014,49 +1172,23 @@ void EntityComponentManager::AddEntityToMessage(msgs::SerializedStateMap &_msg,
     entIter = _msg.mutable_entities()->find(_entity);
     if (entIter == _msg.mutable_entities()->end())
     {
-      msgs::SerializedEntityMap ent;
-      ent.set_id(_entity);
-      (*_msg.mutable_entities())[static_cast<uint64_t>(_entity)] = ent;
+      (*_msg.mutable_entities())[static_cast<uint64_t>(_entity)].set_id(
+          _entity);
       entIter = _msg.mutable_entities()->find(_entity);
     }
 
     entIter->second.set_remove(true);
   }
 
-  // Insert all of the entity's components if the passed in types
-  // set is empty
-  auto types = _types;
-  if (types.empty())
-  {
-    for (auto &type : this->dataPtr->entityComponents[_entity])
-    {
-      types.insert(type.first);
-    }
-  }
-
-  // Empty means all types
-  for (const ComponentTypeId type : types)
+  auto addComponent = [&](const ComponentTypeId _type, const ComponentId _id)
   {
-    auto typeIter = iter->second.find(type);
-    if (typeIter == iter->second.end())
-    {
-      continue;
-    }
-
-    const components::BaseComponent *compBase =
-      this->ComponentImplementation(_entity, type);
-
-    ComponentKey comp = {type, typeIter->second};
+    const auto &storage = this->dataPtr->components.at(_type);
 
     // If not sending full state, skip unchanged components
-    if (!_full &&
-        this->dataPtr->oneTimeChangedComponents.find(comp) ==
-        this->dataPtr->oneTimeChangedComponents.end() &&
-        this->dataPtr->periodicChangedComponents.find(comp) ==
-        this->dataPtr->periodicChangedComponents.end())
-    {
-      continue;
-    }
+    if (!_full && storage->ChangeState(_id) == ComponentState::NoChange)
+      return;
+
+    const components::BaseComponent *compBase = storage->Component(_id);
 
     /// Find the entity in the message, if not already found.
     /// Add the entity to the message, if not already added.
@@ -1065,29 +1197,40 @@ void EntityComponentManager::AddEntityToMessage(msgs::SerializedStateMap &_msg,
       entIter = _msg.mutable_entities()->find(_entity);
       if (entIter == _msg.mutable_entities()->end())
       {
-        msgs::SerializedEntityMap ent;
-        ent.set_id(_entity);
-        (*_msg.mutable_entities())[static_cast<uint64_t>(_entity)] = ent;
+        (*_msg.mutable_entities())[static_cast<uint64_t>(_entity)].set_id(
+            _entity);
         entIter = _msg.mutable_entities()->find(_entity);
       }
     }
 
-    auto compIter = entIter->second.mutable_components()->find(comp.first);
     // Find the component in the message, and add the component to the
     // message if it's not present.
-    if (compIter == entIter->second.mutable_components()->end())
+    auto &compMsg = (*(entIter->second.mutable_components()))[
+        static_cast<int64_t>(_type)];
+    compMsg.set_type(compBase->TypeId());
+
+    // Serialize straight into the message
+    compBase->SerializeToString(*compMsg.mutable_component());
+  };
+
+  // Empty means all types
+  if (_types.empty())
+  {
+    for (const auto &typeIter : iter->second)
     {
-      msgs::SerializedComponent cmp;
-      cmp.set_type(compBase->TypeId());
-      (*(entIter->second.mutable_components()))[
-        static_cast<int64_t>(comp.first)] = cmp;
-      compIter = entIter->second.mutable_components()->find(comp.first);
+      addComponent(typeIter.first, typeIter.second);
+    }
+  }
+  else
+  {
+    for (const ComponentTypeId type : _types)
+    {
+      auto typeIter = iter->second.find(type);
+      if (typeIter != iter->second.end())
+      {
+        addComponent(type, typeIter->second);
+      }
     }
-
-    // Serialize and store the message
-    std::ostringstream ostr;
-    compBase->Serialize(ostr);
-    compIter->second.set_component(ostr.str());
   }
 
   // Add a component to the message and set it to be removed if the component
@@ -1157,21 +1300,26 @@ void EntityComponentManagerPrivate::CalculateStateThreadLoad()
   auto startIt = this->entityComponents.begin();
   int numComponents = this->entityComponents.size();
 
-  // Set the number of threads to spawn to the min of the calculated thread
-  // count or max threads that the hardware supports
-  int maxThreads = std::thread::hardware_concurrency();
-  uint64_t numThreads = std::min(numComponents, maxThreads);
+  // Split the work in a couple of chunks per pool thread, so that stealing
+  // can even out entities with more components. Tiny maps aren't split, and
+  // without a pool everything is serialized on the calling thread.
+  const int minComponentsPerChunk{16};
+  auto pool = this->ExistingPool();
+  const int maxChunks = pool ?
+      static_cast<int>(pool->ThreadCount() + 1) * 2 : 1;
+  const int numChunks = std::max(1, std::min(maxChunks,
+      numComponents / minComponentsPerChunk));
 
   int componentsPerThread = static_cast<int>(std::ceil(
-    static_cast<double>(numComponents) / numThreads));
+    static_cast<double>(numComponents) / numChunks));
 
-  igndbg << "Updated state thread iterators: " << numThreads
-         << " threads processing around " << componentsPerThread
+  igndbg << "Updated state thread iterators: " << numChunks
+         << " chunks processing around " << componentsPerThread
          << " components each." << std::endl;
 
   // Push back the starting iterator
   this->entityComponentIterators.push_back(startIt);
-  for (uint64_t i = 0; i < numThreads; ++i)
+  for (int i = 0; i < numChunks; ++i)
   {
     // If we have added all of the components to the iterator vector, we are
     // done so push back the end iterator
@@ -1190,6 +1338,32 @@ void EntityComponentManagerPrivate::CalculateStateThreadLoad()
   }
 }
 
+//////////////////////////////////////////////////
+std::shared_ptr<ThreadPool> EntityComponentManagerPrivate::Pool()
+{
+  std::shared_ptr<ThreadPool> pool;
+  {
+    std::lock_guard<std::mutex> lock(this->threadPoolMutex);
+    if (this->threadPool)
+      return this->threadPool;
+    this->threadPool = std::make_shared<ThreadPool>();
+    pool = this->threadPool;
+  }
+
+  // State chunks were computed for serial serialization
+  std::lock_guard<std::mutex> lock(this->stateChunksMutex);
+  this->entityComponentsDirty = true;
+  return pool;
+}
+
+//////////////////////////////////////////////////
+std::shared_ptr<ThreadPool> EntityComponentManagerPrivate::ExistingPool()
+    const
+{
+  std::lock_guard<std::mutex> lock(this->threadPoolMutex);
+  return this->threadPool;
+}
+
 //////////////////////////////////////////////////
 ignition::msgs::SerializedState EntityComponentManager::State(
     const std::unordered_set<Entity> &_entities,
@@ -1217,46 +1391,61 @@ void EntityComponentManager::State(
     const std::unordered_set<ComponentTypeId> &_types,
     bool _full) const
 {
-  std::mutex stateMapMutex;
-  std::vector<std::thread> workers;
+  IGN_PROFILE("EntityComponentManager::State Map");
 
-  this->dataPtr->CalculateStateThreadLoad();
+  // Several systems may serialize concurrently during PostUpdate, so work
+  // on a copy of the chunk boundaries.
+  std::vector<std::unordered_map<Entity,
+      std::unordered_map<ComponentTypeId, ComponentId>>::iterator> chunks;
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->stateChunksMutex);
+    this->dataPtr->CalculateStateThreadLoad();
+    chunks = this->dataPtr->entityComponentIterators;
+  }
 
-  auto functor = [&](auto itStart, auto itEnd)
+  if (chunks.size() < 2)
+    return;
+
+  auto serializeChunk = [&](size_t _chunk, msgs::SerializedStateMap &_msg)
   {
-    msgs::SerializedStateMap threadMap;
-    while (itStart != itEnd)
+    for (auto it = chunks[_chunk]; it != chunks[_chunk + 1]; ++it)
     {
-      auto entity = (*itStart).first;
+      auto entity = it->first;
       if (_entities.empty() || _entities.find(entity) != _entities.end())
       {
-        this->AddEntityToMessage(threadMap, entity, _types, _full);
+        this->AddEntityToMessage(_msg, entity, _types, _full);
       }
-      itStart++;
-    }
-    std::lock_guard<std::mutex> lock(stateMapMutex);
-
-    for (const auto &entity : threadMap.entities())
-    {
-      (*_state.mutable_entities())[static_cast<uint64_t>(entity.first)] =
-          entity.second;
     }
   };
 
-  // Spawn workers
-  uint64_t numThreads = this->dataPtr->entityComponentIterators.size() - 1;
-  for (uint64_t i = 0; i < numThreads; i++)
+  const size_t numChunks = chunks.size() - 1;
+  auto pool = this->dataPtr->ExistingPool();
+  if (numChunks == 1 || !pool)
   {
-    workers.push_back(std::thread(functor,
-        this->dataPtr->entityComponentIterators[i],
-        this->dataPtr->entityComponentIterators[i+1]));
+    for (size_t i = 0; i < numChunks; ++i)
+      serializeChunk(i, _state);
+    return;
   }
 
-  // Wait for each thread to finish processing its components
-  std::for_each(workers.begin(), workers.end(), [](std::thread &_t)
+  // Each chunk is serialized into its own message by the pool
+  std::vector<msgs::SerializedStateMap> chunkMsgs(numChunks);
+  pool->ParallelFor(numChunks,
+      [&](size_t _begin, size_t _end)
+      {
+        for (size_t i = _begin; i < _end; ++i)
+          serializeChunk(i, chunkMsgs[i]);
+      });
+
+  // Entities don't repeat across chunks, so their messages can be swapped
+  // into the output instead of copied.
+  auto &entities = *_state.mutable_entities();
+  for (auto &chunkMsg : chunkMsgs)
   {
-    _t.join();
-  });
+    for (auto &entity : *chunkMsg.mutable_entities())
+    {
+      entities[entity.first].Swap(&entity.second);
+    }
+  }
 }
 
 //////////////////////////////////////////////////
@@ -1264,6 +1453,9 @@ void EntityComponentManager::SetState(
     const ignition::msgs::SerializedState &_stateMsg)
 {
   IGN_PROFILE("EntityComponentManager::SetState Non-map");
+  // Components may be deserialized in place without being marked as changed
+  this->InvalidateWorldPoses();
+
   // Create / remove / update entities
   for (int e = 0; e < _stateMsg.entities_size(); ++e)
   {
@@ -1313,53 +1505,44 @@ void EntityComponentManager::SetState(
         continue;
       }
 
-      // Create component
-      auto newComp = components::Factory::Instance()->New(compMsg.type());
-
-      if (nullptr == newComp)
-      {
-        ignerr << "Failed to deserialize component of type [" << compMsg.type()
-               << "]" << std::endl;
-        continue;
-      }
-
-      std::istringstream istr(compMsg.component());
-      newComp->Deserialize(istr);
-
-      // Get type id
-      auto typeId = newComp->TypeId();
-
-      // TODO(louise) Move into if, see TODO below
-      this->RemoveComponent(entity, typeId);
-
       // Remove component
       if (compMsg.remove())
       {
+        this->RemoveComponent(entity, type);
         continue;
       }
 
       // Get Component
-      auto comp = this->ComponentImplementation(entity, typeId);
+      components::BaseComponent *comp =
+        this->ComponentImplementation(entity, type);
 
       // Create if new
       if (nullptr == comp)
       {
-        this->CreateComponentImplementation(entity, typeId, newComp.get());
+        // Create component
+        auto newComp = components::Factory::Instance()->New(type);
+
+        if (nullptr == newComp)
+        {
+          ignerr << "Failed to deserialize component of type [" << type
+                 << "]" << std::endl;
+          continue;
+        }
+
+        std::istringstream istr(compMsg.component());
+        newComp->Deserialize(istr);
+
+        this->CreateComponentImplementation(entity, newComp->TypeId(),
+            newComp.get());
       }
-      // Update component value
+      // Update component value in place. This message type doesn't tell
+      // periodic from one-time changes, and replacing the component used to
+      // flag it as a one-time change, so keep doing that.
       else
       {
-        ignerr << "Internal error" << std::endl;
-        // TODO(louise) We're shortcutting above and always  removing the
-        // component so that we don't get here, gotta figure out why this
-        // doesn't update the component. The following line prints the correct
-        // values.
-        // igndbg << *comp << "  " << *newComp.get() << std::endl;
-        // *comp = *newComp.get();
-
-        // When above TODO is addressed, uncomment AddModifiedComponent below
-        // unless calling SetChanged (which already calls AddModifiedComponent)
-        // this->dataPtr->AddModifiedComponent(entity);
+        std::istringstream istr(compMsg.component());
+        comp->Deserialize(istr);
+        this->SetChanged(entity, type, ComponentState::OneTimeChange);
       }
     }
   }
@@ -1370,6 +1553,9 @@ void EntityComponentManager::SetState(
     const ignition::msgs::SerializedStateMap &_stateMsg)
 {
   IGN_PROFILE("EntityComponentManager::SetState Map");
+  // Components may be deserialized in place without being marked as changed
+  this->InvalidateWorldPoses();
+
   // Create / remove / update entities
   for (const auto &iter : _stateMsg.entities())
   {
@@ -1484,8 +1670,8 @@ std::unordered_set<Entity> EntityComponentManager::Descendants(Entity _entity)
 //////////////////////////////////////////////////
 void EntityComponentManager::SetAllComponentsUnchanged()
 {
-  this->dataPtr->periodicChangedComponents.clear();
-  this->dataPtr->oneTimeChangedComponents.clear();
+  for (auto &storage : this->dataPtr->components)
+    storage.second->SetAllUnchanged();
   this->dataPtr->modifiedComponents.clear();
 }
 
@@ -1503,24 +1689,15 @@ void EntityComponentManager::SetChanged(
   if (typeIter == ecIter->second.end())
     return;
 
-  ComponentKey key{_type, typeIter->second};
+  this->dataPtr->components.at(_type)->SetChangeState(typeIter->second, _c);
 
-  if (_c == ComponentState::PeriodicChange)
-  {
-    this->dataPtr->periodicChangedComponents.insert(key);
-    this->dataPtr->oneTimeChangedComponents.erase(key);
-  }
-  else if (_c == ComponentState::OneTimeChange)
-  {
-    this->dataPtr->periodicChangedComponents.erase(key);
-    this->dataPtr->oneTimeChangedComponents.insert(key);
-  }
-  else
+  if (_c != ComponentState::NoChange)
   {
-    this->dataPtr->periodicChangedComponents.erase(key);
-    this->dataPtr->oneTimeChangedComponents.erase(key);
+    this->InvalidateWorldPoses(_type);
+    this->dataPtr->MarkIndexDirty(_entity, _type);
   }
 
+  std::lock_guard<std::mutex> lock(this->dataPtr->changedComponentsMutex);
   this->dataPtr->AddModifiedComponent(_entity);
 }
 
@@ -1571,6 +1748,107 @@ void EntityComponentManagerPrivate::AddModifiedComponent(const Entity &_entity)
   this->modifiedComponents.insert(_entity);
 }
 
+/////////////////////////////////////////////////
+void EntityComponentManagerPrivate::InvalidateViews(
+    const ComponentTypeId _typeId)
+{
+  for (auto &view : this->views)
+  {
+    if (view.first.find(_typeId) != view.first.end())
+      view.second.InvalidateComponents();
+  }
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManagerPrivate::MarkIndexDirty(const Entity _entity,
+    const ComponentTypeId _typeId)
+{
+  if (this->componentIndexes.empty())
+    return;
+
+  auto indexIter = this->componentIndexes.find(_typeId);
+  if (indexIter == this->componentIndexes.end())
+    return;
+
+  std::lock_guard<std::mutex> lock(this->componentIndexesMutex);
+  indexIter->second.dirty.insert(_entity);
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::MarkIndexDirty(const Entity _entity,
+    const ComponentTypeId _typeId)
+{
+  this->dataPtr->MarkIndexDirty(_entity, _typeId);
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::EnableComponentIndex(
+    const ComponentTypeId _typeId,
+    std::function<std::size_t(const components::BaseComponent *)> _hash)
+{
+  if (this->dataPtr->componentIndexes.find(_typeId) !=
+      this->dataPtr->componentIndexes.end())
+  {
+    return;
+  }
+
+  auto &index = this->dataPtr->componentIndexes[_typeId];
+  index.hash = std::move(_hash);
+
+  // Existing components are indexed by the first query
+  for (const auto &entityComponents : this->dataPtr->entityComponents)
+  {
+    if (entityComponents.second.find(_typeId) !=
+        entityComponents.second.end())
+    {
+      index.dirty.insert(entityComponents.first);
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+std::optional<std::vector<Entity>> EntityComponentManager::IndexedEntities(
+    const ComponentTypeId _typeId, const std::size_t _hash) const
+{
+  auto indexIter = this->dataPtr->componentIndexes.find(_typeId);
+  if (indexIter == this->dataPtr->componentIndexes.end())
+    return std::nullopt;
+
+  IGN_PROFILE("EntityComponentManager::IndexedEntities");
+  std::lock_guard<std::mutex> lock(this->dataPtr->componentIndexesMutex);
+  auto &index = indexIter->second;
+
+  // Bring the index up to date with components which may have changed
+  for (const Entity entity : index.dirty)
+  {
+    auto hashIter = index.hashes.find(entity);
+    if (hashIter != index.hashes.end())
+    {
+      auto bucketIter = index.entities.find(hashIter->second);
+      bucketIter->second.erase(entity);
+      if (bucketIter->second.empty())
+        index.entities.erase(bucketIter);
+      index.hashes.erase(hashIter);
+    }
+
+    auto comp = this->ComponentImplementation(entity, _typeId);
+    if (nullptr == comp)
+      continue;
+
+    const std::size_t hash = index.hash(comp);
+    index.entities[hash].insert(entity);
+    index.hashes[entity] = hash;
+  }
+  index.dirty.clear();
+
+  std::vector<Entity> result;
+  auto bucketIter = index.entities.find(_hash);
+  if (bucketIter != index.entities.end())
+    result.assign(bucketIter->second.begin(), bucketIter->second.end());
+
+  return result;
+}
+
 /////////////////////////////////////////////////
 void EntityComponentManager::PinEntity(const Entity _entity, bool _recursive)
 {
@@ -1604,3 +1882,28 @@ void EntityComponentManager::UnpinAllEntities()
 {
   this->dataPtr->pinnedEntities.clear();
 }
+
+/////////////////////////////////////////////////
+void EntityComponentManager::ParallelFor(const size_t _count,
+    const std::function<void(size_t, size_t)> &_f) const
+{
+  IGN_PROFILE("EntityComponentManager::ParallelFor");
+
+  auto pool = this->dataPtr->Pool();
+
+  // Spawning tasks isn't worth it for a handful of entities.
+  pool->ParallelFor(_count, _f, 64);
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::SetThreadPool(std::shared_ptr<ThreadPool> _pool)
+{
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->threadPoolMutex);
+    this->dataPtr->threadPool = std::move(_pool);
+  }
+
+  // The state chunks depend on the number of threads
+  std::lock_guard<std::mutex> lock(this->dataPtr->stateChunksMutex);
+  this->dataPtr->entityComponentsDirty = true;
+}
@@ -17,12 +17,19 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
 #include <ignition/common/Console.hh>
 #include <ignition/common/Util.hh>
 #include <ignition/math/Pose3.hh>
 #include <ignition/math/Rand.hh>
 
 #include "ignition/gazebo/components/Factory.hh"
+#include "ignition/gazebo/components/ParentEntity.hh"
 #include "ignition/gazebo/components/Pose.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
 #include "ignition/gazebo/config.hh"
@@ -1182,6 +1189,133 @@ int eachCount(EntityCompMgrTest &_manager)
   return count;
 }
 
+//////////////////////////////////////////////////
+// Entities and components can be created and removed while iterating a view
+TEST_P(EntityComponentManagerFixture, EachWithModifications)
+{
+  std::vector<Entity> entities;
+  for (int i = 0; i < 10; ++i)
+  {
+    entities.push_back(manager.CreateEntity());
+    manager.CreateComponent<IntComponent>(entities.back(), IntComponent(i));
+    manager.CreateComponent<DoubleComponent>(entities.back(),
+        DoubleComponent(i * 0.5));
+  }
+
+  std::vector<Entity> created;
+  std::vector<Entity> visited;
+  manager.Each<IntComponent, DoubleComponent>(
+      [&](const Entity &_entity, IntComponent *_int,
+          DoubleComponent *_double)->bool
+      {
+        visited.push_back(_entity);
+        EXPECT_DOUBLE_EQ(_int->Data() * 0.5, _double->Data());
+
+        if (_entity == entities[0])
+        {
+          // Remove a component from an entity which hasn't been visited yet
+          EXPECT_TRUE(manager.RemoveComponent<IntComponent>(entities[5]));
+
+          // Create enough components to expand the storages
+          for (int i = 10; i < 300; ++i)
+          {
+            created.push_back(manager.CreateEntity());
+            manager.CreateComponent<IntComponent>(created.back(),
+                IntComponent(i));
+            manager.CreateComponent<DoubleComponent>(created.back(),
+                DoubleComponent(i * 0.5));
+          }
+        }
+        return true;
+      });
+
+  // The entity without an IntComponent was skipped, and new entities were
+  // visited
+  EXPECT_EQ(9u + created.size(), visited.size());
+  EXPECT_EQ(visited.end(),
+      std::find(visited.begin(), visited.end(), entities[5]));
+  EXPECT_NE(visited.end(),
+      std::find(visited.begin(), visited.end(), created.back()));
+
+  // The view is sorted once the iteration is over
+  visited.clear();
+  manager.Each<IntComponent, DoubleComponent>(
+      [&](const Entity &_entity, const IntComponent *_int,
+          const DoubleComponent *_double)->bool
+      {
+        visited.push_back(_entity);
+        EXPECT_DOUBLE_EQ(_int->Data() * 0.5, _double->Data());
+        return true;
+      });
+  EXPECT_EQ(9u + created.size(), visited.size());
+  EXPECT_TRUE(std::is_sorted(visited.begin(), visited.end()));
+
+  // Removing entities moves components in their storages
+  manager.RequestRemoveEntity(entities[1]);
+  manager.RequestRemoveEntity(created[10]);
+  manager.ProcessEntityRemovals();
+
+  int count{0};
+  manager.Each<IntComponent, DoubleComponent>(
+      [&](const Entity &, const IntComponent *_int,
+          const DoubleComponent *_double)->bool
+      {
+        ++count;
+        EXPECT_DOUBLE_EQ(_int->Data() * 0.5, _double->Data());
+        return true;
+      });
+  EXPECT_EQ(7 + static_cast<int>(created.size()), count);
+}
+
+//////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, EachParallel)
+{
+  const int count{5000};
+  for (int i = 0; i < count; ++i)
+  {
+    Entity entity = manager.CreateEntity();
+    manager.CreateComponent<IntComponent>(entity, IntComponent(i));
+    manager.CreateComponent<DoubleComponent>(entity, DoubleComponent(0.0));
+  }
+
+  // Entities which don't match aren't visited
+  Entity other = manager.CreateEntity();
+  manager.CreateComponent<IntComponent>(other, IntComponent(-1));
+
+  std::atomic<int> visited{0};
+  manager.EachParallel<IntComponent, DoubleComponent>(
+      [&](const Entity &, IntComponent *_int, DoubleComponent *_double)
+      {
+        ++visited;
+        _double->Data() = _int->Data() * 0.5;
+      });
+  EXPECT_EQ(count, visited);
+
+  // All components were written exactly once
+  visited = 0;
+  const auto &constManager = manager;
+  constManager.EachParallel<IntComponent, DoubleComponent>(
+      [&](const Entity &, const IntComponent *_int,
+          const DoubleComponent *_double)
+      {
+        ++visited;
+        EXPECT_DOUBLE_EQ(_int->Data() * 0.5, _double->Data());
+      });
+  EXPECT_EQ(count, visited);
+
+  // Removed entities are skipped
+  manager.RequestRemoveEntity(manager.EntityByComponents(IntComponent(10)));
+  manager.ProcessEntityRemovals();
+
+  visited = 0;
+  manager.EachParallel<IntComponent, DoubleComponent>(
+      [&](const Entity &, const IntComponent *, const DoubleComponent *)
+      {
+        ++visited;
+      });
+  EXPECT_EQ(count - 1, visited);
+}
+
 //////////////////////////////////////////////////
 TEST_P(EntityComponentManagerFixture, EachNewBasic)
 {
@@ -1491,6 +1625,121 @@ TEST_P(EntityComponentManagerFixture, EntityByComponents)
   EXPECT_EQ(1u, entities.size());
 }
 
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, IndexedEntityByComponents)
+{
+  // Components created before the index is enabled are indexed too
+  Entity e1 = manager.CreateEntity();
+  manager.CreateComponent(e1, StringComponent("one"));
+  manager.CreateComponent(e1, IntComponent(1));
+
+  manager.EnableComponentIndex<StringComponent>();
+  manager.EnableComponentIndex<IntComponent>();
+
+  Entity e2 = manager.CreateEntity();
+  manager.CreateComponent(e2, StringComponent("two"));
+  manager.CreateComponent(e2, IntComponent(1));
+  manager.CreateComponent(e2, Even());
+
+  Entity e3 = manager.CreateEntity();
+  manager.CreateComponent(e3, StringComponent("three"));
+
+  EXPECT_EQ(e1, manager.EntityByComponents(StringComponent("one")));
+  EXPECT_EQ(e2, manager.EntityByComponents(StringComponent("two")));
+  EXPECT_EQ(e2, manager.EntityByComponents(StringComponent("two"),
+      IntComponent(1), Even()));
+  EXPECT_EQ(e2, manager.EntityByComponents(Even(), IntComponent(1)));
+  EXPECT_EQ(kNullEntity, manager.EntityByComponents(StringComponent("three"),
+      IntComponent(1)));
+  EXPECT_EQ(kNullEntity, manager.EntityByComponents(StringComponent("four")));
+  EXPECT_EQ((std::vector<Entity>{e1, e2}),
+      manager.EntitiesByComponents(IntComponent(1)));
+
+  // Set data
+  EXPECT_TRUE(manager.SetComponentData<StringComponent>(e3, "four"));
+  EXPECT_EQ(kNullEntity, manager.EntityByComponents(StringComponent("three")));
+  EXPECT_EQ(e3, manager.EntityByComponents(StringComponent("four")));
+
+  // Modify through a component pointer and flag the change
+  manager.Component<IntComponent>(e1)->Data() = 2;
+  manager.SetChanged(e1, IntComponent::typeId,
+      ComponentState::OneTimeChange);
+  EXPECT_EQ(e1, manager.EntityByComponents(IntComponent(2)));
+  EXPECT_EQ((std::vector<Entity>{e2}),
+      manager.EntitiesByComponents(IntComponent(1)));
+
+  // Modify through the cached view of Each and flag the changes
+  manager.Each<IntComponent>(
+      [&](const Entity &_entity, IntComponent *_int) -> bool
+      {
+        _int->Data() = 3;
+        manager.SetChanged(_entity, IntComponent::typeId,
+            ComponentState::OneTimeChange);
+        return true;
+      });
+  EXPECT_TRUE(manager.EntitiesByComponents(IntComponent(1)).empty());
+  EXPECT_EQ((std::vector<Entity>{e1, e2}),
+      manager.EntitiesByComponents(IntComponent(3)));
+
+  // Modify through EachNew and EachParallel
+  manager.EachNew<StringComponent>(
+      [&](const Entity &_entity, StringComponent *_str) -> bool
+      {
+        if (_entity == e3)
+        {
+          _str->Data() = "five";
+          manager.SetChanged(_entity, StringComponent::typeId,
+              ComponentState::OneTimeChange);
+        }
+        return true;
+      });
+  EXPECT_EQ(e3, manager.EntityByComponents(StringComponent("five")));
+
+  manager.EachParallel<StringComponent>(
+      [&](const Entity &_entity, StringComponent *_str)
+      {
+        if (_entity == e3)
+        {
+          _str->Data() = "six";
+          manager.SetChanged(_entity, StringComponent::typeId,
+              ComponentState::OneTimeChange);
+        }
+      });
+  EXPECT_EQ(kNullEntity, manager.EntityByComponents(StringComponent("five")));
+  EXPECT_EQ(e3, manager.EntityByComponents(StringComponent("six")));
+
+  // Reading through the const Each doesn't invalidate the index
+  const auto &constManager = manager;
+  constManager.Each<IntComponent>(
+      [&](const Entity &, const IntComponent *) -> bool
+      {
+        return true;
+      });
+  EXPECT_EQ((std::vector<Entity>{e1, e2}),
+      manager.EntitiesByComponents(IntComponent(3)));
+
+  // Remove component
+  EXPECT_TRUE(manager.RemoveComponent<IntComponent>(e2));
+  EXPECT_EQ((std::vector<Entity>{e1}),
+      manager.EntitiesByComponents(IntComponent(3)));
+
+  // Remove entity
+  manager.RequestRemoveEntity(e1);
+  manager.ProcessEntityRemovals();
+  EXPECT_TRUE(manager.EntitiesByComponents(IntComponent(3)).empty());
+  EXPECT_EQ(kNullEntity, manager.EntityByComponents(StringComponent("one")));
+  EXPECT_EQ(e2, manager.EntityByComponents(StringComponent("two")));
+
+  // Remove all entities
+  manager.RequestRemoveEntities();
+  manager.ProcessEntityRemovals();
+  EXPECT_EQ(kNullEntity, manager.EntityByComponents(StringComponent("two")));
+
+  Entity e4 = manager.CreateEntity();
+  manager.CreateComponent(e4, StringComponent("two"));
+  EXPECT_EQ(e4, manager.EntityByComponents(StringComponent("two")));
+}
+
 /////////////////////////////////////////////////
 TEST_P(EntityComponentManagerFixture, EntityGraph)
 {
@@ -1966,6 +2215,64 @@ TEST_P(EntityComponentManagerFixture, ChangedStateComponents)
   EXPECT_EQ(1, changedStateMsg.entities_size());
 }
 
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, SetStateInPlace)
+{
+  Entity e1 = manager.CreateEntity();
+  manager.CreateComponent<IntComponent>(e1, IntComponent(1));
+  manager.CreateComponent<StringComponent>(e1, StringComponent("one"));
+  manager.RunClearNewlyCreatedEntities();
+  manager.RunSetAllComponentsUnchanged();
+
+  auto intComp = manager.Component<IntComponent>(e1);
+  auto stringComp = manager.Component<StringComponent>(e1);
+  ASSERT_NE(nullptr, intComp);
+  ASSERT_NE(nullptr, stringComp);
+
+  // Vector message
+  {
+    auto stateMsg = manager.State();
+    ASSERT_EQ(1, stateMsg.entities_size());
+    ASSERT_EQ(2, stateMsg.entities(0).components_size());
+    for (auto &compMsg : *stateMsg.mutable_entities(0)->mutable_components())
+    {
+      if (compMsg.type() == IntComponent::typeId)
+        compMsg.set_component("2");
+    }
+
+    manager.SetState(stateMsg);
+
+    // Existing components are updated instead of replaced
+    EXPECT_EQ(intComp, manager.Component<IntComponent>(e1));
+    EXPECT_EQ(stringComp, manager.Component<StringComponent>(e1));
+    EXPECT_EQ(2, intComp->Data());
+    EXPECT_EQ("one", stringComp->Data());
+    EXPECT_EQ(ComponentState::OneTimeChange,
+        manager.ComponentState(e1, IntComponent::typeId));
+  }
+
+  manager.RunSetAllComponentsUnchanged();
+
+  // Map message
+  {
+    msgs::SerializedStateMap stateMsg;
+    manager.State(stateMsg);
+    ASSERT_EQ(1, stateMsg.entities_size());
+    auto &entityMsg = stateMsg.mutable_entities()->begin()->second;
+    (*entityMsg.mutable_components())[StringComponent::typeId]
+        .set_component("two");
+
+    manager.SetState(stateMsg);
+
+    EXPECT_EQ(intComp, manager.Component<IntComponent>(e1));
+    EXPECT_EQ(stringComp, manager.Component<StringComponent>(e1));
+    EXPECT_EQ(2, intComp->Data());
+    EXPECT_EQ("two", stringComp->Data());
+    EXPECT_EQ(ComponentState::PeriodicChange,
+        manager.ComponentState(e1, StringComponent::typeId));
+  }
+}
+
 /////////////////////////////////////////////////
 TEST_P(EntityComponentManagerFixture, Descendants)
 {
@@ -2437,6 +2744,50 @@ TEST_P(EntityComponentManagerFixture, SerializedStateMapMsgCompsRemovedOnly)
   }
 }
 
+//////////////////////////////////////////////////
+// Large maps are serialized in chunks, check they're merged correctly
+TEST_P(EntityComponentManagerFixture, SerializedStateMapManyEntities)
+{
+  std::vector<Entity> entities;
+  for (int i = 0; i < 2000; ++i)
+  {
+    entities.push_back(manager.CreateEntity());
+    manager.CreateComponent<IntComponent>(entities.back(), IntComponent(i));
+    manager.CreateComponent<StringComponent>(entities.back(),
+        StringComponent(std::to_string(i)));
+  }
+
+  msgs::SerializedStateMap stateMsg;
+  manager.State(stateMsg, {}, {}, true);
+  ASSERT_EQ(2000, stateMsg.entities_size());
+
+  EntityComponentManager otherManager;
+  otherManager.SetState(stateMsg);
+  for (int i = 0; i < 2000; ++i)
+  {
+    auto intComp = otherManager.Component<IntComponent>(entities[i]);
+    ASSERT_NE(nullptr, intComp);
+    EXPECT_EQ(i, intComp->Data());
+
+    auto stringComp = otherManager.Component<StringComponent>(entities[i]);
+    ASSERT_NE(nullptr, stringComp);
+    EXPECT_EQ(std::to_string(i), stringComp->Data());
+  }
+
+  // Filter by entity and type
+  std::unordered_set<Entity> entitySet{entities[3], entities[1500]};
+  std::unordered_set<ComponentTypeId> types{IntComponent::typeId};
+  msgs::SerializedStateMap filteredMsg;
+  manager.State(filteredMsg, entitySet, types, true);
+  ASSERT_EQ(2, filteredMsg.entities_size());
+  for (const auto &entity : entitySet)
+  {
+    auto iter = filteredMsg.entities().find(entity);
+    ASSERT_NE(filteredMsg.entities().end(), iter);
+    EXPECT_EQ(1, iter->second.components().size());
+  }
+}
+
 //////////////////////////////////////////////////
 // Verify that removed components are correctly filtered when creating a
 // SerializedStateMap message
@@ -2632,6 +2983,70 @@ TEST_P(EntityComponentManagerFixture, PinnedEntity)
   EXPECT_EQ(0u, manager.EntityCount());
 }
 
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, WorldPose)
+{
+  // - 1
+  //   - 2
+  //     - 3
+  //   - 4 (no pose)
+  //     - 5
+  auto e1 = manager.CreateEntity();
+  auto e2 = manager.CreateEntity();
+  auto e3 = manager.CreateEntity();
+  auto e4 = manager.CreateEntity();
+  auto e5 = manager.CreateEntity();
+
+  manager.CreateComponent(e1, components::Pose(math::Pose3d(1, 0, 0, 0, 0,
+      IGN_PI_2)));
+  manager.CreateComponent(e2, components::Pose(math::Pose3d(1, 0, 0, 0, 0,
+      0)));
+  manager.CreateComponent(e2, components::ParentEntity(e1));
+  manager.CreateComponent(e3, components::Pose(math::Pose3d(0, 0, 1, 0, 0,
+      0)));
+  manager.CreateComponent(e3, components::ParentEntity(e2));
+  manager.CreateComponent(e4, components::ParentEntity(e1));
+  manager.CreateComponent(e5, components::Pose(math::Pose3d(0, 2, 0, 0, 0,
+      0)));
+  manager.CreateComponent(e5, components::ParentEntity(e4));
+
+  EXPECT_EQ(math::Pose3d(1, 0, 0, 0, 0, IGN_PI_2), *manager.WorldPose(e1));
+  EXPECT_EQ(math::Pose3d(1, 1, 0, 0, 0, IGN_PI_2), *manager.WorldPose(e2));
+  EXPECT_EQ(math::Pose3d(1, 1, 1, 0, 0, IGN_PI_2), *manager.WorldPose(e3));
+  EXPECT_FALSE(manager.WorldPose(e4).has_value());
+  EXPECT_FALSE(manager.WorldPose(kNullEntity).has_value());
+
+  // The chain stops at the first ancestor without a pose
+  EXPECT_EQ(math::Pose3d(0, 2, 0, 0, 0, 0), *manager.WorldPose(e5));
+
+  // Poses modified through a pointer are picked up once marked as changed
+  *manager.Component<components::Pose>(e1) =
+      components::Pose(math::Pose3d(0, 0, 1, 0, 0, 0));
+  manager.SetChanged(e1, components::Pose::typeId,
+      ComponentState::PeriodicChange);
+  EXPECT_EQ(math::Pose3d(1, 0, 2, 0, 0, 0), *manager.WorldPose(e3));
+
+  // Set data
+  EXPECT_TRUE(manager.SetComponentData<components::Pose>(e2,
+      math::Pose3d(0, 3, 0, 0, 0, 0)));
+  EXPECT_EQ(math::Pose3d(0, 3, 2, 0, 0, 0), *manager.WorldPose(e3));
+
+  // Reparent
+  EXPECT_TRUE(manager.SetComponentData<components::ParentEntity>(e3, e5));
+  EXPECT_EQ(math::Pose3d(0, 2, 1, 0, 0, 0), *manager.WorldPose(e3));
+
+  // Remove components
+  EXPECT_TRUE(manager.RemoveComponent<components::ParentEntity>(e3));
+  EXPECT_EQ(math::Pose3d(0, 0, 1, 0, 0, 0), *manager.WorldPose(e3));
+  EXPECT_TRUE(manager.RemoveComponent<components::Pose>(e3));
+  EXPECT_FALSE(manager.WorldPose(e3).has_value());
+
+  // Remove entity
+  manager.RequestRemoveEntity(e1, false);
+  manager.ProcessEntityRemovals();
+  EXPECT_EQ(math::Pose3d(0, 3, 0, 0, 0, 0), *manager.WorldPose(e2));
+}
+
 // Run multiple times. We want to make sure that static globals don't cause
 // problems.
 INSTANTIATE_TEST_SUITE_P(EntityComponentManagerRepeat,
@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "InternedSdf.hh"
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <ignition/msgs/geometry.pb.h>
+#include <ignition/msgs/material.pb.h>
+#include <ignition/msgs/sensor.pb.h>
+
+#include <sdf/Element.hh>
+
+#include "ignition/gazebo/Conversions.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+namespace
+{
+/// \brief Instances of one SDF type, keyed by their content.
+template <typename T>
+class InternPool
+{
+  /// \brief Get a copy of the instance for a key, adding _sdf to the pool if
+  /// there's no instance yet.
+  /// \param[in] _sdf Description.
+  /// \param[in] _key Key identifying the content of _sdf.
+  /// \return Copy of the pooled instance, which shares its element.
+  public: T Intern(const T &_sdf, std::string &&_key)
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    auto inserted = this->instances.try_emplace(std::move(_key), _sdf);
+    if (!inserted.second)
+      return inserted.first->second;
+
+    // Drop the instances which aren't used anymore, as rarely as needed to
+    // keep the pool from growing without bounds
+    if (this->instances.size() >= this->pruneSize)
+    {
+      const auto references = this->PoolReferences();
+      for (auto it = this->instances.begin(); it != this->instances.end();)
+      {
+        if (it != inserted.first && !InUse(it->second, references))
+          it = this->instances.erase(it);
+        else
+          ++it;
+      }
+      this->pruneSize = std::max<std::size_t>(64, this->instances.size() * 2);
+    }
+    return _sdf;
+  }
+
+  /// \brief Get the number of instances still in use.
+  /// \return Number of instances.
+  public: std::size_t Count()
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    const auto references = this->PoolReferences();
+    return std::count_if(this->instances.begin(), this->instances.end(),
+        [&](const auto &_entry) {return InUse(_entry.second, references);});
+  }
+
+  /// \brief Count the pooled instances holding each element. Descriptions
+  /// changed after loading keep the element they were loaded from, so
+  /// several instances may hold the same one.
+  /// \return Number of instances, keyed by element.
+  private: std::unordered_map<const sdf::Element *, long> PoolReferences()
+      const
+  {
+    std::unordered_map<const sdf::Element *, long> references;
+    for (const auto &entry : this->instances)
+      ++references[entry.second.Element().get()];
+    return references;
+  }
+
+  /// \brief Check whether the element of a pooled instance is referenced
+  /// outside of the pool, by copies of the instance or by the tree it was
+  /// loaded in.
+  /// \param[in] _sdf Pooled instance.
+  /// \param[in] _references Number of pooled instances holding each element.
+  /// \return True if it's still in use.
+  private: static bool InUse(const T &_sdf,
+      const std::unordered_map<const sdf::Element *, long> &_references)
+  {
+    // The copy of the pointer here holds one more reference
+    auto elem = _sdf.Element();
+    return elem.use_count() - 1 > _references.at(elem.get());
+  }
+
+  /// \brief Protects the instances.
+  private: std::mutex mutex;
+
+  /// \brief Instances, keyed by content.
+  private: std::unordered_map<std::string, T> instances;
+
+  /// \brief Number of entries at which unused ones are dropped.
+  private: std::size_t pruneSize{64};
+};
+
+/// \brief Get the pool of a type.
+/// \return Pool.
+template <typename T>
+InternPool<T> &Pool()
+{
+  static InternPool<T> pool;
+  return pool;
+}
+
+/// \brief Intern an SDF description.
+/// \param[in] _sdf Description.
+/// \tparam T SDF type.
+/// \tparam MsgT Message type it converts to.
+/// \return Copy sharing the element of identical descriptions.
+template <typename T, typename MsgT>
+T Intern(const T &_sdf)
+{
+  // The element holds everything that was loaded, including what the
+  // message doesn't convey, such as the path used to resolve relative URIs.
+  // The message catches changes made after loading, which aren't reflected
+  // in the element.
+  auto elem = _sdf.Element();
+  if (!elem)
+    return _sdf;
+
+  std::string key = convert<MsgT>(_sdf).SerializeAsString();
+  key += '\0';
+  key += elem->FilePath();
+  key += '\0';
+  key += elem->ToString("");
+  return Pool<T>().Intern(_sdf, std::move(key));
+}
+}
+
+//////////////////////////////////////////////////
+sdf::Geometry ignition::gazebo::InternSdf(const sdf::Geometry &_geometry)
+{
+  return Intern<sdf::Geometry, msgs::Geometry>(_geometry);
+}
+
+//////////////////////////////////////////////////
+sdf::Material ignition::gazebo::InternSdf(const sdf::Material &_material)
+{
+  return Intern<sdf::Material, msgs::Material>(_material);
+}
+
+//////////////////////////////////////////////////
+sdf::Sensor ignition::gazebo::InternSdf(const sdf::Sensor &_sensor)
+{
+  return Intern<sdf::Sensor, msgs::Sensor>(_sensor);
+}
+
+//////////////////////////////////////////////////
+std::size_t ignition::gazebo::InternedSdfCount()
+{
+  return Pool<sdf::Geometry>().Count() + Pool<sdf::Material>().Count() +
+      Pool<sdf::Sensor>().Count();
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_INTERNEDSDF_HH_
+#define IGNITION_GAZEBO_INTERNEDSDF_HH_
+
+#include <cstddef>
+
+#include <sdf/Geometry.hh>
+#include <sdf/Material.hh>
+#include <sdf/Sensor.hh>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \brief Get a copy of an SDF geometry which shares its SDF element with
+    /// the copies of identical geometries. Geometries loaded from identical
+    /// SDF get copies of a single pooled instance, so entities spawned from
+    /// the same model keep one element tree alive instead of one per entity,
+    /// while their components still hold the geometry by value.
+    /// Geometries which weren't loaded from SDF are returned as they are.
+    /// \param[in] _geometry Geometry.
+    /// \return Geometry equal to _geometry.
+    IGNITION_GAZEBO_VISIBLE
+    sdf::Geometry InternSdf(const sdf::Geometry &_geometry);
+
+    /// \brief Get a copy of an SDF material which shares its SDF element with
+    /// the copies of identical materials.
+    /// \param[in] _material Material.
+    /// \return Material equal to _material.
+    /// \sa InternSdf(const sdf::Geometry &)
+    IGNITION_GAZEBO_VISIBLE
+    sdf::Material InternSdf(const sdf::Material &_material);
+
+    /// \brief Get a copy of an SDF sensor which shares its SDF element with
+    /// the copies of identical sensors.
+    /// \param[in] _sensor Sensor.
+    /// \return Sensor equal to _sensor.
+    /// \sa InternSdf(const sdf::Geometry &)
+    IGNITION_GAZEBO_VISIBLE
+    sdf::Sensor InternSdf(const sdf::Sensor &_sensor);
+
+    /// \brief Get the number of pooled instances whose SDF element is still
+    /// referenced outside of the pool, such as by components.
+    /// \return Number of geometries, materials and sensors.
+    IGNITION_GAZEBO_VISIBLE
+    std::size_t InternedSdfCount();
+    }
+  }
+}
+#endif
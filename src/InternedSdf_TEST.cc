@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <sdf/Link.hh>
+#include <sdf/Mesh.hh>
+#include <sdf/Model.hh>
+#include <sdf/Root.hh>
+#include <sdf/Visual.hh>
+
+#include "ignition/gazebo/components/Geometry.hh"
+#include "InternedSdf.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief SDF with models which are identical except for their names and
+/// the mesh URI of the last one.
+/// \return SDF string.
+std::string modelsSdf()
+{
+  std::string sdf = "<?xml version='1.0'?><sdf version='1.6'>"
+      "<world name='default'>";
+  for (int i = 0; i < 3; ++i)
+  {
+    sdf += "<model name='model_" + std::to_string(i) + "'>"
+        "<link name='link'>"
+        "<visual name='visual'>"
+        "<geometry><mesh><uri>" + std::string(i < 2 ? "a.dae" : "b.dae") +
+        "</uri></mesh></geometry>"
+        "<material><diffuse>1 0 0 1</diffuse></material>"
+        "</visual>"
+        "<sensor name='imu' type='imu'><imu/></sensor>"
+        "</link>"
+        "</model>";
+  }
+  sdf += "</world></sdf>";
+  return sdf;
+}
+
+/////////////////////////////////////////////////
+TEST(InternedSdf, Share)
+{
+  {
+    sdf::Root root;
+    ASSERT_TRUE(root.LoadSdfString(modelsSdf()).empty());
+    auto world = root.WorldByIndex(0);
+    ASSERT_NE(nullptr, world);
+    ASSERT_EQ(3u, world->ModelCount());
+
+    auto visual = [&](uint64_t _model)
+    {
+      return world->ModelByIndex(_model)->LinkByIndex(0)->VisualByIndex(0);
+    };
+    auto sensor = [&](uint64_t _model)
+    {
+      return world->ModelByIndex(_model)->LinkByIndex(0)->SensorByIndex(0);
+    };
+
+    // Each model was loaded into its own elements
+    ASSERT_NE(visual(0)->Geom()->Element(), visual(1)->Geom()->Element());
+
+    // Identical descriptions share the element of the first one
+    auto geom0 = InternSdf(*visual(0)->Geom());
+    auto geom1 = InternSdf(*visual(1)->Geom());
+    auto geom2 = InternSdf(*visual(2)->Geom());
+    EXPECT_EQ(visual(0)->Geom()->Element(), geom0.Element());
+    EXPECT_EQ(geom0.Element(), geom1.Element());
+    EXPECT_NE(geom0.Element(), geom2.Element());
+    EXPECT_EQ("a.dae", geom1.MeshShape()->Uri());
+    EXPECT_EQ("b.dae", geom2.MeshShape()->Uri());
+
+    auto mat0 = InternSdf(*visual(0)->Material());
+    auto mat2 = InternSdf(*visual(2)->Material());
+    EXPECT_EQ(mat0.Element(), mat2.Element());
+
+    auto sensor0 = InternSdf(*sensor(0));
+    auto sensor1 = InternSdf(*sensor(1));
+    EXPECT_EQ(sensor0.Element(), sensor1.Element());
+    EXPECT_EQ("imu", sensor1.Name());
+
+    EXPECT_EQ(4u, InternedSdfCount());
+
+    // Changes made after loading aren't shared with the original
+    sdf::Geometry changed = *visual(0)->Geom();
+    sdf::Mesh mesh = *changed.MeshShape();
+    mesh.SetUri("c.dae");
+    changed.SetMeshShape(mesh);
+    auto geomChanged = InternSdf(changed);
+    EXPECT_EQ("c.dae", geomChanged.MeshShape()->Uri());
+    EXPECT_EQ("a.dae", InternSdf(*visual(1)->Geom()).MeshShape()->Uri());
+    EXPECT_EQ(5u, InternedSdfCount());
+
+    // Descriptions which weren't loaded from SDF are returned as they are
+    sdf::Geometry box;
+    box.SetType(sdf::GeometryType::BOX);
+    EXPECT_EQ(sdf::GeometryType::BOX, InternSdf(box).Type());
+    EXPECT_EQ(nullptr, InternSdf(box).Element());
+    EXPECT_EQ(5u, InternedSdfCount());
+  }
+
+  // Once the descriptions and their copies are gone, nothing is in use
+  EXPECT_EQ(0u, InternedSdfCount());
+}
+
+/////////////////////////////////////////////////
+TEST(InternedSdf, ComponentsHoldCopies)
+{
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(modelsSdf()).empty());
+  auto world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  const auto &geom = *world->ModelByIndex(0)->LinkByIndex(0)->VisualByIndex(
+      0)->Geom();
+
+  components::Geometry comp(InternSdf(geom));
+  EXPECT_EQ(geom.Element(), comp.Data().Element());
+
+  // Modifying a component doesn't change what's interned
+  sdf::Mesh mesh = *comp.Data().MeshShape();
+  mesh.SetUri("c.dae");
+  comp.Data().SetMeshShape(mesh);
+  EXPECT_EQ("c.dae", comp.Data().MeshShape()->Uri());
+  EXPECT_EQ("a.dae", InternSdf(geom).MeshShape()->Uri());
+
+  // Neither does setting new data
+  components::Geometry setComp(InternSdf(geom));
+  sdf::Geometry box;
+  box.SetType(sdf::GeometryType::BOX);
+  setComp.SetData(box, [](const sdf::Geometry &, const sdf::Geometry &)
+      {
+        return false;
+      });
+  EXPECT_EQ(sdf::GeometryType::BOX, setComp.Data().Type());
+  EXPECT_EQ("a.dae", InternSdf(geom).MeshShape()->Uri());
+}
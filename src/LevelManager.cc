@@ -18,6 +18,7 @@
 #include "LevelManager.hh"
 
 #include <algorithm>
+#include <cmath>
 
 #include <sdf/Actor.hh>
 #include <sdf/Atmosphere.hh>
@@ -60,6 +61,24 @@
 using namespace ignition;
 using namespace gazebo;
 
+namespace
+{
+/// \brief Key of a cell in the level grid. Indices are truncated to 21 bits,
+/// the rare collisions this causes only add candidates which fail the exact
+/// intersection test.
+/// \param[in] _x Cell index along X.
+/// \param[in] _y Cell index along Y.
+/// \param[in] _z Cell index along Z.
+/// \return Cell key.
+uint64_t CellKey(int64_t _x, int64_t _y, int64_t _z)
+{
+  const uint64_t mask = (1u << 21) - 1;
+  return ((static_cast<uint64_t>(_x) & mask) << 42) |
+         ((static_cast<uint64_t>(_y) & mask) << 21) |
+         (static_cast<uint64_t>(_z) & mask);
+}
+}
+
 /////////////////////////////////////////////////
 LevelManager::LevelManager(SimulationRunner *_runner, const bool _useLevels)
     : runner(_runner), useLevels(_useLevels)
@@ -420,6 +439,8 @@ void LevelManager::ReadLevels(const sdf::ElementPtr &_sdf)
 
     this->entityCreator->SetParent(levelEntity, this->worldEntity);
   }
+
+  this->levelIndexDirty = true;
 }
 
 /////////////////////////////////////////////////
@@ -586,6 +607,10 @@ void LevelManager::UpdateLevelsState()
   // If levels are not being used, we only process the default level.
   if (this->useLevels)
   {
+    if (this->levelIndexDirty)
+      this->BuildLevelIndex();
+
+    bool checkedPerformer{false};
     this->runner->entityCompMgr.Each<
       components::Performer,
       components::PerformerLevels,
@@ -617,64 +642,45 @@ void LevelManager::UpdateLevelsState()
 
           std::set<Entity> newPerfLevels;
 
-          // loop through levels and check for intersections
+          // Check intersections against the levels close to the performer.
           // Add all levels with intersections to the levelsToLoad even if they
           // are currently active.
-          this->runner->entityCompMgr.Each<components::Level, components::Pose,
-            components::Geometry,
-            components::LevelBuffer >(
-                [&](const Entity &_entity, const components::Level *,
-                  const components::Pose *_pose,
-                  const components::Geometry *_levelGeometry,
-                  const components::LevelBuffer *_levelBuffer) -> bool
-                {
+          this->ForEachLevelCandidate(performerVolume,
+              [&](std::size_t _index)
+              {
                 IGN_PROFILE("CheckPerformerAgainstLevel");
-                // Check if the performer is in this level
-                // assume a box for now
-                auto box = _levelGeometry->Data().BoxShape();
-                if (nullptr == box)
+                const auto &bounds = this->levelBounds[_index];
+                if (bounds.region.Intersects(performerVolume))
                 {
-                ignerr << "Level [" << _entity
-                << "]'s geometry is not a box." << std::endl;
-                return true;
+                  newPerfLevels.insert(bounds.entity);
+                  levelsToLoad.push_back(bounds.entity);
                 }
-                auto buffer = _levelBuffer->Data();
-                auto center = _pose->Data().Pos();
-                math::AxisAlignedBox region{center - box->Size() / 2,
-                center + box->Size() / 2};
-
-                math::AxisAlignedBox outerRegion{
-                  center - (box->Size() / 2 + buffer),
-                         center + (box->Size() / 2 + buffer)};
-
-                if (region.Intersects(performerVolume))
-                {
-                  newPerfLevels.insert(_entity);
-                  levelsToLoad.push_back(_entity);
-                }
-                else
+                // If the level is active, keep it while the performer is
+                // within the buffer of this level
+                else if (this->IsLevelActive(bounds.entity) &&
+                    bounds.outerRegion.Intersects(performerVolume))
                 {
-                  // If the level is active, check if the performer is
-                  // outside of the buffer of this level
-                  if (this->IsLevelActive(_entity))
-                  {
-                    if (outerRegion.Intersects(performerVolume))
-                    {
-                      newPerfLevels.insert(_entity);
-                      levelsToLoad.push_back(_entity);
-                      return true;
-                    }
-                    // Otherwise, mark the level to be unloaded
-                    levelsToUnload.push_back(_entity);
-                  }
+                  newPerfLevels.insert(bounds.entity);
+                  levelsToLoad.push_back(bounds.entity);
                 }
-                return true;
-                });
+              });
 
           *_perfLevels = components::PerformerLevels(newPerfLevels);
+          checkedPerformer = true;
 
           return true;
           });
+
+    // Active levels which no performer is in or near are unloaded. Levels
+    // which are also being loaded are filtered out below.
+    if (checkedPerformer)
+    {
+      for (const auto &bounds : this->levelBounds)
+      {
+        if (this->IsLevelActive(bounds.entity))
+          levelsToUnload.push_back(bounds.entity);
+      }
+    }
   }
 
   // Sort levelsToLoad and levelsToUnload so as to run std::unique on them.
@@ -720,8 +726,8 @@ void LevelManager::UpdateLevelsState()
   auto pendingRemove = std::remove_if(
       levelsToUnload.begin(), levelsToUnload.end(), [&](Entity _entity)
       {
-        return std::find(levelsToLoad.begin(), levelsToLoad.end(), _entity) !=
-               levelsToLoad.end();
+        return std::binary_search(levelsToLoad.begin(), levelsToLoad.end(),
+            _entity);
       });
   levelsToUnload.erase(pendingRemove, levelsToUnload.end());
 
@@ -873,6 +879,158 @@ void LevelManager::UnloadInactiveEntities(
   }
 }
 
+/////////////////////////////////////////////////
+void LevelManager::BuildLevelIndex()
+{
+  IGN_PROFILE("LevelManager::BuildLevelIndex");
+
+  this->levelBounds.clear();
+  this->levelGrid.clear();
+  this->largeLevels.clear();
+  this->levelIndexDirty = false;
+
+  math::Vector3d totalSize;
+  this->runner->entityCompMgr.Each<components::Level, components::Pose,
+    components::Geometry, components::LevelBuffer>(
+      [&](const Entity &_entity, const components::Level *,
+        const components::Pose *_pose,
+        const components::Geometry *_levelGeometry,
+        const components::LevelBuffer *_levelBuffer) -> bool
+      {
+        // Assume a box for now
+        auto box = _levelGeometry->Data().BoxShape();
+        if (nullptr == box)
+        {
+          ignerr << "Level [" << _entity
+                 << "]'s geometry is not a box." << std::endl;
+          return true;
+        }
+        auto buffer = _levelBuffer->Data();
+        auto center = _pose->Data().Pos();
+
+        LevelBounds bounds;
+        bounds.entity = _entity;
+        bounds.region = math::AxisAlignedBox{center - box->Size() / 2,
+            center + box->Size() / 2};
+        bounds.outerRegion = math::AxisAlignedBox{
+            center - (box->Size() / 2 + buffer),
+            center + (box->Size() / 2 + buffer)};
+        this->levelBounds.push_back(bounds);
+
+        totalSize += bounds.outerRegion.Size();
+        return true;
+      });
+
+  this->levelVisits.assign(this->levelBounds.size(), this->levelQuery);
+
+  if (this->levelBounds.empty())
+    return;
+
+  // Cells the size of an average level keep the number of cells per level
+  // and per performer lookup small.
+  this->levelCellSize = totalSize / static_cast<double>(
+      this->levelBounds.size());
+  for (auto i : {0, 1, 2})
+  {
+    if (!std::isfinite(this->levelCellSize[i]) ||
+        this->levelCellSize[i] <= 0.0)
+    {
+      this->levelCellSize[i] = 1.0;
+    }
+  }
+
+  // A handful of levels much larger than the rest would fill too many cells,
+  // those are checked separately.
+  const uint64_t maxCells = 512;
+  for (std::size_t index = 0; index < this->levelBounds.size(); ++index)
+  {
+    const auto &box = this->levelBounds[index].outerRegion;
+    int64_t min[3];
+    int64_t max[3];
+    uint64_t cellCount{1};
+    bool large{false};
+    for (auto i : {0, 1, 2})
+    {
+      const double lo = std::floor(box.Min()[i] / this->levelCellSize[i]);
+      const double hi = std::floor(box.Max()[i] / this->levelCellSize[i]);
+      if (!std::isfinite(lo) || !std::isfinite(hi) || hi - lo >= maxCells)
+      {
+        large = true;
+        break;
+      }
+      min[i] = static_cast<int64_t>(lo);
+      max[i] = static_cast<int64_t>(hi);
+      cellCount *= static_cast<uint64_t>(max[i] - min[i] + 1);
+    }
+
+    if (large || cellCount > maxCells)
+    {
+      this->largeLevels.push_back(index);
+      continue;
+    }
+
+    for (int64_t x = min[0]; x <= max[0]; ++x)
+      for (int64_t y = min[1]; y <= max[1]; ++y)
+        for (int64_t z = min[2]; z <= max[2]; ++z)
+          this->levelGrid[CellKey(x, y, z)].push_back(index);
+  }
+}
+
+/////////////////////////////////////////////////
+void LevelManager::ForEachLevelCandidate(const math::AxisAlignedBox &_box,
+    const std::function<void(std::size_t)> &_f)
+{
+  const uint64_t query = ++this->levelQuery;
+  auto visit = [&](std::size_t _index)
+  {
+    if (this->levelVisits[_index] == query)
+      return;
+    this->levelVisits[_index] = query;
+    _f(_index);
+  };
+
+  for (auto index : this->largeLevels)
+    visit(index);
+
+  if (this->levelGrid.empty())
+    return;
+
+  int64_t min[3];
+  int64_t max[3];
+  for (auto i : {0, 1, 2})
+  {
+    const double lo = std::floor(_box.Min()[i] / this->levelCellSize[i]);
+    const double hi = std::floor(_box.Max()[i] / this->levelCellSize[i]);
+
+    // A box spanning more cells than there are levels is faster to check
+    // against all of them.
+    if (!std::isfinite(lo) || !std::isfinite(hi) ||
+        hi - lo >= static_cast<double>(this->levelBounds.size()))
+    {
+      for (std::size_t index = 0; index < this->levelBounds.size(); ++index)
+        visit(index);
+      return;
+    }
+    min[i] = static_cast<int64_t>(lo);
+    max[i] = static_cast<int64_t>(hi);
+  }
+
+  for (int64_t x = min[0]; x <= max[0]; ++x)
+  {
+    for (int64_t y = min[1]; y <= max[1]; ++y)
+    {
+      for (int64_t z = min[2]; z <= max[2]; ++z)
+      {
+        auto cell = this->levelGrid.find(CellKey(x, y, z));
+        if (cell == this->levelGrid.end())
+          continue;
+        for (auto index : cell->second)
+          visit(index);
+      }
+    }
+  }
+}
+
 /////////////////////////////////////////////////
 bool LevelManager::IsLevelActive(const Entity _entity) const
 {
@@ -21,6 +21,8 @@
 #include <ignition/msgs/boolean.pb.h>
 #include <ignition/msgs/stringmsg.pb.h>
 
+#include <cstdint>
+#include <functional>
 #include <list>
 #include <memory>
 #include <set>
@@ -31,6 +33,8 @@
 
 #include <sdf/Element.hh>
 #include <sdf/Geometry.hh>
+#include <ignition/math/AxisAlignedBox.hh>
+#include <ignition/math/Vector3.hh>
 #include <ignition/transport/Node.hh>
 
 #include "ignition/gazebo/config.hh"
@@ -120,6 +124,19 @@ namespace ignition
       /// schedule them to be loaded
       private: void ConfigureDefaultLevel();
 
+      /// \brief Rebuild the spatial index used to find the levels a
+      /// performer may be in. Levels are assumed static, so this only
+      /// happens after levels are created.
+      private: void BuildLevelIndex();
+
+      /// \brief Call a function for every indexed level whose outer region
+      /// may intersect a box. Each level is visited at most once.
+      /// \param[in] _box Box to look up, in the world frame.
+      /// \param[in] _f Function called with the index of each candidate
+      /// within levelBounds.
+      private: void ForEachLevelCandidate(const math::AxisAlignedBox &_box,
+                   const std::function<void(std::size_t)> &_f);
+
       /// \brief Determine if a level is active
       /// \param[in] _entity Entity of level to be checked
       /// \return True of the level is currently active
@@ -178,6 +195,47 @@ namespace ignition
 
       /// \brief Mutex to protect performersToAdd list.
       private: std::mutex performerToAddMutex;
+
+      /// \brief World frame bounds of a level.
+      private: struct LevelBounds
+      {
+        /// \brief Level entity.
+        Entity entity{kNullEntity};
+
+        /// \brief Region covered by the level.
+        math::AxisAlignedBox region;
+
+        /// \brief Region covered by the level including its buffer.
+        math::AxisAlignedBox outerRegion;
+      };
+
+      /// \brief Bounds of all levels in the spatial index.
+      private: std::vector<LevelBounds> levelBounds;
+
+      /// \brief Uniform grid over the outer regions of the levels. Maps a
+      /// cell key to the indices within levelBounds of the levels overlapping
+      /// that cell.
+      private: std::unordered_map<uint64_t, std::vector<std::size_t>>
+          levelGrid;
+
+      /// \brief Indices within levelBounds of levels which span too many
+      /// cells to be stored in the grid. These are checked against every
+      /// performer.
+      private: std::vector<std::size_t> largeLevels;
+
+      /// \brief Size of a grid cell along each axis.
+      private: math::Vector3d levelCellSize{1, 1, 1};
+
+      /// \brief Last query that visited each level, used to visit levels
+      /// overlapping multiple cells only once.
+      private: std::vector<uint64_t> levelVisits;
+
+      /// \brief Counter of queries to the spatial index.
+      private: uint64_t levelQuery{0};
+
+      /// \brief Whether levels were created since the spatial index was
+      /// built.
+      private: bool levelIndexDirty{true};
     };
     }
   }
@@ -74,6 +74,8 @@
 #include "ignition/gazebo/components/WindMode.hh"
 #include "ignition/gazebo/components/World.hh"
 
+#include "InternedSdf.hh"
+
 class ignition::gazebo::SdfEntityCreatorPrivate
 {
   /// \brief Pointer to entity component manager. We don't assume ownership.
@@ -690,14 +692,14 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Visual *_visual)
   if (_visual->Geom())
   {
     this->dataPtr->ecm->CreateComponent(visualEntity,
-        components::Geometry(*_visual->Geom()));
+        components::Geometry(InternSdf(*_visual->Geom())));
   }
 
   // \todo(louise) Populate with default material if undefined
   if (_visual->Material())
   {
     this->dataPtr->ecm->CreateComponent(visualEntity,
-        components::Material(*_visual->Material()));
+        components::Material(InternSdf(*_visual->Material())));
   }
 
   // Keep track of visuals so we can load their plugins after loading the
@@ -745,7 +747,7 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Collision *_collision)
   if (_collision->Geom())
   {
     this->dataPtr->ecm->CreateComponent(collisionEntity,
-        components::Geometry(*_collision->Geom()));
+        components::Geometry(InternSdf(*_collision->Geom())));
   }
 
   this->dataPtr->ecm->CreateComponent(collisionEntity,
@@ -773,12 +775,12 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Sensor *_sensor)
   if (_sensor->Type() == sdf::SensorType::CAMERA)
   {
     this->dataPtr->ecm->CreateComponent(sensorEntity,
-        components::Camera(*_sensor));
+        components::Camera(InternSdf(*_sensor)));
   }
   else if (_sensor->Type() == sdf::SensorType::GPU_LIDAR)
   {
     this->dataPtr->ecm->CreateComponent(sensorEntity,
-        components::GpuLidar(*_sensor));
+        components::GpuLidar(InternSdf(*_sensor)));
   }
   else if (_sensor->Type() == sdf::SensorType::LIDAR)
   {
@@ -791,22 +793,22 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Sensor *_sensor)
   else if (_sensor->Type() == sdf::SensorType::DEPTH_CAMERA)
   {
     this->dataPtr->ecm->CreateComponent(sensorEntity,
-        components::DepthCamera(*_sensor));
+        components::DepthCamera(InternSdf(*_sensor)));
   }
   else if (_sensor->Type() == sdf::SensorType::RGBD_CAMERA)
   {
     this->dataPtr->ecm->CreateComponent(sensorEntity,
-        components::RgbdCamera(*_sensor));
+        components::RgbdCamera(InternSdf(*_sensor)));
   }
   else if (_sensor->Type() == sdf::SensorType::THERMAL_CAMERA)
   {
     this->dataPtr->ecm->CreateComponent(sensorEntity,
-        components::ThermalCamera(*_sensor));
+        components::ThermalCamera(InternSdf(*_sensor)));
   }
   else if (_sensor->Type() == sdf::SensorType::AIR_PRESSURE)
   {
     this->dataPtr->ecm->CreateComponent(sensorEntity,
-        components::AirPressureSensor(*_sensor));
+        components::AirPressureSensor(InternSdf(*_sensor)));
 
     // create components to be filled by physics
     this->dataPtr->ecm->CreateComponent(sensorEntity,
@@ -815,7 +817,7 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Sensor *_sensor)
   else if (_sensor->Type() == sdf::SensorType::ALTIMETER)
   {
     this->dataPtr->ecm->CreateComponent(sensorEntity,
-        components::Altimeter(*_sensor));
+        components::Altimeter(InternSdf(*_sensor)));
 
     // create components to be filled by physics
     this->dataPtr->ecm->CreateComponent(sensorEntity,
@@ -826,7 +828,7 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Sensor *_sensor)
   else if (_sensor->Type() == sdf::SensorType::IMU)
   {
     this->dataPtr->ecm->CreateComponent(sensorEntity,
-            components::Imu(*_sensor));
+            components::Imu(InternSdf(*_sensor)));
 
     // create components to be filled by physics
     this->dataPtr->ecm->CreateComponent(sensorEntity,
@@ -850,7 +852,7 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Sensor *_sensor)
   else if (_sensor->Type() == sdf::SensorType::MAGNETOMETER)
   {
     this->dataPtr->ecm->CreateComponent(sensorEntity,
-        components::Magnetometer(*_sensor));
+        components::Magnetometer(InternSdf(*_sensor)));
 
     // create components to be filled by physics
     this->dataPtr->ecm->CreateComponent(sensorEntity,
@@ -235,7 +235,9 @@ class ignition::gazebo::ServerConfigPrivate
             plugins(_cfg->plugins),
             networkRole(_cfg->networkRole),
             networkSecondaries(_cfg->networkSecondaries),
+            networkMaxStaleness(_cfg->networkMaxStaleness),
             seed(_cfg->seed),
+            workerThreads(_cfg->workerThreads),
             logRecordTopics(_cfg->logRecordTopics) { }
 
   // \brief The SDF file that the server should load
@@ -293,9 +295,15 @@ class ignition::gazebo::ServerConfigPrivate
   /// \brief The number of network secondaries.
   public: unsigned int networkSecondaries = 0;
 
+  /// \brief The number of steps network secondaries may run ahead.
+  public: unsigned int networkMaxStaleness = 0;
+
   /// \brief The given random seed.
   public: unsigned int seed = 0;
 
+  /// \brief Number of worker threads, 0 to choose based on the hardware.
+  public: unsigned int workerThreads = 0;
+
   /// \brief Timestamp that marks when this ServerConfig was created.
   public: std::chrono::time_point<std::chrono::system_clock> timestamp;
 
@@ -409,6 +417,18 @@ std::string ServerConfig::NetworkRole() const
   return this->dataPtr->networkRole;
 }
 
+/////////////////////////////////////////////////
+void ServerConfig::SetNetworkMaxStaleness(unsigned int _staleness)
+{
+  this->dataPtr->networkMaxStaleness = _staleness;
+}
+
+/////////////////////////////////////////////////
+unsigned int ServerConfig::NetworkMaxStaleness() const
+{
+  return this->dataPtr->networkMaxStaleness;
+}
+
 /////////////////////////////////////////////////
 bool ServerConfig::UseDistributedSimulation() const
 {
@@ -502,6 +522,18 @@ void ServerConfig::SetSeed(unsigned int _seed)
   ignition::math::Rand::Seed(_seed);
 }
 
+/////////////////////////////////////////////////
+unsigned int ServerConfig::WorkerThreads() const
+{
+  return this->dataPtr->workerThreads;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetWorkerThreads(unsigned int _threads)
+{
+  this->dataPtr->workerThreads = _threads;
+}
+
 /////////////////////////////////////////////////
 const std::string &ServerConfig::ResourceCache() const
 {
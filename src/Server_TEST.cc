@@ -16,7 +16,11 @@
 */
 
 #include <gtest/gtest.h>
+#include <atomic>
 #include <csignal>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
 #include <vector>
 #include <ignition/common/StringUtils.hh>
 #include <ignition/common/Util.hh>
@@ -27,6 +31,8 @@
 #include "ignition/gazebo/components/AxisAlignedBox.hh"
 #include "ignition/gazebo/components/Geometry.hh"
 #include "ignition/gazebo/components/Model.hh"
+#include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/Pose.hh"
 #include "ignition/gazebo/Entity.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
 #include "ignition/gazebo/System.hh"
@@ -60,12 +66,14 @@ TEST_P(ServerFixture, DefaultServerConfig)
   EXPECT_FALSE(serverConfig.UseDistributedSimulation());
   EXPECT_EQ(0u, serverConfig.NetworkSecondaries());
   EXPECT_TRUE(serverConfig.NetworkRole().empty());
+  EXPECT_EQ(0u, serverConfig.NetworkMaxStaleness());
   EXPECT_FALSE(serverConfig.UseLogRecord());
   EXPECT_FALSE(serverConfig.LogRecordPath().empty());
   EXPECT_TRUE(serverConfig.LogPlaybackPath().empty());
   EXPECT_FALSE(serverConfig.LogRecordResources());
   EXPECT_TRUE(serverConfig.LogRecordCompressPath().empty());
   EXPECT_EQ(0u, serverConfig.Seed());
+  EXPECT_EQ(0u, serverConfig.WorkerThreads());
   EXPECT_EQ(123ms, serverConfig.UpdatePeriod().value_or(123ms));
   EXPECT_TRUE(serverConfig.ResourceCache().empty());
   EXPECT_TRUE(serverConfig.PhysicsEngine().empty());
@@ -741,6 +749,176 @@ TEST_P(ServerFixture, Seed)
   EXPECT_EQ(mySeed, ignition::math::Rand::Seed());
 }
 
+/////////////////////////////////////////////////
+TEST_P(ServerFixture, WorkerThreads)
+{
+  ignition::gazebo::ServerConfig serverConfig;
+  EXPECT_EQ(0u, serverConfig.WorkerThreads());
+  serverConfig.SetWorkerThreads(3u);
+  EXPECT_EQ(3u, serverConfig.WorkerThreads());
+
+  // The setting is copied with the config
+  ignition::gazebo::ServerConfig copy(serverConfig);
+  EXPECT_EQ(3u, copy.WorkerThreads());
+
+  serverConfig.SetSdfString(TestWorldSansPhysics::World());
+  gazebo::Server server(serverConfig);
+  EXPECT_TRUE(server.RunOnce());
+}
+
+/////////////////////////////////////////////////
+/// \brief System which declares its component access and runs a callback
+/// on PreUpdate.
+class AccessSystem :
+  public System,
+  public ISystemPreUpdate,
+  public ISystemComponentAccess
+{
+  public: AccessSystem(std::unordered_set<ComponentTypeId> _reads,
+              std::unordered_set<ComponentTypeId> _writes,
+              std::function<void()> _callback, bool _exclusive = false)
+    : reads(std::move(_reads)), writes(std::move(_writes)),
+      callback(std::move(_callback)), exclusive(_exclusive)
+  {
+  }
+
+  public: void PreUpdate(const UpdateInfo &, EntityComponentManager &) override
+  {
+    this->callback();
+  }
+
+  public: std::unordered_set<ComponentTypeId> ReadComponents() const override
+  {
+    return this->reads;
+  }
+
+  public: std::unordered_set<ComponentTypeId> WriteComponents() const override
+  {
+    return this->writes;
+  }
+
+  public: bool NeedsExclusiveAccess(const EntityComponentManager &) override
+  {
+    return this->exclusive;
+  }
+
+  private: std::unordered_set<ComponentTypeId> reads;
+  private: std::unordered_set<ComponentTypeId> writes;
+  private: std::function<void()> callback;
+  private: bool exclusive;
+};
+
+/////////////////////////////////////////////////
+TEST_P(ServerFixture, ConcurrentSystems)
+{
+  ServerConfig serverConfig;
+  serverConfig.SetSdfString(TestWorldSansPhysics::World());
+  serverConfig.SetWorkerThreads(2u);
+  gazebo::Server server(serverConfig);
+
+  // Systems A and B don't conflict, so they must be able to meet inside
+  // PreUpdate. C writes what A reads, so it must run after A.
+  std::atomic<int> inside{0};
+  std::atomic<int> aDone{0};
+  std::atomic<int> met{0};
+  std::atomic<int> orderViolations{0};
+
+  auto rendezvous = [&]
+  {
+    const int iteration = ++inside;
+    const int target = ((iteration + 1) / 2) * 2;
+    auto start = std::chrono::steady_clock::now();
+    while (inside < target &&
+        std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+    {
+      std::this_thread::yield();
+    }
+    if (inside >= target)
+      ++met;
+  };
+
+  auto systemA = std::make_shared<AccessSystem>(
+      std::unordered_set<ComponentTypeId>{components::Pose::typeId},
+      std::unordered_set<ComponentTypeId>{},
+      [&]
+      {
+        rendezvous();
+        ++aDone;
+      });
+  auto systemB = std::make_shared<AccessSystem>(
+      std::unordered_set<ComponentTypeId>{components::Pose::typeId},
+      std::unordered_set<ComponentTypeId>{components::Name::typeId},
+      rendezvous);
+  int cCalls{0};
+  auto systemC = std::make_shared<AccessSystem>(
+      std::unordered_set<ComponentTypeId>{},
+      std::unordered_set<ComponentTypeId>{components::Pose::typeId},
+      [&]
+      {
+        if (aDone != ++cCalls)
+          ++orderViolations;
+      });
+
+  EXPECT_TRUE(*server.AddSystem(systemA));
+  EXPECT_TRUE(*server.AddSystem(systemB));
+  EXPECT_TRUE(*server.AddSystem(systemC));
+
+  const unsigned int iterations = 10;
+  EXPECT_TRUE(server.Run(true, iterations, false));
+
+  EXPECT_EQ(static_cast<int>(iterations) * 2, met);
+  EXPECT_EQ(static_cast<int>(iterations), cCalls);
+  EXPECT_EQ(0, orderViolations);
+}
+
+/////////////////////////////////////////////////
+TEST_P(ServerFixture, ExclusiveSystems)
+{
+  ServerConfig serverConfig;
+  serverConfig.SetSdfString(TestWorldSansPhysics::World());
+  serverConfig.SetWorkerThreads(2u);
+  gazebo::Server server(serverConfig);
+
+  // A and B don't conflict, but B asks for exclusive access, so they must
+  // run one at a time, in load order.
+  std::atomic<int> inside{0};
+  std::atomic<int> overlaps{0};
+  std::vector<char> order;
+  std::mutex orderMutex;
+
+  auto track = [&](char _name)
+  {
+    if (++inside > 1)
+      ++overlaps;
+    {
+      std::lock_guard<std::mutex> lock(orderMutex);
+      order.push_back(_name);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    --inside;
+  };
+
+  auto systemA = std::make_shared<AccessSystem>(
+      std::unordered_set<ComponentTypeId>{components::Pose::typeId},
+      std::unordered_set<ComponentTypeId>{},
+      [&]{track('a');});
+  auto systemB = std::make_shared<AccessSystem>(
+      std::unordered_set<ComponentTypeId>{components::Pose::typeId},
+      std::unordered_set<ComponentTypeId>{},
+      [&]{track('b');}, true);
+
+  EXPECT_TRUE(*server.AddSystem(systemA));
+  EXPECT_TRUE(*server.AddSystem(systemB));
+
+  const unsigned int iterations = 10;
+  EXPECT_TRUE(server.Run(true, iterations, false));
+
+  EXPECT_EQ(0, overlaps);
+  ASSERT_EQ(iterations * 2, order.size());
+  for (size_t i = 0; i < order.size(); ++i)
+    EXPECT_EQ(i % 2 == 0 ? 'a' : 'b', order[i]) << i;
+}
+
 /////////////////////////////////////////////////
 TEST_P(ServerFixture, ResourcePath)
 {
@@ -0,0 +1,397 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "SharedMemoryRing.hh"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <random>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <ignition/common/Console.hh>
+
+using namespace ignition::gazebo;
+
+namespace
+{
+/// \brief Identifies buffers created by this class.
+constexpr uint64_t kMagic{0x69676e72696e6701};
+
+/// \brief Size of a record which marks the end of a lap.
+constexpr uint32_t kWrapSize{0xFFFFFFFF};
+
+/// \brief Flag set on keyframe records.
+constexpr uint32_t kKeyframeFlag{0x1};
+
+/// \brief Shared state at the beginning of the mapping. Positions are byte
+/// counts since the buffer was created, the offset in the data region is
+/// the position modulo the capacity.
+struct Header
+{
+  /// \brief Always kMagic.
+  uint64_t magic;
+
+  /// \brief Random token chosen by the writer.
+  uint64_t token;
+
+  /// \brief Size of the data region.
+  uint64_t capacity;
+
+  /// \brief End of the region being written. Readers check it after
+  /// copying a record to know whether the record was overwritten meanwhile.
+  std::atomic<uint64_t> reserved;
+
+  /// \brief End of the last complete record.
+  std::atomic<uint64_t> committed;
+
+  /// \brief Number of messages written or dropped.
+  std::atomic<uint64_t> sequence;
+
+  /// \brief Set when the writer is destroyed.
+  std::atomic<uint32_t> closed;
+};
+
+/// \brief Header of each message in the data region.
+struct Record
+{
+  /// \brief Sequence number of the message.
+  uint64_t sequence;
+
+  /// \brief Size of the message, or kWrapSize.
+  uint32_t size;
+
+  /// \brief Combination of flags such as kKeyframeFlag.
+  uint32_t flags;
+};
+
+/// \brief Records are aligned so that a record header always fits before
+/// the end of the data region.
+constexpr std::size_t kAlignment{sizeof(Record)};
+
+/// \brief Offset of the data region in the mapping.
+constexpr std::size_t kDataOffset{
+    (sizeof(Header) + 63) / 64 * 64};
+
+/// \brief Round up to the record alignment.
+/// \param[in] _size Size in bytes.
+/// \return Aligned size.
+std::size_t Align(std::size_t _size)
+{
+  return (_size + kAlignment - 1) / kAlignment * kAlignment;
+}
+}
+
+class ignition::gazebo::SharedMemoryRingPrivate
+{
+  /// \brief Name of the shared memory object.
+  public: std::string name;
+
+  /// \brief Start of the mapping.
+  public: void *mapping{nullptr};
+
+  /// \brief Size of the mapping.
+  public: std::size_t mappingSize{0};
+
+  /// \brief Shared header, inside the mapping.
+  public: Header *header{nullptr};
+
+  /// \brief Data region, inside the mapping.
+  public: char *data{nullptr};
+
+  /// \brief True for the writer.
+  public: bool writer{false};
+
+  /// \brief Position of the next record to read.
+  public: uint64_t readPos{0};
+
+  /// \brief Sequence number of the next message to read.
+  public: uint64_t nextSequence{0};
+
+  /// \brief Whether a message has been read yet.
+  public: bool started{false};
+};
+
+//////////////////////////////////////////////////
+SharedMemoryRing::SharedMemoryRing()
+  : dataPtr(std::make_unique<SharedMemoryRingPrivate>())
+{
+}
+
+//////////////////////////////////////////////////
+SharedMemoryRing::~SharedMemoryRing()
+{
+#ifndef _WIN32
+  if (this->dataPtr->mapping == nullptr)
+    return;
+
+  if (this->dataPtr->writer)
+  {
+    this->dataPtr->header->closed.store(1, std::memory_order_release);
+    shm_unlink(this->dataPtr->name.c_str());
+  }
+
+  munmap(this->dataPtr->mapping, this->dataPtr->mappingSize);
+#endif
+}
+
+//////////////////////////////////////////////////
+std::unique_ptr<SharedMemoryRing> SharedMemoryRing::Create(
+    const std::string &_name, std::size_t _capacity)
+{
+#ifdef _WIN32
+  (void)_name;
+  (void)_capacity;
+  return nullptr;
+#else
+  const std::size_t capacity = Align(_capacity);
+  const std::size_t mappingSize = kDataOffset + capacity;
+
+  // Left behind by a process which crashed
+  shm_unlink(_name.c_str());
+
+  // Only processes of the same user may read the state
+  int fd = shm_open(_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0)
+  {
+    ignerr << "Failed to create shared memory [" << _name << "]: "
+           << std::strerror(errno) << std::endl;
+    return nullptr;
+  }
+
+  if (ftruncate(fd, static_cast<off_t>(mappingSize)) != 0)
+  {
+    ignerr << "Failed to allocate [" << mappingSize
+           << "] bytes of shared memory [" << _name << "]: "
+           << std::strerror(errno) << std::endl;
+    close(fd);
+    shm_unlink(_name.c_str());
+    return nullptr;
+  }
+
+  void *mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE,
+      MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED)
+  {
+    ignerr << "Failed to map shared memory [" << _name << "]: "
+           << std::strerror(errno) << std::endl;
+    shm_unlink(_name.c_str());
+    return nullptr;
+  }
+
+  std::random_device rd;
+  auto header = new (mapping) Header();
+  header->token = (static_cast<uint64_t>(rd()) << 32) | rd();
+  header->capacity = capacity;
+  header->reserved = 0;
+  header->committed = 0;
+  header->sequence = 0;
+  header->closed = 0;
+  std::atomic_thread_fence(std::memory_order_release);
+  header->magic = kMagic;
+
+  std::unique_ptr<SharedMemoryRing> ring(new SharedMemoryRing());
+  ring->dataPtr->name = _name;
+  ring->dataPtr->mapping = mapping;
+  ring->dataPtr->mappingSize = mappingSize;
+  ring->dataPtr->header = header;
+  ring->dataPtr->data = static_cast<char *>(mapping) + kDataOffset;
+  ring->dataPtr->writer = true;
+  return ring;
+#endif
+}
+
+//////////////////////////////////////////////////
+std::unique_ptr<SharedMemoryRing> SharedMemoryRing::Open(
+    const std::string &_name, uint64_t _token)
+{
+#ifdef _WIN32
+  (void)_name;
+  (void)_token;
+  return nullptr;
+#else
+  int fd = shm_open(_name.c_str(), O_RDONLY, 0);
+  if (fd < 0)
+    return nullptr;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 ||
+      static_cast<std::size_t>(st.st_size) < kDataOffset)
+  {
+    close(fd);
+    return nullptr;
+  }
+
+  const std::size_t mappingSize = static_cast<std::size_t>(st.st_size);
+  void *mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED)
+    return nullptr;
+
+  auto header = static_cast<Header *>(mapping);
+  if (header->magic != kMagic || header->token != _token ||
+      kDataOffset + header->capacity > mappingSize)
+  {
+    munmap(mapping, mappingSize);
+    return nullptr;
+  }
+
+  std::unique_ptr<SharedMemoryRing> ring(new SharedMemoryRing());
+  ring->dataPtr->name = _name;
+  ring->dataPtr->mapping = mapping;
+  ring->dataPtr->mappingSize = mappingSize;
+  ring->dataPtr->header = header;
+  ring->dataPtr->data = static_cast<char *>(mapping) + kDataOffset;
+  ring->dataPtr->readPos =
+      header->committed.load(std::memory_order_acquire);
+  return ring;
+#endif
+}
+
+//////////////////////////////////////////////////
+const std::string &SharedMemoryRing::Name() const
+{
+  return this->dataPtr->name;
+}
+
+//////////////////////////////////////////////////
+uint64_t SharedMemoryRing::Token() const
+{
+  return this->dataPtr->header->token;
+}
+
+//////////////////////////////////////////////////
+bool SharedMemoryRing::Closed() const
+{
+  return this->dataPtr->header->closed.load(std::memory_order_acquire) != 0;
+}
+
+//////////////////////////////////////////////////
+bool SharedMemoryRing::Write(const std::string &_data, bool _keyframe)
+{
+  auto header = this->dataPtr->header;
+  const uint64_t capacity = header->capacity;
+  const uint64_t sequence =
+      header->sequence.fetch_add(1, std::memory_order_relaxed);
+
+  // A message larger than half the buffer would be overwritten before most
+  // readers get to it.
+  const std::size_t recordSize = sizeof(Record) + Align(_data.size());
+  if (recordSize > capacity / 2)
+    return false;
+
+  uint64_t pos = header->committed.load(std::memory_order_relaxed);
+  uint64_t offset = pos % capacity;
+  const bool wrap = offset + recordSize > capacity;
+  const uint64_t start = wrap ? pos + capacity - offset : pos;
+  const uint64_t end = start + recordSize;
+
+  // Readers copying what we're about to overwrite will notice
+  header->reserved.store(end, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  if (wrap)
+  {
+    Record marker{sequence, kWrapSize, 0};
+    std::memcpy(this->dataPtr->data + offset, &marker, sizeof(marker));
+    offset = 0;
+  }
+
+  Record record{sequence, static_cast<uint32_t>(_data.size()),
+      _keyframe ? kKeyframeFlag : 0u};
+  std::memcpy(this->dataPtr->data + offset, &record, sizeof(record));
+  std::memcpy(this->dataPtr->data + offset + sizeof(record), _data.data(),
+      _data.size());
+
+  header->committed.store(end, std::memory_order_release);
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool SharedMemoryRing::Read(std::string &_data, bool &_keyframe,
+    uint64_t &_lost)
+{
+  auto header = this->dataPtr->header;
+  const uint64_t capacity = header->capacity;
+  auto &readPos = this->dataPtr->readPos;
+  _lost = 0;
+
+  while (true)
+  {
+    const uint64_t committed =
+        header->committed.load(std::memory_order_acquire);
+    if (readPos == committed)
+      return false;
+
+    // Skip to the newest data. What was missed is counted once the next
+    // message is read.
+    if (committed - readPos > capacity)
+    {
+      readPos = committed;
+      return false;
+    }
+
+    const uint64_t offset = readPos % capacity;
+    Record record;
+    std::memcpy(&record, this->dataPtr->data + offset, sizeof(record));
+
+    const bool wrap = record.size == kWrapSize;
+    if (!wrap && offset + sizeof(record) + record.size <= capacity)
+    {
+      _data.assign(this->dataPtr->data + offset + sizeof(record),
+          record.size);
+    }
+
+    // Check that the writer didn't overwrite the record while it was
+    // being copied
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header->reserved.load(std::memory_order_relaxed) - readPos > capacity)
+    {
+      readPos = committed;
+      return false;
+    }
+
+    if (wrap)
+    {
+      readPos += capacity - offset;
+      continue;
+    }
+
+    readPos += sizeof(record) + Align(record.size);
+
+    // Messages which were overwritten, or which didn't fit and were
+    // dropped by the writer
+    if (this->dataPtr->started &&
+        record.sequence > this->dataPtr->nextSequence)
+    {
+      _lost += record.sequence - this->dataPtr->nextSequence;
+    }
+    this->dataPtr->nextSequence = record.sequence + 1;
+    this->dataPtr->started = true;
+
+    _keyframe = (record.flags & kKeyframeFlag) != 0;
+    return true;
+  }
+}
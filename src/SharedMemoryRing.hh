@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SHAREDMEMORYRING_HH_
+#define IGNITION_GAZEBO_SHAREDMEMORYRING_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations.
+    class SharedMemoryRingPrivate;
+
+    /// \class SharedMemoryRing SharedMemoryRing.hh
+    /// \brief Ring buffer of messages in POSIX shared memory, written by a
+    /// single process and read by any number of processes on the same host.
+    ///
+    /// The writer never waits for readers. Readers which fall behind by more
+    /// than the capacity of the buffer lose the oldest messages, and are told
+    /// how many messages they lost when they read the next one. Messages can
+    /// be flagged as keyframes, from which readers can recover after losing
+    /// messages.
+    ///
+    /// Readers map the buffer read-only. They must know the token of the
+    /// buffer, which the writer shares through other means, so that a
+    /// reader on another host doesn't attach to an unrelated buffer which
+    /// happens to have the same name.
+    ///
+    /// Shared memory isn't supported on Windows, where Create and Open
+    /// always return null.
+    class IGNITION_GAZEBO_VISIBLE SharedMemoryRing
+    {
+      /// \brief Create a buffer to write to. A stale buffer with the same
+      /// name is replaced.
+      /// \param[in] _name Name of the buffer, starting with a slash.
+      /// \param[in] _capacity Number of bytes available for messages.
+      /// \return The buffer, or null if it couldn't be created.
+      public: static std::unique_ptr<SharedMemoryRing> Create(
+          const std::string &_name, std::size_t _capacity);
+
+      /// \brief Open an existing buffer to read from. Only messages written
+      /// after the buffer was opened are read.
+      /// \param[in] _name Name of the buffer.
+      /// \param[in] _token Token of the buffer.
+      /// \return The buffer, or null if there's no buffer with that name and
+      /// token on this host.
+      public: static std::unique_ptr<SharedMemoryRing> Open(
+          const std::string &_name, uint64_t _token);
+
+      /// \brief Destructor. Destroying the writer closes the buffer for all
+      /// readers.
+      public: ~SharedMemoryRing();
+
+      /// \brief Get the name of the buffer.
+      /// \return Name.
+      public: const std::string &Name() const;
+
+      /// \brief Get the token of the buffer.
+      /// \return Random token chosen by the writer.
+      public: uint64_t Token() const;
+
+      /// \brief Append a message. Only valid for the writer.
+      /// \param[in] _data Message bytes.
+      /// \param[in] _keyframe True if readers can recover from lost messages
+      /// starting with this message.
+      /// \return False if the message doesn't fit in the buffer, in which
+      /// case readers see it as lost.
+      public: bool Write(const std::string &_data, bool _keyframe);
+
+      /// \brief Read the next message. Only valid for readers.
+      /// \param[out] _data Message bytes.
+      /// \param[out] _keyframe True if the message is a keyframe.
+      /// \param[out] _lost Number of messages lost between the previous
+      /// message read and this one.
+      /// \return True if a message was read.
+      public: bool Read(std::string &_data, bool &_keyframe, uint64_t &_lost);
+
+      /// \brief Check whether the writer closed the buffer.
+      /// \return True if no more messages will be written.
+      public: bool Closed() const;
+
+      /// \brief Private constructor, use Create or Open.
+      private: SharedMemoryRing();
+
+      /// \brief Private data pointer.
+      private: std::unique_ptr<SharedMemoryRingPrivate> dataPtr;
+    };
+    }
+  }
+}
+#endif
@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "SharedMemoryRing.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Name used by the tests, unique per process.
+std::string testName()
+{
+#ifndef _WIN32
+  return "/ign_gazebo_ring_test_" + std::to_string(getpid());
+#else
+  return "";
+#endif
+}
+
+/////////////////////////////////////////////////
+TEST(SharedMemoryRing, WriteRead)
+{
+#ifdef _WIN32
+  EXPECT_EQ(nullptr, SharedMemoryRing::Create("/test", 1024));
+#else
+  auto writer = SharedMemoryRing::Create(testName(), 1024);
+  ASSERT_NE(nullptr, writer);
+  EXPECT_EQ(testName(), writer->Name());
+
+  // Wrong token
+  EXPECT_EQ(nullptr, SharedMemoryRing::Open(testName(), writer->Token() + 1));
+  EXPECT_EQ(nullptr, SharedMemoryRing::Open("/does_not_exist", 0));
+
+  // Messages written before opening aren't read
+  EXPECT_TRUE(writer->Write("before", true));
+
+  auto reader = SharedMemoryRing::Open(testName(), writer->Token());
+  ASSERT_NE(nullptr, reader);
+  EXPECT_FALSE(reader->Closed());
+
+  std::string data;
+  bool keyframe{false};
+  uint64_t lost{0};
+  EXPECT_FALSE(reader->Read(data, keyframe, lost));
+  EXPECT_EQ(0u, lost);
+
+  // Enough messages to wrap around a few times, read as they're written
+  for (int i = 0; i < 100; ++i)
+  {
+    std::string msg(i % 50, 'a' + i % 26);
+    EXPECT_TRUE(writer->Write(msg, i % 10 == 0));
+    ASSERT_TRUE(reader->Read(data, keyframe, lost)) << i;
+    EXPECT_EQ(msg, data);
+    EXPECT_EQ(i % 10 == 0, keyframe);
+    EXPECT_EQ(0u, lost);
+  }
+  EXPECT_FALSE(reader->Read(data, keyframe, lost));
+
+  // Messages larger than half the buffer are dropped
+  EXPECT_FALSE(writer->Write(std::string(600, 'x'), true));
+  EXPECT_TRUE(writer->Write("small", false));
+  EXPECT_TRUE(reader->Read(data, keyframe, lost));
+  EXPECT_EQ("small", data);
+  EXPECT_EQ(1u, lost);
+
+  // A slow reader loses the overwritten messages, and resumes with new ones
+  for (int i = 0; i < 100; ++i)
+    EXPECT_TRUE(writer->Write(std::string(100, 'y'), false));
+  EXPECT_FALSE(reader->Read(data, keyframe, lost));
+  EXPECT_TRUE(writer->Write("after", true));
+  EXPECT_TRUE(reader->Read(data, keyframe, lost));
+  EXPECT_EQ("after", data);
+  EXPECT_EQ(100u, lost);
+
+  writer.reset();
+  EXPECT_TRUE(reader->Closed());
+#endif
+}
+
+/////////////////////////////////////////////////
+TEST(SharedMemoryRing, Processes)
+{
+#ifndef _WIN32
+  auto writer = SharedMemoryRing::Create(testName(), 4096);
+  ASSERT_NE(nullptr, writer);
+  auto token = writer->Token();
+
+  // Opened before the child starts writing
+  auto reader = SharedMemoryRing::Open(testName(), token);
+  ASSERT_NE(nullptr, reader);
+
+  const int count = 10000;
+  pid_t pid = fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0)
+  {
+    // Child writes through its copy of the mapping, in bursts
+    for (int i = 0; i < count; ++i)
+    {
+      writer->Write(std::to_string(i), i % 100 == 0);
+      if (i % 100 == 99)
+        usleep(100);
+    }
+    writer.reset();
+    _exit(0);
+  }
+
+  // Parent reads whatever it can keep up with, in order
+  int last{-1};
+  int received{0};
+  std::string data;
+  bool keyframe{false};
+  uint64_t lost{0};
+  while (true)
+  {
+    if (!reader->Read(data, keyframe, lost))
+    {
+      if (reader->Closed() && !reader->Read(data, keyframe, lost))
+        break;
+      continue;
+    }
+
+    // Lost messages are reported exactly
+    int value = std::stoi(data);
+    if (received > 0)
+    {
+      EXPECT_EQ(static_cast<uint64_t>(value - last - 1), lost);
+    }
+    EXPECT_EQ(value % 100 == 0, keyframe);
+    last = value;
+    ++received;
+  }
+
+  int status{0};
+  waitpid(pid, &status, 0);
+  EXPECT_EQ(0, status);
+  EXPECT_LT(0, received);
+#endif
+}
@@ -24,6 +24,7 @@
 #include "ignition/common/Profiler.hh"
 #include "ignition/gazebo/components/Model.hh"
 #include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/ParentEntity.hh"
 #include "ignition/gazebo/components/Sensor.hh"
 #include "ignition/gazebo/components/Visual.hh"
 #include "ignition/gazebo/components/World.hh"
@@ -41,6 +42,143 @@ using namespace gazebo;
 
 using StringSet = std::unordered_set<std::string>;
 
+namespace
+{
+/// \brief Group the systems implementing an update phase into stages.
+/// Two systems conflict if either of them didn't declare its component
+/// access, or if one of them writes a component type the other one accesses.
+/// Each system is placed in the stage after the last one holding a
+/// conflicting system loaded before it, so conflicting systems keep their
+/// load order and systems within a stage don't conflict.
+/// \param[in] _systems All systems, in load order.
+/// \param[in] _phase Member of SystemInternal pointing to the phase's
+/// interface.
+/// \return Stages of systems.
+template<typename SystemT>
+std::vector<std::vector<SystemT *>> ScheduleStages(
+    const std::vector<SystemInternal> &_systems,
+    SystemT *SystemInternal::*_phase)
+{
+  struct Access
+  {
+    SystemT *system;
+    bool declared;
+    std::unordered_set<ComponentTypeId> reads;
+    std::unordered_set<ComponentTypeId> writes;
+  };
+
+  std::vector<Access> access;
+  for (const auto &system : _systems)
+  {
+    if (nullptr == system.*_phase)
+      continue;
+
+    Access entry{system.*_phase, nullptr != system.componentAccess, {}, {}};
+    if (entry.declared)
+    {
+      entry.reads = system.componentAccess->ReadComponents();
+      entry.writes = system.componentAccess->WriteComponents();
+    }
+    access.push_back(std::move(entry));
+  }
+
+  auto writesAny = [](const Access &_a,
+      const std::unordered_set<ComponentTypeId> &_types)
+  {
+    for (const auto &type : _types)
+    {
+      if (_a.writes.count(type) > 0)
+        return true;
+    }
+    return false;
+  };
+
+  auto conflict = [&](const Access &_a, const Access &_b)
+  {
+    return !_a.declared || !_b.declared ||
+        writesAny(_a, _b.reads) || writesAny(_a, _b.writes) ||
+        writesAny(_b, _a.reads);
+  };
+
+  std::vector<std::vector<SystemT *>> stages;
+  std::vector<size_t> stageOf(access.size(), 0);
+  for (size_t j = 0; j < access.size(); ++j)
+  {
+    for (size_t i = 0; i < j; ++i)
+    {
+      if (conflict(access[i], access[j]))
+        stageOf[j] = std::max(stageOf[j], stageOf[i] + 1);
+    }
+
+    if (stageOf[j] >= stages.size())
+      stages.resize(stageOf[j] + 1);
+    stages[stageOf[j]].push_back(access[j].system);
+  }
+
+  return stages;
+}
+
+/// \brief Get the component access of the systems implementing an update
+/// phase which declared it.
+/// \param[in] _systems All systems, in load order.
+/// \param[in] _phase Member of SystemInternal pointing to the phase's
+/// interface.
+/// \return Component access interfaces.
+template<typename SystemT>
+std::vector<ISystemComponentAccess *> PhaseAccess(
+    const std::vector<SystemInternal> &_systems,
+    SystemT *SystemInternal::*_phase)
+{
+  std::vector<ISystemComponentAccess *> access;
+  for (const auto &system : _systems)
+  {
+    if (nullptr != system.*_phase && nullptr != system.componentAccess)
+      access.push_back(system.componentAccess);
+  }
+  return access;
+}
+
+/// \brief Check whether any system of an update phase needs exclusive
+/// access to the ECM. Every system is asked, so that all of them can
+/// prepare for the phase.
+/// \param[in] _access Component access of the phase's systems.
+/// \param[in] _ecm Entity component manager.
+/// \return True if the phase's systems must be run one at a time.
+bool NeedsExclusiveAccess(const std::vector<ISystemComponentAccess *> &_access,
+    const EntityComponentManager &_ecm)
+{
+  bool exclusive{false};
+  for (auto *access : _access)
+    exclusive = access->NeedsExclusiveAccess(_ecm) || exclusive;
+  return exclusive;
+}
+
+/// \brief Run stages of systems, one after another. Systems within a stage
+/// are run concurrently on the thread pool.
+/// \param[in] _pool Thread pool.
+/// \param[in] _stages Stages of systems.
+/// \param[in] _f Function which runs a single system.
+template<typename SystemT, typename FunctionT>
+void RunStages(ThreadPool &_pool,
+    const std::vector<std::vector<SystemT *>> &_stages, const FunctionT &_f)
+{
+  for (const auto &stage : _stages)
+  {
+    if (stage.size() == 1)
+    {
+      _f(stage.front());
+      continue;
+    }
+
+    std::vector<std::function<void()>> tasks;
+    tasks.reserve(stage.size());
+    for (auto *system : stage)
+      tasks.push_back([&_f, system]{_f(system);});
+    _pool.Run(std::move(tasks));
+  }
+}
+}
+
 
 //////////////////////////////////////////////////
 SimulationRunner::SimulationRunner(const sdf::World *_world,
@@ -116,6 +254,14 @@ SimulationRunner::SimulationRunner(const sdf::World *_world,
       std::bind(&SimulationRunner::LoadPlugins, this, std::placeholders::_1,
       std::placeholders::_2));
 
+  // Worker threads shared by the ECM's parallel iteration
+  this->threadPool = std::make_shared<ThreadPool>(_config.WorkerThreads());
+  this->entityCompMgr.SetThreadPool(this->threadPool);
+
+  // Most lookups by value are by name or by parent
+  this->entityCompMgr.EnableComponentIndex<components::Name>();
+  this->entityCompMgr.EnableComponentIndex<components::ParentEntity>();
+
   // Create the level manager
   this->levelMgr = std::make_unique<LevelManager>(this, _config.UseLevels());
 
@@ -137,7 +283,8 @@ SimulationRunner::SimulationRunner(const sdf::World *_world,
           std::bind(&SimulationRunner::Step, this, std::placeholders::_1),
           this->entityCompMgr, &this->eventMgr,
           NetworkConfig::FromValues(
-            _config.NetworkRole(), _config.NetworkSecondaries()));
+            _config.NetworkRole(), _config.NetworkSecondaries(),
+            _config.NetworkMaxStaleness()));
     }
 
     if (this->networkMgr)
@@ -227,10 +374,7 @@ SimulationRunner::SimulationRunner(const sdf::World *_world,
 }
 
 //////////////////////////////////////////////////
-SimulationRunner::~SimulationRunner()
-{
-  this->StopWorkerThreads();
-}
+SimulationRunner::~SimulationRunner() = default;
 
 /////////////////////////////////////////////////
 void SimulationRunner::UpdateCurrentInfo()
@@ -496,55 +640,31 @@ void SimulationRunner::ProcessSystemQueue()
   std::lock_guard<std::mutex> lock(this->pendingSystemsMutex);
   auto pending = this->pendingSystems.size();
 
-  if (pending > 0)
-  {
-    // If additional systems are to be added, stop the existing threads.
-    this->StopWorkerThreads();
-  }
-
   for (const auto &system : this->pendingSystems)
   {
     this->AddSystemToRunner(system);
   }
   this->pendingSystems.clear();
 
-  // If additional systems were added, recreate the worker threads.
   if (pending > 0)
   {
-    igndbg << "Creating PostUpdate worker threads: "
-      << this->systemsPostupdate.size() + 1 << std::endl;
-
-    this->postUpdateStartBarrier =
-      std::make_unique<Barrier>(this->systemsPostupdate.size() + 1u);
-    this->postUpdateStopBarrier =
-      std::make_unique<Barrier>(this->systemsPostupdate.size() + 1u);
-
-    this->postUpdateThreadsRunning = true;
-    int id = 0;
-
-    for (auto &system : this->systemsPostupdate)
-    {
-      igndbg << "Creating postupdate worker thread (" << id << ")" << std::endl;
-
-      this->postUpdateThreads.push_back(std::thread([&, id]()
-      {
-        std::stringstream ss;
-        ss << "PostUpdateThread: " << id;
-        IGN_PROFILE_THREAD_NAME(ss.str().c_str());
-        while (this->postUpdateThreadsRunning)
-        {
-          this->postUpdateStartBarrier->Wait();
-          if (this->postUpdateThreadsRunning)
-          {
-            system->PostUpdate(this->currentInfo, this->entityCompMgr);
-          }
-          this->postUpdateStopBarrier->Wait();
-        }
-        igndbg << "Exiting postupdate worker thread ("
-          << id << ")" << std::endl;
-      }));
-      id++;
-    }
+    this->preUpdateStages =
+        ScheduleStages(this->systems, &SystemInternal::preupdate);
+    this->updateStages =
+        ScheduleStages(this->systems, &SystemInternal::update);
+    this->preUpdateAccess =
+        PhaseAccess(this->systems, &SystemInternal::preupdate);
+    this->updateAccess = PhaseAccess(this->systems, &SystemInternal::update);
+
+    igndbg << "Scheduled [" << this->systemsPreupdate.size()
+           << "] PreUpdate systems in [" << this->preUpdateStages.size()
+           << "] stages and [" << this->systemsUpdate.size()
+           << "] Update systems in [" << this->updateStages.size()
+           << "] stages." << std::endl;
+
+    std::lock_guard<std::mutex> durationsLock(this->postUpdateDurationsMutex);
+    this->postUpdateDurations.assign(this->systemsPostupdate.size(),
+        std::chrono::steady_clock::duration::zero());
   }
 }
 
@@ -552,33 +672,75 @@ void SimulationRunner::ProcessSystemQueue()
 void SimulationRunner::UpdateSystems()
 {
   IGN_PROFILE("SimulationRunner::UpdateSystems");
-  // \todo(nkoenig)  Systems used to be updated in parallel using
-  // an ignition::common::WorkerPool. There is overhead associated with
-  // this, most notably the creation and destruction of WorkOrders (see
-  // WorkerPool.cc). We could turn on parallel updates in the future, and/or
-  // turn it on if there are sufficient systems. More testing is required.
+  // Systems that declare their component access and don't conflict are
+  // updated concurrently on the persistent thread pool, see
+  // ISystemComponentAccess. All others are updated one at a time.
+
+  // Drop world poses cached during the previous phase, in case poses were
+  // modified without being marked as changed.
+  this->entityCompMgr.InvalidateWorldPoses();
 
   {
     IGN_PROFILE("PreUpdate");
-    for (auto& system : this->systemsPreupdate)
-      system->PreUpdate(this->currentInfo, this->entityCompMgr);
+    auto preUpdate = [this](ISystemPreUpdate *_system)
+    {
+      _system->PreUpdate(this->currentInfo, this->entityCompMgr);
+    };
+    if (NeedsExclusiveAccess(this->preUpdateAccess, this->entityCompMgr))
+    {
+      for (auto *system : this->systemsPreupdate)
+        preUpdate(system);
+    }
+    else
+    {
+      RunStages(*this->threadPool, this->preUpdateStages, preUpdate);
+    }
   }
 
   {
     IGN_PROFILE("Update");
-    for (auto& system : this->systemsUpdate)
-      system->Update(this->currentInfo, this->entityCompMgr);
+    auto update = [this](ISystemUpdate *_system)
+    {
+      _system->Update(this->currentInfo, this->entityCompMgr);
+    };
+    if (NeedsExclusiveAccess(this->updateAccess, this->entityCompMgr))
+    {
+      for (auto *system : this->systemsUpdate)
+        update(system);
+    }
+    else
+    {
+      RunStages(*this->threadPool, this->updateStages, update);
+    }
   }
 
+  this->entityCompMgr.InvalidateWorldPoses();
+
   {
     IGN_PROFILE("PostUpdate");
-    // If no systems implementing PostUpdate have been added, then
-    // the barriers will be uninitialized, so guard against that condition.
-    if (this->postUpdateStartBarrier && this->postUpdateStopBarrier)
+    // PostUpdate systems only have read access to the ECM, so they can all
+    // run concurrently. This thread takes part in the work and returns once
+    // all of them are done. A system waiting on the pool, for example while
+    // serializing state, only helps with its own tasks, so each duration
+    // only covers the work of its system.
+    std::vector<std::chrono::steady_clock::duration> durations(
+        this->systemsPostupdate.size());
+    std::vector<std::function<void()>> tasks;
+    tasks.reserve(this->systemsPostupdate.size());
+    for (size_t i = 0; i < this->systemsPostupdate.size(); ++i)
     {
-      this->postUpdateStartBarrier->Wait();
-      this->postUpdateStopBarrier->Wait();
+      tasks.push_back([this, i, &durations]
+      {
+        auto start = std::chrono::steady_clock::now();
+        this->systemsPostupdate[i]->PostUpdate(this->currentInfo,
+            this->entityCompMgr);
+        durations[i] = std::chrono::steady_clock::now() - start;
+      });
     }
+    this->threadPool->Run(std::move(tasks));
+
+    std::lock_guard<std::mutex> lock(this->postUpdateDurationsMutex);
+    this->postUpdateDurations = std::move(durations);
   }
 }
 
@@ -595,25 +757,6 @@ void SimulationRunner::OnStop()
   this->running = false;
 }
 
-/////////////////////////////////////////////////
-void SimulationRunner::StopWorkerThreads()
-{
-  this->postUpdateThreadsRunning = false;
-  if (this->postUpdateStartBarrier)
-  {
-    this->postUpdateStartBarrier->Cancel();
-  }
-  if (this->postUpdateStopBarrier)
-  {
-    this->postUpdateStopBarrier->Cancel();
-  }
-  for (auto &thread : this->postUpdateThreads)
-  {
-    thread.join();
-  }
-  this->postUpdateThreads.clear();
-}
-
 /////////////////////////////////////////////////
 bool SimulationRunner::Run(const uint64_t _iterations)
 {
@@ -1042,6 +1185,14 @@ size_t SimulationRunner::EntityCount() const
   return this->entityCompMgr.EntityCount();
 }
 
+/////////////////////////////////////////////////
+std::vector<std::chrono::steady_clock::duration>
+    SimulationRunner::PostUpdateDurations() const
+{
+  std::lock_guard<std::mutex> lock(this->postUpdateDurationsMutex);
+  return this->postUpdateDurations;
+}
+
 /////////////////////////////////////////////////
 size_t SimulationRunner::SystemCount() const
 {
@@ -1049,6 +1200,18 @@ size_t SimulationRunner::SystemCount() const
   return this->systems.size() + this->pendingSystems.size();
 }
 
+/////////////////////////////////////////////////
+size_t SimulationRunner::PreUpdateStageCount() const
+{
+  return this->preUpdateStages.size();
+}
+
+/////////////////////////////////////////////////
+size_t SimulationRunner::UpdateStageCount() const
+{
+  return this->updateStages.size();
+}
+
 /////////////////////////////////////////////////
 void SimulationRunner::SetUpdatePeriod(
     const std::chrono::steady_clock::duration &_updatePeriod)
@@ -53,7 +53,7 @@
 
 #include "network/NetworkManager.hh"
 #include "LevelManager.hh"
-#include "Barrier.hh"
+#include "ThreadPool.hh"
 
 using namespace std::chrono_literals;
 
@@ -105,7 +105,9 @@ namespace ignition
                 configure(systemPlugin->QueryInterface<ISystemConfigure>()),
                 preupdate(systemPlugin->QueryInterface<ISystemPreUpdate>()),
                 update(systemPlugin->QueryInterface<ISystemUpdate>()),
-                postupdate(systemPlugin->QueryInterface<ISystemPostUpdate>())
+                postupdate(systemPlugin->QueryInterface<ISystemPostUpdate>()),
+                componentAccess(
+                    systemPlugin->QueryInterface<ISystemComponentAccess>())
       {
       }
 
@@ -117,7 +119,9 @@ namespace ignition
                 configure(dynamic_cast<ISystemConfigure *>(_system.get())),
                 preupdate(dynamic_cast<ISystemPreUpdate *>(_system.get())),
                 update(dynamic_cast<ISystemUpdate *>(_system.get())),
-                postupdate(dynamic_cast<ISystemPostUpdate *>(_system.get()))
+                postupdate(dynamic_cast<ISystemPostUpdate *>(_system.get())),
+                componentAccess(
+                    dynamic_cast<ISystemComponentAccess *>(_system.get()))
       {
       }
 
@@ -149,6 +153,10 @@ namespace ignition
       /// Will be nullptr if the System doesn't implement this interface.
       public: ISystemPostUpdate *postupdate = nullptr;
 
+      /// \brief Access this system via the ISystemComponentAccess interface
+      /// Will be nullptr if the System doesn't implement this interface.
+      public: ISystemComponentAccess *componentAccess = nullptr;
+
       /// \brief Vector of queries and callbacks
       public: std::vector<EntityQueryCallback> updates;
     };
@@ -172,9 +180,6 @@ namespace ignition
       /// \brief Internal method for handling stop event (to prevent recursion)
       private: void OnStop();
 
-      /// \brief Stop and join all post update worker threads
-      private: void StopWorkerThreads();
-
       /// \brief Run the simulationrunner.
       /// \param[in] _iterations Number of iterations.
       /// \return True if the operation completed successfully.
@@ -272,6 +277,23 @@ namespace ignition
       /// \return System count.
       public: size_t SystemCount() const;
 
+      /// \brief Get the number of stages PreUpdate systems are grouped into.
+      /// Systems are only grouped once the runner has run.
+      /// \return Stage count.
+      public: size_t PreUpdateStageCount() const;
+
+      /// \brief Get the number of stages Update systems are grouped into.
+      /// Systems are only grouped once the runner has run.
+      /// \return Stage count.
+      public: size_t UpdateStageCount() const;
+
+      /// \brief Get the wall-clock time each system implementing PostUpdate
+      /// took on the latest iteration.
+      /// \return One duration per PostUpdate system, in the order the
+      /// systems were loaded.
+      public: std::vector<std::chrono::steady_clock::duration>
+          PostUpdateDurations() const;
+
       /// \brief Set the update period. The update period is the wall-clock
       /// time between updates of all systems. Note that even if systems
       /// are being updated, this doesn't mean sim time is increasing.
@@ -472,6 +494,21 @@ namespace ignition
       /// \brief Systems implementing PostUpdate
       private: std::vector<ISystemPostUpdate *> systemsPostupdate;
 
+      /// \brief Systems implementing PreUpdate, grouped into stages which
+      /// are run in order. Systems within a stage may run concurrently.
+      private: std::vector<std::vector<ISystemPreUpdate *>> preUpdateStages;
+
+      /// \brief Systems implementing Update, grouped into stages which are
+      /// run in order. Systems within a stage may run concurrently.
+      private: std::vector<std::vector<ISystemUpdate *>> updateStages;
+
+      /// \brief Component access of the PreUpdate systems which declared
+      /// it, see ISystemComponentAccess::NeedsExclusiveAccess.
+      private: std::vector<ISystemComponentAccess *> preUpdateAccess;
+
+      /// \brief Component access of the Update systems which declared it.
+      private: std::vector<ISystemComponentAccess *> updateAccess;
+
       /// \brief Manager of all events.
       private: EventManager eventMgr;
 
@@ -487,6 +524,10 @@ namespace ignition
       /// \brief A pool of worker threads.
       private: common::WorkerPool workerPool{2};
 
+      /// \brief Persistent work-stealing thread pool, used by the ECM for
+      /// EntityComponentManager::EachParallel.
+      private: std::shared_ptr<ThreadPool> threadPool;
+
       /// \brief Wall time of the previous update.
       private: std::chrono::steady_clock::time_point prevUpdateRealTime;
 
@@ -583,17 +624,13 @@ namespace ignition
       /// \brief Copy of the server configuration.
       public: ServerConfig serverConfig;
 
-      /// \brief Collection of threads running system PostUpdates
-      private: std::vector<std::thread> postUpdateThreads;
-
-      /// \brief Flag to indicate running status of PostUpdate threads
-      private: std::atomic<bool> postUpdateThreadsRunning{false};
-
-      /// \brief Barrier to signal beginning of PostUpdate thread execution
-      private: std::unique_ptr<Barrier> postUpdateStartBarrier;
+      /// \brief Time taken by each PostUpdate system on the latest
+      /// iteration, in the same order as systemsPostupdate.
+      private: std::vector<std::chrono::steady_clock::duration>
+          postUpdateDurations;
 
-      /// \brief Barrier to signal end of PostUpdate thread execution
-      private: std::unique_ptr<Barrier> postUpdateStopBarrier;
+      /// \brief Protects postUpdateDurations.
+      private: mutable std::mutex postUpdateDurationsMutex;
 
       /// \brief Map from file paths to Fuel URIs.
       private: std::unordered_map<std::string, std::string> fuelUriMap;
@@ -16,6 +16,13 @@
 */
 
 #include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
 #include <tinyxml2.h>
 
 #include <ignition/common/Console.hh>
@@ -1504,6 +1511,126 @@ TEST_P(SimulationRunnerTest, LoadPluginsEvent)
       componentId)) << componentId;
 }
 
+/////////////////////////////////////////////////
+/// \brief System which only reads names during PreUpdate and Update.
+class NameReaderSystem :
+  public System,
+  public ISystemPreUpdate,
+  public ISystemUpdate,
+  public ISystemComponentAccess
+{
+  public: void PreUpdate(const UpdateInfo &,
+      EntityComponentManager &) override
+  {
+  }
+
+  public: void Update(const UpdateInfo &, EntityComponentManager &) override
+  {
+  }
+
+  public: std::unordered_set<ComponentTypeId> ReadComponents() const override
+  {
+    return {components::Name::typeId};
+  }
+
+  public: std::unordered_set<ComponentTypeId> WriteComponents() const override
+  {
+    return {};
+  }
+};
+
+/////////////////////////////////////////////////
+TEST_P(SimulationRunnerTest, DefaultSystemsComponentAccess)
+{
+  sdf::Root rootWithout;
+  rootWithout.Load(common::joinPaths(PROJECT_SOURCE_PATH,
+      "test", "worlds", "plugins_empty.sdf"));
+  ASSERT_EQ(1u, rootWithout.WorldCount());
+
+  // Physics, user commands and scene broadcaster
+  auto config = common::joinPaths(PROJECT_SOURCE_PATH,
+    "include", "ignition", "gazebo", "server.config");
+  ASSERT_TRUE(common::setenv(gazebo::kServerConfigPathEnv, config));
+
+  auto systemLoader = std::make_shared<SystemLoader>();
+  SimulationRunner runner(rootWithout.WorldByIndex(0), systemLoader);
+  ASSERT_EQ(3u, runner.SystemCount());
+  common::unsetenv(gazebo::kServerConfigPathEnv);
+
+  runner.AddSystem(std::make_shared<NameReaderSystem>());
+
+  runner.SetPaused(false);
+  EXPECT_TRUE(runner.Run(10));
+
+  // The default systems declare their component access, so a system which
+  // doesn't conflict with them shares their stages instead of waiting for
+  // them.
+  EXPECT_EQ(1u, runner.PreUpdateStageCount());
+  EXPECT_EQ(1u, runner.UpdateStageCount());
+}
+
+/////////////////////////////////////////////////
+/// \brief System which sleeps on PostUpdate.
+class SleepSystem : public System, public ISystemPostUpdate
+{
+  public: explicit SleepSystem(std::chrono::milliseconds _duration)
+    : duration(_duration)
+  {
+  }
+
+  public: void PostUpdate(const UpdateInfo &,
+      const EntityComponentManager &) override
+  {
+    std::this_thread::sleep_for(this->duration);
+    ++this->calls;
+  }
+
+  public: std::chrono::milliseconds duration;
+
+  public: std::atomic<int> calls{0};
+};
+
+/////////////////////////////////////////////////
+TEST_P(SimulationRunnerTest, PostUpdateDurations)
+{
+  // Load SDF file
+  sdf::Root root;
+  root.Load(common::joinPaths(PROJECT_SOURCE_PATH,
+      "test", "worlds", "shapes.sdf"));
+
+  ASSERT_EQ(1u, root.WorldCount());
+
+  // Create simulation runner
+  auto systemLoader = std::make_shared<SystemLoader>();
+  SimulationRunner runner(root.WorldByIndex(0), systemLoader);
+  EXPECT_TRUE(runner.PostUpdateDurations().empty());
+
+  std::vector<std::shared_ptr<SleepSystem>> systems;
+  for (int i = 0; i < 8; ++i)
+  {
+    systems.push_back(std::make_shared<SleepSystem>(
+        std::chrono::milliseconds(i % 2 == 0 ? 0 : 20)));
+    runner.AddSystem(systems.back());
+  }
+
+  runner.SetPaused(false);
+  EXPECT_TRUE(runner.Run(5));
+
+  // Other systems may have been loaded by default
+  auto durations = runner.PostUpdateDurations();
+  ASSERT_LE(systems.size(), durations.size());
+
+  auto offset = durations.size() - systems.size();
+  for (size_t i = 0; i < systems.size(); ++i)
+  {
+    EXPECT_EQ(5, systems[i]->calls);
+    if (i % 2 != 0)
+      EXPECT_LE(systems[i]->duration, durations[offset + i]) << i;
+    else
+      EXPECT_GT(systems[1]->duration, durations[offset + i]) << i;
+  }
+}
+
 /////////////////////////////////////////////////
 TEST_P(SimulationRunnerTest, GuiInfo)
 {
@@ -17,6 +17,7 @@
 
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 
 #include <ignition/gazebo/SystemLoader.hh>
@@ -41,23 +42,46 @@ class ignition::gazebo::SystemLoaderPrivate
   public: explicit SystemLoaderPrivate() = default;
 
   //////////////////////////////////////////////////
-  public: bool InstantiateSystemPlugin(const std::string &_filename,
-              const std::string &_name,
-              const sdf::ElementPtr &/*_sdf*/,
-              ignition::plugin::PluginPtr &_plugin)
+  public: std::string FindSharedLibrary(const std::string &_filename)
   {
+    // Resolved paths are only valid for the search paths they were found in
+    std::string envPaths;
+    ignition::common::env(this->pluginPathEnv, envPaths);
+    std::string homePath;
+    ignition::common::env(IGN_HOMEDIR, homePath);
+    if (envPaths != this->cachedEnvPaths || homePath != this->cachedHomePath)
+    {
+      this->libraryPaths.clear();
+      this->cachedEnvPaths = envPaths;
+      this->cachedHomePath = homePath;
+    }
+
+    auto it = this->libraryPaths.find(_filename);
+    if (it != this->libraryPaths.end())
+      return it->second;
+
     ignition::common::SystemPaths systemPaths;
     systemPaths.SetPluginPathEnv(pluginPathEnv);
 
     for (const auto &path : this->systemPluginPaths)
       systemPaths.AddPluginPaths(path);
 
-    std::string homePath;
-    ignition::common::env(IGN_HOMEDIR, homePath);
     systemPaths.AddPluginPaths(homePath + "/.ignition/gazebo/plugins");
     systemPaths.AddPluginPaths(IGN_GAZEBO_PLUGIN_INSTALL_DIR);
 
     auto pathToLib = systemPaths.FindSharedLibrary(_filename);
+    if (!pathToLib.empty())
+      this->libraryPaths[_filename] = pathToLib;
+    return pathToLib;
+  }
+
+  //////////////////////////////////////////////////
+  public: bool InstantiateSystemPlugin(const std::string &_filename,
+              const std::string &_name,
+              const sdf::ElementPtr &/*_sdf*/,
+              ignition::plugin::PluginPtr &_plugin)
+  {
+    auto pathToLib = this->FindSharedLibrary(_filename);
     if (pathToLib.empty())
     {
       // We assume ignition::gazebo corresponds to the levels feature
@@ -69,22 +93,29 @@ class ignition::gazebo::SystemLoaderPrivate
       return false;
     }
 
-    auto pluginNames = this->loader.LoadLib(pathToLib);
-    if (pluginNames.empty())
+    // Libraries only need to be loaded once, further instances of their
+    // plugins are created by the loader's factories.
+    if (this->loadedLibs.find(pathToLib) == this->loadedLibs.end())
     {
-      ignerr << "Failed to load system plugin [" << _filename <<
-                "] : couldn't load library on path [" << pathToLib <<
-                "]." << std::endl;
-      return false;
-    }
+      auto pluginNames = this->loader.LoadLib(pathToLib);
+      if (pluginNames.empty())
+      {
+        ignerr << "Failed to load system plugin [" << _filename <<
+                  "] : couldn't load library on path [" << pathToLib <<
+                  "]." << std::endl;
+        return false;
+      }
 
-    auto pluginName = *pluginNames.begin();
-    if (pluginName.empty())
-    {
-      ignerr << "Failed to load system plugin [" << _filename <<
-                "] : couldn't load library on path [" << pathToLib <<
-                "]." << std::endl;
-      return false;
+      auto pluginName = *pluginNames.begin();
+      if (pluginName.empty())
+      {
+        ignerr << "Failed to load system plugin [" << _filename <<
+                  "] : couldn't load library on path [" << pathToLib <<
+                  "]." << std::endl;
+        return false;
+      }
+
+      this->loadedLibs.insert(pathToLib);
     }
 
     _plugin = this->loader.Instantiate(_name);
@@ -120,6 +151,20 @@ class ignition::gazebo::SystemLoaderPrivate
 
   /// \brief System plugins that have instances loaded via the manager.
   public: std::unordered_set<SystemPluginPtr> systemPluginsAdded;
+
+  /// \brief Resolved library paths, keyed by plugin filename. Cleared when
+  /// the search paths change.
+  public: std::unordered_map<std::string, std::string> libraryPaths;
+
+  /// \brief Value of the plugin path environment variable when the library
+  /// paths were resolved.
+  public: std::string cachedEnvPaths;
+
+  /// \brief Home directory when the library paths were resolved.
+  public: std::string cachedHomePath;
+
+  /// \brief Paths of the libraries already loaded into the loader.
+  public: std::unordered_set<std::string> loadedLibs;
 };
 
 //////////////////////////////////////////////////
@@ -134,7 +179,9 @@ SystemLoader::~SystemLoader() = default;
 //////////////////////////////////////////////////
 void SystemLoader::AddSystemPluginPath(const std::string &_path)
 {
-  this->dataPtr->systemPluginPaths.insert(_path);
+  // A new path may take precedence over the resolved ones
+  if (this->dataPtr->systemPluginPaths.insert(_path).second)
+    this->dataPtr->libraryPaths.clear();
 }
 
 //////////////////////////////////////////////////
@@ -21,6 +21,7 @@
 #include <sdf/World.hh>
 
 #include <ignition/common/Filesystem.hh>
+#include <ignition/common/Util.hh>
 #include "ignition/gazebo/System.hh"
 #include "ignition/gazebo/SystemLoader.hh"
 
@@ -65,3 +66,94 @@ TEST(SystemLoader, EmptyNames)
   auto system = sm.LoadPlugin("", "", element);
   ASSERT_FALSE(system.has_value());
 }
+
+/////////////////////////////////////////////////
+TEST(SystemLoader, Instances)
+{
+  gazebo::SystemLoader sm;
+
+  auto testBuildPath = ignition::common::joinPaths(
+      std::string(PROJECT_BINARY_PATH), "lib");
+  sm.AddSystemPluginPath(testBuildPath);
+
+  // Every call creates a new instance
+  const std::string filename = std::string("libignition-gazebo") +
+      IGNITION_GAZEBO_MAJOR_VERSION_STR + "-physics-system.so";
+  sdf::ElementPtr element;
+  auto first = sm.LoadPlugin(filename,
+      "ignition::gazebo::systems::Physics", element);
+  ASSERT_TRUE(first.has_value());
+  auto second = sm.LoadPlugin(filename,
+      "ignition::gazebo::systems::Physics", element);
+  ASSERT_TRUE(second.has_value());
+
+  EXPECT_NE(first.value()->QueryInterface<gazebo::System>(),
+      second.value()->QueryInterface<gazebo::System>());
+
+  // Unknown plugins in a cached library still fail
+  EXPECT_FALSE(sm.LoadPlugin(filename, "ignition::gazebo::systems::Unknown",
+      element).has_value());
+}
+
+/////////////////////////////////////////////////
+TEST(SystemLoader, PathCache)
+{
+  // Copy a plugin library under a name which isn't found anywhere else
+  const auto libPath = ignition::common::joinPaths(
+      std::string(PROJECT_BINARY_PATH), "lib",
+      std::string("libignition-gazebo") + IGNITION_GAZEBO_MAJOR_VERSION_STR +
+      "-physics-system.so");
+  const auto cacheDir = ignition::common::joinPaths(
+      std::string(PROJECT_BINARY_PATH), "test", "system_loader_cache");
+  const auto dirA = ignition::common::joinPaths(cacheDir, "a");
+  const auto dirB = ignition::common::joinPaths(cacheDir, "b");
+  ASSERT_TRUE(ignition::common::createDirectories(dirA));
+  ASSERT_TRUE(ignition::common::createDirectories(dirB));
+
+  const std::string filename{"libtest-cached-physics-system.so"};
+  const auto libA = ignition::common::joinPaths(dirA, filename);
+  const auto libB = ignition::common::joinPaths(dirB, filename);
+  ASSERT_TRUE(ignition::common::copyFile(libPath, libA));
+
+  const std::string name{"ignition::gazebo::systems::Physics"};
+  sdf::ElementPtr element;
+
+  gazebo::SystemLoader sm;
+  sm.AddSystemPluginPath(dirA);
+  EXPECT_TRUE(sm.LoadPlugin(filename, name, element).has_value());
+
+  // The resolved path is cached, so the library isn't searched for again
+  ASSERT_TRUE(ignition::common::removeFile(libA));
+  EXPECT_TRUE(sm.LoadPlugin(filename, name, element).has_value());
+
+  // Changing the plugin path environment variable clears the cache
+  std::string envOrig;
+  bool envSet = ignition::common::env("IGN_GAZEBO_SYSTEM_PLUGIN_PATH",
+      envOrig);
+  ASSERT_TRUE(ignition::common::setenv("IGN_GAZEBO_SYSTEM_PLUGIN_PATH",
+      cacheDir.c_str()));
+  EXPECT_FALSE(sm.LoadPlugin(filename, name, element).has_value());
+
+  if (envSet)
+  {
+    EXPECT_TRUE(ignition::common::setenv("IGN_GAZEBO_SYSTEM_PLUGIN_PATH",
+        envOrig.c_str()));
+  }
+  else
+  {
+    EXPECT_TRUE(ignition::common::unsetenv("IGN_GAZEBO_SYSTEM_PLUGIN_PATH"));
+  }
+
+  // Adding a search path clears the cache too
+  ASSERT_TRUE(ignition::common::copyFile(libPath, libB));
+  sm.AddSystemPluginPath(dirB);
+  EXPECT_TRUE(sm.LoadPlugin(filename, name, element).has_value());
+
+  ASSERT_TRUE(ignition::common::removeFile(libB));
+  EXPECT_TRUE(sm.LoadPlugin(filename, name, element).has_value());
+
+  sm.AddSystemPluginPath(cacheDir);
+  EXPECT_FALSE(sm.LoadPlugin(filename, name, element).has_value());
+
+  ignition::common::removeAll(cacheDir);
+}
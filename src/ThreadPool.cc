@@ -0,0 +1,356 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ThreadPool.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+using namespace ignition::gazebo;
+
+class ignition::gazebo::ThreadPoolPrivate
+{
+  /// \brief A queued task.
+  public: struct Task
+  {
+    /// \brief Function to execute.
+    std::function<void()> function;
+
+    /// \brief Group passed to Run() which the task belongs to, null for
+    /// tasks passed to Submit().
+    const void *group{nullptr};
+  };
+
+  /// \brief Task queue owned by a single worker.
+  public: struct Queue
+  {
+    /// \brief Protects tasks.
+    std::mutex mutex;
+
+    /// \brief Pending tasks. The owner pops from the back, thieves take
+    /// from the front.
+    std::deque<Task> tasks;
+  };
+
+  /// \brief Add a task to a queue and wake up a worker.
+  /// \param[in] _task Task to add.
+  /// \param[in] _group Group of the task, null if it has none.
+  public: void Push(std::function<void()> &&_task,
+      const void *_group = nullptr);
+
+  /// \brief Take a single task from any queue and execute it.
+  /// \param[in] _start Index of the first queue to look at.
+  /// \param[in] _own True if the queue at _start belongs to the calling
+  /// thread, in which case the most recent task is taken from it.
+  /// \param[in] _group Only take tasks of this group. Null takes any task.
+  /// \return True if a task was executed.
+  public: bool TryExecute(const std::size_t _start, const bool _own,
+      const void *_group = nullptr);
+
+  /// \brief Main loop of a worker thread.
+  /// \param[in] _index Index of the worker's queue.
+  public: void Worker(const std::size_t _index);
+
+  /// \brief One queue per worker.
+  public: std::vector<std::unique_ptr<Queue>> queues;
+
+  /// \brief Worker threads.
+  public: std::vector<std::thread> workers;
+
+  /// \brief Used to put idle workers to sleep.
+  public: std::mutex sleepMutex;
+
+  /// \brief Signaled when tasks are added or the pool is stopped.
+  public: std::condition_variable sleepCv;
+
+  /// \brief Number of queued tasks which haven't been taken yet. Only
+  /// incremented while holding sleepMutex, so that wake-ups aren't lost.
+  public: std::atomic<std::size_t> pending{0};
+
+  /// \brief Set when the pool is being destroyed. Guarded by sleepMutex.
+  public: bool stop{false};
+
+  /// \brief Queue which will receive the next external submission.
+  public: std::atomic<std::size_t> nextQueue{0};
+};
+
+namespace
+{
+/// \brief Pool which owns the current thread, if any.
+thread_local const ThreadPoolPrivate *tlPool{nullptr};
+
+/// \brief Queue index of the current thread within tlPool.
+thread_local std::size_t tlIndex{0};
+
+/// \brief Completion latch for a group of tasks passed to Run().
+struct TaskGroup
+{
+  /// \brief Protects remaining and cv.
+  std::mutex mutex;
+
+  /// \brief Signaled when remaining reaches zero.
+  std::condition_variable cv;
+
+  /// \brief Number of tasks not finished yet.
+  std::size_t remaining{0};
+};
+}
+
+//////////////////////////////////////////////////
+void ThreadPoolPrivate::Push(std::function<void()> &&_task,
+    const void *_group)
+{
+  std::size_t index;
+  if (tlPool == this)
+    index = tlIndex;
+  else
+    index = this->nextQueue++ % this->queues.size();
+
+  {
+    std::lock_guard<std::mutex> lock(this->sleepMutex);
+    ++this->pending;
+  }
+
+  {
+    auto &queue = *this->queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.push_back({std::move(_task), _group});
+  }
+
+  this->sleepCv.notify_one();
+}
+
+//////////////////////////////////////////////////
+bool ThreadPoolPrivate::TryExecute(const std::size_t _start, const bool _own,
+    const void *_group)
+{
+  auto matches = [_group](const Task &_task)
+  {
+    return _group == nullptr || _task.group == _group;
+  };
+
+  std::function<void()> task;
+  const std::size_t count = this->queues.size();
+  for (std::size_t i = 0; i < count && !task; ++i)
+  {
+    auto &queue = *this->queues[(_start + i) % count];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+      continue;
+
+    // Work on our own most recent task while it's still hot in the cache,
+    // steal the oldest tasks from others.
+    if (i == 0 && _own)
+    {
+      auto it = std::find_if(queue.tasks.rbegin(), queue.tasks.rend(),
+          matches);
+      if (it == queue.tasks.rend())
+        continue;
+      task = std::move(it->function);
+      queue.tasks.erase(std::next(it).base());
+    }
+    else
+    {
+      auto it = std::find_if(queue.tasks.begin(), queue.tasks.end(),
+          matches);
+      if (it == queue.tasks.end())
+        continue;
+      task = std::move(it->function);
+      queue.tasks.erase(it);
+    }
+  }
+
+  if (!task)
+    return false;
+
+  --this->pending;
+  task();
+  return true;
+}
+
+//////////////////////////////////////////////////
+void ThreadPoolPrivate::Worker(const std::size_t _index)
+{
+  tlPool = this;
+  tlIndex = _index;
+
+  while (true)
+  {
+    if (this->TryExecute(_index, true))
+      continue;
+
+    std::unique_lock<std::mutex> lock(this->sleepMutex);
+    this->sleepCv.wait(lock, [this]
+    {
+      return this->stop || this->pending > 0;
+    });
+
+    if (this->stop && this->pending == 0)
+      return;
+
+    // A task was counted but hasn't reached its queue yet.
+    lock.unlock();
+    std::this_thread::yield();
+  }
+}
+
+//////////////////////////////////////////////////
+ThreadPool::ThreadPool(unsigned int _threadCount)
+  : dataPtr(std::make_unique<ThreadPoolPrivate>())
+{
+  if (_threadCount == 0)
+    _threadCount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+
+  for (unsigned int i = 0; i < _threadCount; ++i)
+  {
+    this->dataPtr->queues.push_back(
+        std::make_unique<ThreadPoolPrivate::Queue>());
+  }
+
+  for (unsigned int i = 0; i < _threadCount; ++i)
+  {
+    this->dataPtr->workers.emplace_back(&ThreadPoolPrivate::Worker,
+        this->dataPtr.get(), i);
+  }
+}
+
+//////////////////////////////////////////////////
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->sleepMutex);
+    this->dataPtr->stop = true;
+  }
+  this->dataPtr->sleepCv.notify_all();
+
+  for (auto &worker : this->dataPtr->workers)
+    worker.join();
+}
+
+//////////////////////////////////////////////////
+unsigned int ThreadPool::ThreadCount() const
+{
+  return static_cast<unsigned int>(this->dataPtr->workers.size());
+}
+
+//////////////////////////////////////////////////
+void ThreadPool::Submit(std::function<void()> _task)
+{
+  if (this->dataPtr->workers.empty())
+  {
+    _task();
+    return;
+  }
+
+  this->dataPtr->Push(std::move(_task));
+}
+
+//////////////////////////////////////////////////
+void ThreadPool::Run(std::vector<std::function<void()>> &&_tasks)
+{
+  if (_tasks.empty())
+    return;
+
+  if (this->dataPtr->workers.empty() || _tasks.size() == 1)
+  {
+    for (auto &task : _tasks)
+      task();
+    return;
+  }
+
+  TaskGroup group;
+  group.remaining = _tasks.size();
+
+  for (auto &task : _tasks)
+  {
+    this->dataPtr->Push([&group, task = std::move(task)]
+    {
+      task();
+
+      // Notify while holding the lock, so the group outlives the
+      // notification.
+      std::lock_guard<std::mutex> lock(group.mutex);
+      if (--group.remaining == 0)
+        group.cv.notify_all();
+    }, &group);
+  }
+
+  const bool own = tlPool == this->dataPtr.get();
+  const std::size_t start = own ? tlIndex : 0;
+  while (true)
+  {
+    {
+      std::lock_guard<std::mutex> lock(group.mutex);
+      if (group.remaining == 0)
+        return;
+    }
+
+    // Help out with our own tasks instead of blocking. Unrelated tasks
+    // aren't taken, they could take much longer than the group and delay
+    // our caller. If there's nothing left to take, all our tasks are being
+    // executed by other threads.
+    if (!this->dataPtr->TryExecute(start, own, &group))
+    {
+      std::unique_lock<std::mutex> lock(group.mutex);
+      group.cv.wait(lock, [&group]
+      {
+        return group.remaining == 0;
+      });
+      return;
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+void ThreadPool::ParallelFor(const std::size_t _count,
+    const std::function<void(std::size_t, std::size_t)> &_f,
+    const std::size_t _grain)
+{
+  if (_count == 0)
+    return;
+
+  // A few chunks per thread give the work stealing something to balance.
+  const std::size_t grain = std::max<std::size_t>(1u, _grain);
+  const std::size_t maxChunks = (this->ThreadCount() + 1) * 4;
+  const std::size_t chunks =
+      std::min((_count + grain - 1) / grain, maxChunks);
+
+  if (chunks < 2)
+  {
+    _f(0, _count);
+    return;
+  }
+
+  const std::size_t chunkSize = (_count + chunks - 1) / chunks;
+  std::vector<std::function<void()>> tasks;
+  tasks.reserve(chunks);
+  for (std::size_t begin = 0; begin < _count; begin += chunkSize)
+  {
+    const std::size_t end = std::min(_count, begin + chunkSize);
+    tasks.push_back([&_f, begin, end]
+    {
+      _f(begin, end);
+    });
+  }
+
+  this->Run(std::move(tasks));
+}
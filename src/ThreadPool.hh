@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef IGNITION_GAZEBO_THREADPOOL_HH_
+#define IGNITION_GAZEBO_THREADPOOL_HH_
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations.
+    class ThreadPoolPrivate;
+
+    /// \class ThreadPool ThreadPool.hh
+    /// \brief Persistent pool of worker threads with work stealing.
+    ///
+    /// Each worker owns a task queue. Tasks submitted from a worker go to
+    /// that worker's queue, tasks submitted from other threads are
+    /// distributed round-robin. Idle workers steal from the other queues
+    /// before going to sleep.
+    ///
+    /// The blocking functions, Run() and ParallelFor(), make the calling
+    /// thread execute its own pending tasks while it waits. This means they
+    /// can be called from within a task running on the same pool without
+    /// deadlocking. Tasks of other callers are left to the workers.
+    class IGNITION_GAZEBO_VISIBLE ThreadPool
+    {
+      /// \brief Constructor
+      /// \param[in] _threadCount Number of worker threads. Zero uses one
+      /// worker less than the number of hardware threads, since the caller
+      /// of Run() and ParallelFor() also takes part in the work.
+      public: explicit ThreadPool(unsigned int _threadCount = 0);
+
+      /// \brief Destructor. Pending tasks are finished before the workers
+      /// are joined.
+      public: ~ThreadPool();
+
+      /// \brief Number of worker threads, not counting callers of Run().
+      /// \return Worker thread count.
+      public: unsigned int ThreadCount() const;
+
+      /// \brief Queue a task without waiting for it to finish.
+      /// \param[in] _task Task to execute.
+      public: void Submit(std::function<void()> _task);
+
+      /// \brief Execute a group of tasks and block until all of them are
+      /// done. The calling thread executes tasks of this group while
+      /// waiting.
+      /// \param[in] _tasks Tasks to execute. They may run in any order.
+      public: void Run(std::vector<std::function<void()>> &&_tasks);
+
+      /// \brief Split the range [0, _count) into chunks and process them
+      /// concurrently, blocking until all chunks are done.
+      /// \param[in] _count Number of items.
+      /// \param[in] _f Function called with a half-open range
+      /// [_begin, _end) of items. Ranges don't overlap.
+      /// \param[in] _grain Minimum number of items per chunk. Ranges with
+      /// fewer than two chunks are processed on the calling thread.
+      public: void ParallelFor(const std::size_t _count,
+          const std::function<void(std::size_t _begin, std::size_t _end)> &_f,
+          const std::size_t _grain = 1);
+
+      /// \brief Pointer to private data.
+      private: std::unique_ptr<ThreadPoolPrivate> dataPtr;
+    };
+    }  // namespace IGNITION_GAZEBO_VERSION_NAMESPACE
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_THREADPOOL_HH_
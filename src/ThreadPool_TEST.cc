@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ThreadPool.hh"
+
+using namespace ignition;
+
+/////////////////////////////////////////////////
+TEST(ThreadPool, Run)
+{
+  for (unsigned int threads : {1u, 2u, 4u, 8u})
+  {
+    gazebo::ThreadPool pool(threads);
+    EXPECT_EQ(threads, pool.ThreadCount());
+
+    std::atomic<int> sum{0};
+    std::vector<std::function<void()>> tasks;
+    for (int i = 1; i <= 100; ++i)
+      tasks.push_back([&sum, i]{sum += i;});
+
+    pool.Run(std::move(tasks));
+    EXPECT_EQ(5050, sum);
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(ThreadPool, ParallelFor)
+{
+  gazebo::ThreadPool pool(3);
+
+  for (std::size_t count : {0u, 1u, 7u, 1000u, 100000u})
+  {
+    std::vector<int> visits(count, 0);
+    pool.ParallelFor(count, [&visits](std::size_t _begin, std::size_t _end)
+    {
+      for (std::size_t i = _begin; i < _end; ++i)
+        ++visits[i];
+    }, 16);
+
+    for (std::size_t i = 0; i < count; ++i)
+      EXPECT_EQ(1, visits[i]) << i;
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(ThreadPool, Nested)
+{
+  // All workers block inside the outer tasks, the inner loops must still
+  // complete.
+  gazebo::ThreadPool pool(2);
+
+  std::atomic<int> count{0};
+  pool.ParallelFor(8, [&](std::size_t _begin, std::size_t _end)
+  {
+    for (std::size_t i = _begin; i < _end; ++i)
+    {
+      pool.ParallelFor(100, [&](std::size_t _b, std::size_t _e)
+      {
+        count += static_cast<int>(_e - _b);
+      });
+    }
+  });
+
+  EXPECT_EQ(800, count);
+}
+
+/////////////////////////////////////////////////
+TEST(ThreadPool, Submit)
+{
+  std::atomic<int> count{0};
+  {
+    gazebo::ThreadPool pool(2);
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    for (int i = 0; i < 10; ++i)
+    {
+      pool.Submit([&]
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++count;
+        cv.notify_one();
+      });
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&count]{return count == 10;});
+  }
+  EXPECT_EQ(10, count);
+
+  // Tasks left in the queues run before the pool is destroyed.
+  count = 0;
+  {
+    gazebo::ThreadPool pool(1);
+    for (int i = 0; i < 100; ++i)
+      pool.Submit([&count]{++count;});
+  }
+  EXPECT_EQ(100, count);
+}
+
+/////////////////////////////////////////////////
+TEST(ThreadPool, RunOnlyHelpsOwnGroup)
+{
+  gazebo::ThreadPool pool(1);
+
+  // Keep the only worker busy
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool release{false};
+  bool blocked{false};
+  pool.Submit([&]
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    blocked = true;
+    cv.notify_all();
+    cv.wait(lock, [&release]{return release;});
+  });
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&blocked]{return blocked;});
+  }
+
+  // Queue an unrelated task, which the caller of Run must leave alone
+  std::atomic<bool> unrelatedDone{false};
+  std::thread::id unrelatedThread;
+  pool.Submit([&]
+  {
+    unrelatedThread = std::this_thread::get_id();
+    unrelatedDone = true;
+  });
+
+  std::atomic<int> count{0};
+  std::vector<std::function<void()>> tasks;
+  for (int i = 0; i < 4; ++i)
+    tasks.push_back([&count]{++count;});
+  pool.Run(std::move(tasks));
+
+  EXPECT_EQ(4, count);
+  EXPECT_FALSE(unrelatedDone);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    release = true;
+  }
+  cv.notify_all();
+
+  while (!unrelatedDone)
+    std::this_thread::yield();
+  EXPECT_NE(std::this_thread::get_id(), unrelatedThread);
+}
@@ -14,6 +14,9 @@
  * limitations under the License.
  *
 */
+#include <algorithm>
+#include <vector>
+
 #include "ignition/gazebo/detail/View.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
 
@@ -21,14 +24,90 @@ using namespace ignition;
 using namespace gazebo;
 using namespace detail;
 
+//////////////////////////////////////////////////
+/// \brief Insert a value into a sorted vector, if not present.
+/// \param[in, out] _vec Sorted vector.
+/// \param[in] _entity Value to insert.
+static void insertSorted(std::vector<Entity> &_vec, const Entity _entity)
+{
+  auto it = std::lower_bound(_vec.begin(), _vec.end(), _entity);
+  if (it == _vec.end() || *it != _entity)
+    _vec.insert(it, _entity);
+}
+
+//////////////////////////////////////////////////
+/// \brief Erase a value from a sorted vector, if present.
+/// \param[in, out] _vec Sorted vector.
+/// \param[in] _entity Value to erase.
+static void eraseSorted(std::vector<Entity> &_vec, const Entity _entity)
+{
+  auto it = std::lower_bound(_vec.begin(), _vec.end(), _entity);
+  if (it != _vec.end() && *it == _entity)
+    _vec.erase(it);
+}
+
+//////////////////////////////////////////////////
+View::View(const ComponentTypeKey &_types)
+  : types(_types.begin(), _types.end())
+{
+}
+
+//////////////////////////////////////////////////
+View::View(View &&_view)
+  : entities(std::move(_view.entities)),
+    newEntities(std::move(_view.newEntities)),
+    toRemoveEntities(std::move(_view.toRemoveEntities)),
+    types(std::move(_view.types)),
+    rows(std::move(_view.rows)),
+    componentIds(std::move(_view.componentIds)),
+    componentPtrs(std::move(_view.componentPtrs)),
+    unresolvedRows(std::move(_view.unresolvedRows)),
+    allUnresolved(_view.allUnresolved),
+    unresolved(_view.unresolved.load()),
+    needsCompaction(_view.needsCompaction)
+{
+}
+
 //////////////////////////////////////////////////
 void View::AddEntity(const Entity _entity, const bool _new)
 {
-  this->entities.insert(_entity);
   if (_new)
+    insertSorted(this->newEntities, _entity);
+
+  if (this->rows.find(_entity) != this->rows.end())
+    return;
+
+  const size_t width = this->types.size();
+
+  // Entity ids are usually created in increasing order, so new entities can
+  // be appended. Entities are also appended while the view is being
+  // iterated, and sorted afterwards.
+  size_t row = this->entities.size();
+  if (this->iterating > 0)
   {
-    this->newEntities.insert(_entity);
+    this->needsCompaction = true;
   }
+  else if (!this->entities.empty() && this->entities.back() > _entity)
+  {
+    row = std::lower_bound(this->entities.begin(), this->entities.end(),
+        _entity) - this->entities.begin();
+
+    // Shift the rows which come after the new entity.
+    for (size_t i = row; i < this->entities.size(); ++i)
+      ++this->rows[this->entities[i]];
+    for (size_t &unresolvedRow : this->unresolvedRows)
+    {
+      if (unresolvedRow >= row)
+        ++unresolvedRow;
+    }
+  }
+
+  this->entities.insert(this->entities.begin() + row, _entity);
+  this->componentIds.insert(this->componentIds.begin() + row * width, width,
+      kComponentIdInvalid);
+  this->componentPtrs.insert(this->componentPtrs.begin() + row * width, width,
+      nullptr);
+  this->rows[_entity] = row;
 }
 
 //////////////////////////////////////////////////
@@ -36,24 +115,68 @@ void View::AddComponent(const Entity _entity,
     const ComponentTypeId _typeId,
     const ComponentId _componentId)
 {
-  this->components.insert(
-      std::make_pair(std::make_pair(_entity, _typeId), _componentId));
+  const size_t row = this->Row(_entity);
+  if (row == kInvalidRow)
+    return;
+
+  const size_t index = row * this->types.size() + this->ColumnIndex(_typeId);
+  if (this->componentIds[index] == _componentId &&
+      this->componentPtrs[index] != nullptr)
+  {
+    return;
+  }
+
+  this->componentIds[index] = _componentId;
+  this->componentPtrs[index] = nullptr;
+  this->unresolvedRows.push_back(row);
+  this->unresolved = true;
 }
 
 //////////////////////////////////////////////////
-bool View::RemoveEntity(const Entity _entity, const ComponentTypeKey &_key)
+bool View::RemoveEntity(const Entity _entity, const ComponentTypeKey &)
 {
-  if (this->entities.find(_entity) == this->entities.end())
+  auto rowIter = this->rows.find(_entity);
+  if (rowIter == this->rows.end())
     return false;
 
+  const size_t row = rowIter->second;
+  this->rows.erase(rowIter);
+
   // Otherwise, remove the entity from the view
-  this->entities.erase(_entity);
-  this->newEntities.erase(_entity);
-  this->toRemoveEntities.erase(_entity);
+  eraseSorted(this->newEntities, _entity);
+  eraseSorted(this->toRemoveEntities, _entity);
+
+  // Leave a hole while the view is being iterated, so that the iteration
+  // doesn't skip entities.
+  if (this->iterating > 0)
+  {
+    this->entities[row] = kNullEntity;
+    this->needsCompaction = true;
+    return true;
+  }
+
+  const size_t width = this->types.size();
+  this->entities.erase(this->entities.begin() + row);
+  this->componentIds.erase(this->componentIds.begin() + row * width,
+      this->componentIds.begin() + (row + 1) * width);
+  this->componentPtrs.erase(this->componentPtrs.begin() + row * width,
+      this->componentPtrs.begin() + (row + 1) * width);
 
-  // Remove the entity from the components map
-  for (const ComponentTypeId &compTypeId : _key)
-    this->components.erase(std::make_pair(_entity, compTypeId));
+  // Shift the rows which came after the removed entity.
+  for (size_t i = row; i < this->entities.size(); ++i)
+    --this->rows[this->entities[i]];
+  for (auto it = this->unresolvedRows.begin();
+       it != this->unresolvedRows.end();)
+  {
+    if (*it == row)
+    {
+      it = this->unresolvedRows.erase(it);
+      continue;
+    }
+    if (*it > row)
+      --(*it);
+    ++it;
+  }
 
   return true;
 }
@@ -64,8 +187,136 @@ const components::BaseComponent *View::ComponentImplementation(
     ComponentTypeId _typeId,
     const EntityComponentManager *_ecm) const
 {
-  return _ecm->ComponentImplementation(
-      {_typeId, this->components.at({_entity, _typeId})});
+  const size_t row = this->Row(_entity);
+  if (row == kInvalidRow)
+    return nullptr;
+
+  this->Refresh(_ecm);
+  return this->ComponentAt(row, this->ColumnIndex(_typeId));
+}
+
+//////////////////////////////////////////////////
+size_t View::ColumnIndex(const ComponentTypeId _typeId) const
+{
+  return std::lower_bound(this->types.begin(), this->types.end(), _typeId) -
+      this->types.begin();
+}
+
+//////////////////////////////////////////////////
+size_t View::Row(const Entity _entity) const
+{
+  auto it = this->rows.find(_entity);
+  if (it == this->rows.end())
+    return kInvalidRow;
+  return it->second;
+}
+
+//////////////////////////////////////////////////
+void View::Refresh(const EntityComponentManager *_ecm) const
+{
+  if (!this->unresolved)
+    return;
+
+  std::lock_guard<std::mutex> lock(this->refreshMutex);
+  if (!this->unresolved)
+    return;
+
+  const size_t width = this->types.size();
+  auto resolveRow = [&](const size_t _row)
+  {
+    for (size_t col = 0; col < width; ++col)
+    {
+      const size_t index = _row * width + col;
+      this->componentPtrs[index] = const_cast<components::BaseComponent *>(
+          _ecm->ComponentImplementation(
+            {this->types[col], this->componentIds[index]}));
+    }
+  };
+
+  if (this->allUnresolved)
+  {
+    for (size_t row = 0; row < this->entities.size(); ++row)
+    {
+      if (this->entities[row] != kNullEntity)
+        resolveRow(row);
+    }
+  }
+  else
+  {
+    for (const size_t row : this->unresolvedRows)
+      resolveRow(row);
+  }
+
+  this->unresolvedRows.clear();
+  this->allUnresolved = false;
+  this->unresolved = false;
+}
+
+//////////////////////////////////////////////////
+void View::Compact()
+{
+  this->needsCompaction = false;
+
+  std::vector<size_t> order;
+  order.reserve(this->entities.size());
+  for (size_t row = 0; row < this->entities.size(); ++row)
+  {
+    if (this->entities[row] != kNullEntity)
+      order.push_back(row);
+  }
+  std::sort(order.begin(), order.end(), [this](size_t _a, size_t _b)
+  {
+    return this->entities[_a] < this->entities[_b];
+  });
+
+  const size_t width = this->types.size();
+  std::vector<Entity> sortedEntities;
+  std::vector<ComponentId> sortedIds;
+  std::vector<components::BaseComponent *> sortedPtrs;
+  sortedEntities.reserve(order.size());
+  sortedIds.reserve(order.size() * width);
+  sortedPtrs.reserve(order.size() * width);
+
+  this->rows.clear();
+  for (const size_t row : order)
+  {
+    this->rows[this->entities[row]] = sortedEntities.size();
+    sortedEntities.push_back(this->entities[row]);
+    sortedIds.insert(sortedIds.end(),
+        this->componentIds.begin() + row * width,
+        this->componentIds.begin() + (row + 1) * width);
+    sortedPtrs.insert(sortedPtrs.end(),
+        this->componentPtrs.begin() + row * width,
+        this->componentPtrs.begin() + (row + 1) * width);
+  }
+
+  this->entities = std::move(sortedEntities);
+  this->componentIds = std::move(sortedIds);
+  this->componentPtrs = std::move(sortedPtrs);
+
+  // Rows have moved, so the list of unresolved rows is no longer accurate.
+  if (!this->unresolvedRows.empty())
+    this->InvalidateComponents();
+}
+
+//////////////////////////////////////////////////
+void View::InvalidateComponents()
+{
+  this->unresolvedRows.clear();
+  this->allUnresolved = true;
+  this->unresolved = true;
+}
+
+//////////////////////////////////////////////////
+void View::Reset()
+{
+  this->entities.clear();
+  this->rows.clear();
+  this->componentIds.clear();
+  this->componentPtrs.clear();
+  this->unresolvedRows.clear();
+  this->allUnresolved = false;
+  this->unresolved = false;
 }
 
 //////////////////////////////////////////////////
@@ -77,8 +328,8 @@ void View::ClearNewEntities()
 //////////////////////////////////////////////////
 bool View::AddEntityToRemoved(const Entity _entity)
 {
-  if (this->entities.find(_entity) == this->entities.end())
+  if (this->rows.find(_entity) == this->rows.end())
     return false;
-  this->toRemoveEntities.insert(_entity);
+  insertSorted(this->toRemoveEntities, _entity);
   return true;
 }
@@ -15,6 +15,12 @@
  *
 */
 
+#include <ignition/msgs/empty.pb.h>
+#include <ignition/msgs/stringmsg_v.pb.h>
+
+#include <cstdlib>
+#include <string>
+
 #include <ignition/common/Console.hh>
 #include <ignition/common/Profiler.hh>
 #include <ignition/fuel_tools/Interface.hh>
@@ -29,6 +35,8 @@
 #include "ignition/gazebo/gui/GuiRunner.hh"
 #include "ignition/gazebo/gui/GuiSystem.hh"
 
+#include "../SharedMemoryRing.hh"
+
 using namespace ignition;
 using namespace gazebo;
 
@@ -38,6 +46,11 @@ class ignition::gazebo::GuiRunner::Implementation
   /// \brief Update the plugins.
   public: void UpdatePlugins();
 
+  /// \brief Map the shared memory where the server writes the state, if
+  /// the server runs on the same host.
+  /// \return True if the state will be read from shared memory.
+  public: bool OpenStateRing();
+
   /// \brief Entity-component manager.
   public: gazebo::EntityComponentManager ecm;
 
@@ -58,6 +71,25 @@ class ignition::gazebo::GuiRunner::Implementation
 
   /// \brief The plugin update thread..
   public: std::thread updateThread;
+
+  /// \brief Shared memory where the state is read from when the server runs
+  /// on the same host. Null if the state comes through transport.
+  public: std::unique_ptr<SharedMemoryRing> stateRing;
+
+  /// \brief Thread reading the state from shared memory.
+  public: std::thread stateRingThread;
+
+  /// \brief Protects stateSynced and stateIterations.
+  public: std::mutex stateRingMutex;
+
+  /// \brief False while waiting for a full state after missing messages in
+  /// shared memory. Other messages can't be applied meanwhile.
+  public: bool stateSynced{false};
+
+  /// \brief Iterations of the last full state received through the state
+  /// service or shared memory. Older messages from shared memory are
+  /// skipped.
+  public: uint64_t stateIterations{0};
 };
 
 /////////////////////////////////////////////////
@@ -85,6 +117,10 @@ GuiRunner::GuiRunner(const std::string &_worldName)
     return fuel_tools::fetchResource(_uri.Str());
   });
 
+  // Open the shared memory before requesting the state, so that no message
+  // written after the state is missed
+  bool sharedMemory = this->dataPtr->OpenStateRing();
+
   igndbg << "Requesting initial state from [" << this->dataPtr->stateTopic
          << "]..." << std::endl;
 
@@ -93,6 +129,78 @@ GuiRunner::GuiRunner(const std::string &_worldName)
   // Periodically update the plugins
   // \todo(anyone) Move the global variables to GuiRunner::Implementation on v5
   this->dataPtr->running = true;
+
+  // Read the state from shared memory as soon as it's written
+  if (sharedMemory)
+  {
+    this->dataPtr->stateRingThread = std::thread([&]()
+    {
+      msgs::SerializedStepMap msg;
+      std::string data;
+      bool keyframe{false};
+      uint64_t lost{0};
+      while (this->dataPtr->running)
+      {
+        if (!this->dataPtr->stateRing->Read(data, keyframe, lost))
+        {
+          // The server went away, fall back to transport in case it's
+          // replaced by another one, whose full state is needed first
+          if (this->dataPtr->stateRing->Closed())
+          {
+            ignwarn << "Shared memory [" << this->dataPtr->stateRing->Name()
+                    << "] closed, receiving state through transport."
+                    << std::endl;
+            this->dataPtr->node.Subscribe(this->dataPtr->stateTopic,
+                &GuiRunner::OnState, this);
+            this->RequestState();
+            break;
+          }
+          std::this_thread::sleep_for(std::chrono::milliseconds(2));
+          continue;
+        }
+
+        if (!msg.ParseFromString(data))
+        {
+          ignerr << "Failed to parse state from shared memory." << std::endl;
+          continue;
+        }
+
+        {
+          std::lock_guard<std::mutex> lock(this->dataPtr->stateRingMutex);
+
+          // Missing a change event leaves the ECM out of sync, get the full
+          // state again unless this message is a full state
+          if (lost > 0 && !keyframe)
+          {
+            if (this->dataPtr->stateSynced)
+            {
+              igndbg << "Missed [" << lost << "] state messages in shared "
+                     << "memory, requesting full state." << std::endl;
+              this->dataPtr->stateSynced = false;
+              this->RequestState();
+            }
+            continue;
+          }
+
+          // Keyframes after a reset or seek go back in time, so later
+          // messages are compared against them
+          if (keyframe)
+          {
+            this->dataPtr->stateSynced = true;
+            this->dataPtr->stateIterations = msg.stats().iterations();
+          }
+          else if (!this->dataPtr->stateSynced ||
+              msg.stats().iterations() <= this->dataPtr->stateIterations)
+          {
+            continue;
+          }
+        }
+
+        this->OnState(msg);
+      }
+    });
+  }
+
   this->dataPtr->updateThread = std::thread([&]()
   {
     while (this->dataPtr->running)
@@ -113,6 +221,8 @@ GuiRunner::~GuiRunner()
   this->dataPtr->running = false;
   if (this->dataPtr->updateThread.joinable())
     this->dataPtr->updateThread.join();
+  if (this->dataPtr->stateRingThread.joinable())
+    this->dataPtr->stateRingThread.join();
 }
 
 /////////////////////////////////////////////////
@@ -168,6 +278,15 @@ void GuiRunner::OnStateAsyncService(const msgs::SerializedStepMap &_res)
       this->dataPtr->node.Options().NameSpace() + "/" + id + "/state_async";
   this->dataPtr->node.UnadvertiseSrv(reqSrv);
 
+  // Updates newer than this state are read from shared memory
+  if (this->dataPtr->stateRing)
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->stateRingMutex);
+    this->dataPtr->stateSynced = true;
+    this->dataPtr->stateIterations = _res.stats().iterations();
+    return;
+  }
+
   // Only subscribe to periodic updates after receiving initial state
   if (this->dataPtr->node.SubscribedTopics().empty())
   {
@@ -192,6 +311,33 @@ void GuiRunner::OnState(const msgs::SerializedStepMap &_msg)
   this->dataPtr->ecm.ProcessRemoveEntityRequests();
 }
 
+/////////////////////////////////////////////////
+bool GuiRunner::Implementation::OpenStateRing()
+{
+  msgs::Empty req;
+  msgs::StringMsg_V res;
+  bool result{false};
+  unsigned int timeout{1000};
+  std::string service{this->stateTopic + "/shared_memory"};
+
+  // Older servers and servers with shared memory disabled don't offer it
+  if (!this->node.Request(service, req, timeout, res, result) || !result ||
+      res.data_size() != 2)
+  {
+    return false;
+  }
+
+  // Fails if the server is on another host
+  uint64_t token = std::strtoull(res.data(1).c_str(), nullptr, 10);
+  this->stateRing = SharedMemoryRing::Open(res.data(0), token);
+  if (!this->stateRing)
+    return false;
+
+  igndbg << "Reading state from shared memory [" << res.data(0) << "]"
+         << std::endl;
+  return true;
+}
+
 /////////////////////////////////////////////////
 void GuiRunner::Implementation::UpdatePlugins()
 {
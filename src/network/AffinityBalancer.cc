@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "AffinityBalancer.hh"
+
+#include <algorithm>
+
+using namespace ignition;
+using namespace gazebo;
+
+namespace
+{
+/// \brief Weight of a new report in the smoothed step time.
+constexpr double kSmoothing{0.2};
+}
+
+//////////////////////////////////////////////////
+AffinityBalancer::AffinityBalancer(double _hysteresis,
+    unsigned int _cooldown)
+  : hysteresis(std::max(0.0, _hysteresis)), cooldown(_cooldown)
+{
+}
+
+//////////////////////////////////////////////////
+void AffinityBalancer::Report(const std::string &_secondary,
+    const std::chrono::steady_clock::duration &_stepTime,
+    const std::map<Entity, uint64_t> &_performerEntities)
+{
+  const double stepTime =
+      std::chrono::duration<double>(_stepTime).count();
+
+  auto it = this->loads.find(_secondary);
+  if (it == this->loads.end())
+  {
+    this->loads[_secondary].stepTime = stepTime;
+    it = this->loads.find(_secondary);
+  }
+  else
+  {
+    it->second.stepTime += kSmoothing * (stepTime - it->second.stepTime);
+  }
+
+  it->second.performerEntities = _performerEntities;
+}
+
+//////////////////////////////////////////////////
+std::optional<std::pair<Entity, std::string>> AffinityBalancer::Migration()
+{
+  if (this->sinceMigration < this->cooldown)
+  {
+    ++this->sinceMigration;
+    return std::nullopt;
+  }
+
+  if (this->loads.size() < 2)
+    return std::nullopt;
+
+  auto compare = [](const auto &_a, const auto &_b)
+  {
+    return _a.second.stepTime < _b.second.stepTime;
+  };
+  auto slowest = std::max_element(this->loads.begin(), this->loads.end(),
+      compare);
+  auto fastest = std::min_element(this->loads.begin(), this->loads.end(),
+      compare);
+
+  const double slowTime = slowest->second.stepTime;
+  const double fastTime = fastest->second.stepTime;
+  if (slowTime <= fastTime * (1.0 + this->hysteresis))
+    return std::nullopt;
+
+  uint64_t totalEntities{0};
+  for (const auto &performer : slowest->second.performerEntities)
+    totalEntities += performer.second;
+
+  if (totalEntities == 0)
+    return std::nullopt;
+
+  // Estimate each performer's share of the step time from its entity count,
+  // and pick the one which makes the slowest of the two secondaries the
+  // fastest. The move must be worth at least the hysteresis, otherwise the
+  // performer could bounce back and forth.
+  Entity best{kNullEntity};
+  double bestCost{0.0};
+  double bestTime = slowTime / (1.0 + this->hysteresis);
+  for (const auto &performer : slowest->second.performerEntities)
+  {
+    const double cost = slowTime * static_cast<double>(performer.second) /
+        static_cast<double>(totalEntities);
+    const double newTime = std::max(slowTime - cost, fastTime + cost);
+    if (newTime < bestTime)
+    {
+      best = performer.first;
+      bestCost = cost;
+      bestTime = newTime;
+    }
+  }
+
+  if (best == kNullEntity)
+    return std::nullopt;
+
+  // Apply the estimate until the secondaries report their new loads
+  slowest->second.stepTime -= bestCost;
+  fastest->second.stepTime += bestCost;
+  fastest->second.performerEntities[best] =
+      slowest->second.performerEntities[best];
+  slowest->second.performerEntities.erase(best);
+
+  this->sinceMigration = 0;
+  return std::make_pair(best, fastest->first);
+}
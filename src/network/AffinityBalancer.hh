@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_NETWORK_AFFINITYBALANCER_HH_
+#define IGNITION_GAZEBO_NETWORK_AFFINITYBALANCER_HH_
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+#include <ignition/gazebo/Entity.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \class AffinityBalancer AffinityBalancer.hh
+    /// \brief Decides which performers to migrate between secondaries so
+    /// that the slowest secondary, which the lockstep waits on, gets faster.
+    ///
+    /// Each secondary's step time is smoothed over several steps and split
+    /// among its performers proportionally to the number of entities
+    /// simulated for each of them. A performer is only migrated if the
+    /// slowest secondary is slower than the fastest one by more than the
+    /// hysteresis, and if the move is expected to make the slowest step
+    /// faster by the same margin. After a migration, no other migration is
+    /// proposed until the cooldown has elapsed, which gives the smoothed
+    /// step times time to reflect the move.
+    class IGNITION_GAZEBO_VISIBLE AffinityBalancer
+    {
+      /// \brief Constructor
+      /// \param[in] _hysteresis Relative difference between the slowest and
+      /// the fastest secondaries which is tolerated.
+      /// \param[in] _cooldown Number of calls to Migration() to wait after a
+      /// migration before proposing another one.
+      public: explicit AffinityBalancer(double _hysteresis = 0.2,
+          unsigned int _cooldown = 100);
+
+      /// \brief Record the load reported by a secondary for its last step.
+      /// \param[in] _secondary Secondary prefix.
+      /// \param[in] _stepTime Wall time the secondary spent on the step.
+      /// \param[in] _performerEntities Number of entities simulated for each
+      /// of the secondary's performers.
+      public: void Report(const std::string &_secondary,
+          const std::chrono::steady_clock::duration &_stepTime,
+          const std::map<Entity, uint64_t> &_performerEntities);
+
+      /// \brief Propose a migration. Should be called once per step.
+      /// \return The performer to migrate and the prefix of the secondary
+      /// it should be assigned to, or nullopt if the load is balanced
+      /// enough.
+      public: std::optional<std::pair<Entity, std::string>> Migration();
+
+      /// \brief Load of a single secondary.
+      private: struct Load
+      {
+        /// \brief Smoothed step time in seconds.
+        double stepTime{0.0};
+
+        /// \brief Number of entities simulated for each performer.
+        std::map<Entity, uint64_t> performerEntities;
+      };
+
+      /// \brief Latest load of each secondary, keyed by prefix.
+      private: std::map<std::string, Load> loads;
+
+      /// \brief Tolerated relative difference between step times.
+      private: double hysteresis;
+
+      /// \brief Calls to Migration() to skip after a migration.
+      private: unsigned int cooldown;
+
+      /// \brief Calls to Migration() since the last migration.
+      private: unsigned int sinceMigration{0};
+    };
+    }
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_NETWORK_AFFINITYBALANCER_HH_
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+#include "AffinityBalancer.hh"
+
+using namespace ignition::gazebo;
+using namespace std::chrono_literals;
+
+//////////////////////////////////////////////////
+TEST(AffinityBalancer, Balanced)
+{
+  AffinityBalancer balancer(0.2, 0);
+
+  // Not enough secondaries
+  EXPECT_FALSE(balancer.Migration());
+  balancer.Report("a", 10ms, {{1, 100}, {2, 100}});
+  EXPECT_FALSE(balancer.Migration());
+
+  // Within the hysteresis
+  balancer.Report("b", 9ms, {{3, 100}, {4, 100}});
+  EXPECT_FALSE(balancer.Migration());
+}
+
+//////////////////////////////////////////////////
+TEST(AffinityBalancer, Migrate)
+{
+  AffinityBalancer balancer(0.2, 0);
+
+  // Moving performer 2 makes both secondaries take about 6 ms
+  balancer.Report("a", 10ms, {{1, 50}, {2, 40}, {3, 10}});
+  balancer.Report("b", 2ms, {{4, 100}});
+
+  auto migration = balancer.Migration();
+  ASSERT_TRUE(migration);
+  EXPECT_EQ(2u, migration->first);
+  EXPECT_EQ("b", migration->second);
+
+  // The estimate is balanced, so nothing else moves
+  EXPECT_FALSE(balancer.Migration());
+}
+
+//////////////////////////////////////////////////
+TEST(AffinityBalancer, SinglePerformer)
+{
+  AffinityBalancer balancer(0.2, 0);
+
+  // Moving the only performer would just move the problem
+  balancer.Report("a", 10ms, {{1, 100}});
+  balancer.Report("b", 1ms, {});
+  EXPECT_FALSE(balancer.Migration());
+}
+
+//////////////////////////////////////////////////
+TEST(AffinityBalancer, Cooldown)
+{
+  AffinityBalancer balancer(0.2, 3);
+  balancer.Report("a", 10ms, {{1, 50}, {2, 50}});
+  balancer.Report("b", 1ms, {{3, 10}});
+
+  // Wait for the cooldown before the first migration too, so the step times
+  // are smoothed over a few reports
+  for (int i = 0; i < 3; ++i)
+    EXPECT_FALSE(balancer.Migration());
+  EXPECT_TRUE(balancer.Migration());
+
+  // Even if the load is unbalanced again
+  balancer.Report("a", 10ms, {{1, 50}, {2, 50}});
+  balancer.Report("b", 1ms, {{3, 10}});
+  for (int i = 0; i < 3; ++i)
+    EXPECT_FALSE(balancer.Migration());
+}
+
+//////////////////////////////////////////////////
+TEST(AffinityBalancer, Smoothing)
+{
+  AffinityBalancer balancer(0.2, 0);
+  balancer.Report("a", 5ms, {{1, 20}, {2, 40}, {3, 40}});
+  balancer.Report("b", 5ms, {{4, 50}, {5, 50}});
+
+  // A single slow step isn't enough to migrate
+  balancer.Report("a", 8ms, {{1, 20}, {2, 40}, {3, 40}});
+  EXPECT_FALSE(balancer.Migration());
+
+  // A sustained one is
+  for (int i = 0; i < 10; ++i)
+    balancer.Report("a", 10ms, {{1, 20}, {2, 40}, {3, 40}});
+  auto migration = balancer.Migration();
+  ASSERT_TRUE(migration);
+  EXPECT_EQ(1u, migration->first);
+  EXPECT_EQ("b", migration->second);
+}
@@ -26,7 +26,7 @@ using namespace gazebo;
 
 /////////////////////////////////////////////////
 NetworkConfig NetworkConfig::FromValues(const std::string &_role,
-    unsigned int _secondaries)
+    unsigned int _secondaries, unsigned int _maxStaleness)
 {
   NetworkConfig config;
 
@@ -72,6 +72,7 @@ NetworkConfig NetworkConfig::FromValues(const std::string &_role,
         << "IGN_GAZEBO_NETWORK_SECONDARIES not set, "
         << "no distributed sim available" << std::endl;
     }
+    config.maxStaleness = _maxStaleness;
   }
 
   return config;
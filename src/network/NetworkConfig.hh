@@ -43,15 +43,24 @@ namespace ignition
       /// \param[in] _role One of [primary, secondary].
       /// \param[in] _secondaries Number of secondaries the primary should
       /// expect. This is only meaningful if _role == primary.
+      /// \param[in] _maxStaleness Number of steps secondaries may run ahead
+      /// of the primary. This is only meaningful if _role == primary.
       /// \return A NetworkConfig object based on the provided values.
       public: static NetworkConfig FromValues(const std::string &_role,
-                                              unsigned int _secondaries = 0);
+                                              unsigned int _secondaries = 0,
+                                              unsigned int _maxStaleness = 0);
 
       /// \brief Role of this network participant
       public: NetworkRole role { NetworkRole::None };
 
       /// \brief Expect number of network secondaries.
       public: size_t numSecondariesExpected { 0 };
+
+      /// \brief Maximum number of steps published to secondaries whose
+      /// states haven't been applied by the primary yet. Zero means the
+      /// primary waits for every step to be acknowledged before stepping its
+      /// own systems (lockstep).
+      public: unsigned int maxStaleness { 0 };
     };
     }
   }  // namespace gazebo
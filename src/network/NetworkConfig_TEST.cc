@@ -40,6 +40,14 @@ TEST(NetworkManager, ValueConstructor)
     auto config = NetworkConfig::FromValues("PRIMARY", 3);
     assert(config.role == NetworkRole::SimulationPrimary);
     assert(config.numSecondariesExpected == 3);
+    assert(config.maxStaleness == 0);
+  }
+
+  {
+    // Primary may let secondaries run ahead
+    auto config = NetworkConfig::FromValues("PRIMARY", 3, 2);
+    assert(config.role == NetworkRole::SimulationPrimary);
+    assert(config.maxStaleness == 2);
   }
 
   {
@@ -18,7 +18,9 @@
 #include "NetworkManagerPrimary.hh"
 
 #include <algorithm>
-#include <future>
+#include <map>
+#include <mutex>
+#include <optional>
 #include <set>
 #include <string>
 #include <utility>
@@ -30,6 +32,7 @@
 #include "msgs/peer_control.pb.h"
 #include "msgs/simulation_step.pb.h"
 
+#include "ignition/gazebo/components/ParentEntity.hh"
 #include "ignition/gazebo/components/PerformerAffinity.hh"
 #include "ignition/gazebo/components/PerformerLevels.hh"
 #include "ignition/gazebo/Conversions.hh"
@@ -135,6 +138,25 @@ bool NetworkManagerPrimary::Step(const UpdateInfo &_info)
   // Affinities that changed this step
   this->PopulateAffinities(step);
 
+  // Performers changing secondaries carry the state of their models, which
+  // must include everything their previous secondaries simulated so far, so
+  // secondaries can't be running ahead at this point.
+  if (step.affinity_size() > 0 && this->dataPtr->config.maxStaleness > 0)
+  {
+    if (!this->ApplySecondaryStates(0))
+      return false;
+
+    for (auto &affinity : *step.mutable_affinity())
+    {
+      if (affinity.has_state())
+      {
+        affinity.clear_state();
+        this->PerformerState(affinity.entity().id(),
+            *affinity.mutable_state());
+      }
+    }
+  }
+
   // Check all secondaries are ready to receive steps - only do this once at
   // startup
   if (!this->SecondariesCanStep())
@@ -143,37 +165,24 @@ bool NetworkManagerPrimary::Step(const UpdateInfo &_info)
   }
 
   // Send step to all secondaries
-  this->secondaryStates.clear();
-  this->secondaryStatesPromise = std::promise<void>{};
-  auto future = this->secondaryStatesPromise.get_future();
-  this->simStepPub.Publish(step);
-
-  // Block until all secondaries are done
+  step.set_sequence(this->nextSequence++);
   {
-    IGN_PROFILE("Waiting for secondaries");
-
-    auto result = future.wait_for(10s);
+    std::lock_guard<std::mutex> lock(this->secondaryStatesMutex);
+    this->pendingSteps.push_back(step.sequence());
 
-    if (std::future_status::ready != result)
-    {
-      ignerr << "Waited 10 s and got only [" << this->secondaryStates.size()
-             << " / " << this->secondaries.size()
-             << "] responses from secondaries. Stopping simulation."
-             << std::endl;
-      this->dataPtr->eventMgr->Emit<events::Stop>();
-      return false;
-    }
+    for (const auto &prefix : this->resyncPrefixes)
+      step.add_resync_prefix(prefix);
+    this->resyncPrefixes.clear();
   }
+  this->simStepPub.Publish(step);
 
-  // Update primary state with states received from secondaries
-  {
-    IGN_PROFILE("Updating primary state");
-    for (const auto &msg : this->secondaryStates)
-    {
-      this->dataPtr->ecm->SetState(msg);
-    }
-    this->secondaryStates.clear();
-  }
+  // In lockstep, block until all secondaries are done with this step.
+  // Otherwise, secondaries keep computing the next steps while the primary
+  // steps its own systems. Affinity changes are always applied in lockstep.
+  std::size_t maxPending = step.affinity_size() > 0 ?
+      0u : this->dataPtr->config.maxStaleness;
+  if (!this->ApplySecondaryStates(maxPending))
+    return false;
 
   // Step all systems
   this->dataPtr->stepFunction(_info);
@@ -197,12 +206,143 @@ std::map<std::string, SecondaryControl::Ptr>
 }
 
 //////////////////////////////////////////////////
-void NetworkManagerPrimary::OnStepAck(const msgs::SerializedStateMap &_msg)
+void NetworkManagerPrimary::OnStepAck(
+    const private_msgs::SimulationStepAck &_msg)
 {
-  this->secondaryStates.push_back(_msg);
-  if (this->secondaryStates.size() == this->secondaries.size())
+  std::map<Entity, uint64_t> performerEntities;
+  for (const auto &load : _msg.performer_load())
+    performerEntities[load.entity().id()] = load.entity_count();
+
+  std::lock_guard<std::mutex> lock(this->secondaryStatesMutex);
+  this->balancer.Report(_msg.secondary_prefix(),
+      convert<std::chrono::steady_clock::duration>(_msg.step_time()),
+      performerEntities);
+
+  // Responses arriving after a later one are for steps which were already
+  // counted as lost below.
+  const auto &prefix = _msg.secondary_prefix();
+  auto lastIt = this->lastAckSequences.find(prefix);
+  if (lastIt != this->lastAckSequences.end() &&
+      _msg.sequence() <= lastIt->second)
+  {
+    return;
+  }
+
+  // Secondaries only send what changed during each step, so if responses
+  // were lost, ask for the full state. The lost responses are counted as
+  // empty so the steps waiting for them can be applied, and the full state
+  // brings the primary up to date afterwards.
+  uint64_t firstMissing = _msg.sequence();
+  if (lastIt != this->lastAckSequences.end())
+    firstMissing = lastIt->second + 1;
+  else if (!this->pendingSteps.empty())
+    firstMissing = this->pendingSteps.front();
+
+  if (firstMissing < _msg.sequence())
+  {
+    if (!_msg.full_state())
+    {
+      ignwarn << "Missing responses from secondary [" << prefix
+              << "] for steps [" << firstMissing << "] to ["
+              << _msg.sequence() - 1 << "], requesting its full state."
+              << std::endl;
+      this->resyncPrefixes.insert(prefix);
+    }
+
+    if (!this->pendingSteps.empty())
+    {
+      for (auto sequence = std::max(firstMissing, this->pendingSteps.front());
+          sequence < _msg.sequence(); ++sequence)
+      {
+        this->secondaryStates[sequence].emplace_back();
+      }
+    }
+  }
+  this->lastAckSequences[prefix] = _msg.sequence();
+
+  // Ignore late responses to steps which were given up on
+  if (this->pendingSteps.empty() ||
+      _msg.sequence() < this->pendingSteps.front())
   {
-    this->secondaryStatesPromise.set_value();
+    return;
+  }
+
+  this->secondaryStates[_msg.sequence()].push_back(_msg.state());
+  this->secondaryStatesCv.notify_all();
+}
+
+//////////////////////////////////////////////////
+bool NetworkManagerPrimary::ApplySecondaryStates(std::size_t _maxPending)
+{
+  IGN_PROFILE("NetworkManagerPrimary::ApplySecondaryStates");
+
+  std::unique_lock<std::mutex> lock(this->secondaryStatesMutex);
+
+  // Number of states received for the oldest pending step
+  auto received = [this]() -> std::size_t
+  {
+    auto it = this->secondaryStates.find(this->pendingSteps.front());
+    return it == this->secondaryStates.end() ? 0u : it->second.size();
+  };
+
+  // Apply states in step order. Steps which are complete are applied even
+  // if they could remain pending, so the primary lags as little as possible.
+  while (!this->pendingSteps.empty())
+  {
+    if (received() < this->secondaries.size())
+    {
+      if (this->pendingSteps.size() <= _maxPending)
+        break;
+
+      IGN_PROFILE("Waiting for secondaries");
+      if (!this->secondaryStatesCv.wait_for(lock, 10s, [&]
+          {
+            return received() >= this->secondaries.size();
+          }))
+      {
+        ignerr << "Waited 10 s and got only [" << received()
+               << " / " << this->secondaries.size()
+               << "] responses from secondaries. Stopping simulation."
+               << std::endl;
+        this->pendingSteps.clear();
+        this->secondaryStates.clear();
+        this->lastAckSequences.clear();
+        lock.unlock();
+        this->dataPtr->eventMgr->Emit<events::Stop>();
+        return false;
+      }
+    }
+
+    auto sequence = this->pendingSteps.front();
+    auto states = std::move(this->secondaryStates[sequence]);
+    this->secondaryStates.erase(sequence);
+    this->pendingSteps.pop_front();
+
+    // Don't block transport threads while updating the state
+    lock.unlock();
+    {
+      IGN_PROFILE("Updating primary state");
+      for (const auto &msg : states)
+      {
+        this->dataPtr->ecm->SetState(msg);
+      }
+    }
+    lock.lock();
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+void NetworkManagerPrimary::PerformerState(Entity _performer,
+    msgs::SerializedStateMap &_msg) const
+{
+  auto parent =
+      this->dataPtr->ecm->Component<components::ParentEntity>(_performer);
+  if (parent)
+  {
+    this->dataPtr->ecm->State(_msg,
+        this->dataPtr->ecm->Descendants(parent->Data()), {}, true);
   }
 }
 
@@ -300,17 +440,43 @@ void NetworkManagerPrimary::PopulateAffinities(
     return;
   }
 
+  // Move a performer away from the slowest secondary if the load is
+  // unbalanced
+  std::optional<std::pair<Entity, std::string>> migration;
+  {
+    std::lock_guard<std::mutex> lock(this->secondaryStatesMutex);
+    migration = this->balancer.Migration();
+  }
+  if (migration &&
+      allPerformers.find(migration->first) != allPerformers.end() &&
+      this->secondaries.find(migration->second) != this->secondaries.end())
+  {
+    ignmsg << "Migrating performer [" << migration->first
+           << "] to secondary [" << migration->second
+           << "] to balance the load." << std::endl;
+    this->SetAffinity(migration->first, migration->second,
+        _msg.add_affinity(), true);
+  }
+
   // TODO(louise) Process level changes
 }
 
 //////////////////////////////////////////////////
 void NetworkManagerPrimary::SetAffinity(Entity _performer,
-    const std::string &_secondary, private_msgs::PerformerAffinity *_msg)
+    const std::string &_secondary, private_msgs::PerformerAffinity *_msg,
+    bool _migrate)
 {
   // Populate message
   _msg->mutable_entity()->set_id(_performer);
   _msg->set_secondary_prefix(_secondary);
 
+  // The previous secondary removes the performer's model, so the new one
+  // needs its latest state to pick it up.
+  if (_migrate)
+  {
+    this->PerformerState(_performer, *_msg->mutable_state());
+  }
+
   // Set component
   this->dataPtr->ecm->RemoveComponent<components::PerformerAffinity>(
       _performer);
@@ -18,9 +18,13 @@
 #define IGNITION_GAZEBO_NETWORK_NETWORKMANAGERPRIMARY_HH_
 
 #include <atomic>
-#include <future>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -31,6 +35,7 @@
 
 #include "msgs/simulation_step.pb.h"
 
+#include "AffinityBalancer.hh"
 #include "NetworkManager.hh"
 
 namespace ignition
@@ -89,14 +94,28 @@ namespace ignition
       public: std::map<std::string, SecondaryControl::Ptr>& Secondaries();
 
       /// \brief Callback for step ack messages.
-      /// \param[in] _msg Message containing secondary's updated state.
-      private: void OnStepAck(const msgs::SerializedStateMap &_msg);
+      /// \param[in] _msg Message containing secondary's updated state and
+      /// load.
+      private: void OnStepAck(const private_msgs::SimulationStepAck &_msg);
+
+      /// \brief Apply the states received from secondaries, in step order,
+      /// blocking until no more than _maxPending steps are left without all
+      /// of their states.
+      /// \param[in] _maxPending Number of steps which may remain pending.
+      /// \return False if secondaries took too long to respond.
+      private: bool ApplySecondaryStates(std::size_t _maxPending);
+
+      /// \brief Get the state of a performer's whole model.
+      /// \param[in] _performer Performer entity.
+      /// \param[out] _msg Message to be populated.
+      private: void PerformerState(Entity _performer,
+          msgs::SerializedStateMap &_msg) const;
 
       /// \brief Check if the step publisher has connections.
       private: bool SecondariesCanStep() const;
 
       /// \brief Populate the step message with the latest affinities according
-      /// to levels.
+      /// to levels and to the load reported by secondaries.
       /// \param[in] _msg Step message.
       private: void PopulateAffinities(private_msgs::SimulationStep &_msg);
 
@@ -104,8 +123,11 @@ namespace ignition
       /// \param[in] _performer Performer entity.
       /// \param[in] _secondary Secondary identifier.
       /// \param[out] _msg Message to be populated.
+      /// \param[in] _migrate True if the performer was assigned to another
+      /// secondary before, in which case its state is added to the message.
       private: void SetAffinity(Entity _performer,
-          const std::string &_secondary, private_msgs::PerformerAffinity *_msg);
+          const std::string &_secondary, private_msgs::PerformerAffinity *_msg,
+          bool _migrate = false);
 
       /// \brief Container of currently used secondary peers
       private: std::map<std::string, SecondaryControl::Ptr> secondaries;
@@ -116,11 +138,37 @@ namespace ignition
       /// \brief Publisher for network step sync
       private: ignition::transport::Node::Publisher simStepPub;
 
-      /// \brief Keep track of states received from secondaries.
-      private: std::vector<msgs::SerializedStateMap> secondaryStates;
+      /// \brief States received from secondaries, keyed by step sequence
+      /// number. Protected by secondaryStatesMutex.
+      private: std::map<uint64_t, std::vector<msgs::SerializedStateMap>>
+          secondaryStates;
+
+      /// \brief Sequence numbers of the steps published to secondaries whose
+      /// states haven't been applied yet, oldest first. Protected by
+      /// secondaryStatesMutex.
+      private: std::deque<uint64_t> pendingSteps;
+
+      /// \brief Sequence number of the last step acknowledged by each
+      /// secondary, keyed by prefix. Protected by secondaryStatesMutex.
+      private: std::map<std::string, uint64_t> lastAckSequences;
+
+      /// \brief Prefixes of the secondaries which should send their full
+      /// state on the next step because some of their responses were lost.
+      /// Protected by secondaryStatesMutex.
+      private: std::set<std::string> resyncPrefixes;
+
+      /// \brief Sequence number of the next step to publish.
+      private: uint64_t nextSequence{0};
+
+      /// \brief Protects the members which are also accessed from transport
+      /// threads.
+      private: std::mutex secondaryStatesMutex;
+
+      /// \brief Notified when states are received from secondaries.
+      private: std::condition_variable secondaryStatesCv;
 
-      /// \brief Promise used to notify when all secondaryStates where received.
-      private: std::promise<void> secondaryStatesPromise;
+      /// \brief Migrates performers away from the slowest secondary.
+      private: AffinityBalancer balancer;
     };
     }
   }  // namespace gazebo
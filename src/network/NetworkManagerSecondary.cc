@@ -16,6 +16,7 @@
 */
 
 #include <algorithm>
+#include <chrono>
 #include <string>
 
 #include <ignition/common/Console.hh>
@@ -37,6 +38,13 @@
 using namespace ignition;
 using namespace gazebo;
 
+namespace
+{
+/// \brief Number of steps after which the full state of the performers is
+/// sent to the primary, even if no response was lost.
+constexpr unsigned int kFullStatePeriod{1000};
+}
+
 //////////////////////////////////////////////////
 NetworkManagerSecondary::NetworkManagerSecondary(
     const std::function<void(const UpdateInfo &_info)> &_stepFunction,
@@ -61,7 +69,8 @@ NetworkManagerSecondary::NetworkManagerSecondary(
 
   this->node.Subscribe("step", &NetworkManagerSecondary::OnStep, this);
 
-  this->stepAckPub = this->node.Advertise<msgs::SerializedStateMap>("step_ack");
+  this->stepAckPub =
+      this->node.Advertise<private_msgs::SimulationStepAck>("step_ack");
 }
 
 //////////////////////////////////////////////////
@@ -117,6 +126,10 @@ void NetworkManagerSecondary::OnStep(
 
     if (affinityMsg.secondary_prefix() == this->Namespace())
     {
+      // Performer migrated from another secondary
+      if (affinityMsg.has_state())
+        this->dataPtr->ecm->SetState(affinityMsg.state());
+
       this->performers.insert(entityId);
 
       ignmsg << "Secondary [" << this->Namespace()
@@ -144,7 +157,14 @@ void NetworkManagerSecondary::OnStep(
   auto info = convert<UpdateInfo>(_msg.stats());
 
   // Step runner
+  auto stepStart = std::chrono::steady_clock::now();
   this->dataPtr->stepFunction(info);
+  auto stepTime = std::chrono::steady_clock::now() - stepStart;
+
+  private_msgs::SimulationStepAck ackMsg;
+  ackMsg.set_secondary_prefix(this->Namespace());
+  ackMsg.set_sequence(_msg.sequence());
+  ackMsg.mutable_step_time()->CopyFrom(convert<msgs::Time>(stepTime));
 
   // Update state with all the performer's entities
   std::unordered_set<Entity> entities;
@@ -162,15 +182,34 @@ void NetworkManagerSecondary::OnStep(
 
     auto children = this->dataPtr->ecm->Descendants(modelEntity);
     entities.insert(children.begin(), children.end());
+
+    // Report the performer's load
+    auto loadMsg = ackMsg.add_performer_load();
+    loadMsg->mutable_entity()->set_id(perf);
+    loadMsg->set_entity_count(children.size());
+  }
+
+  // Only send components which changed during this step, unless the
+  // primary may be missing some of the previous changes.
+  bool resync = std::find(_msg.resync_prefix().begin(),
+      _msg.resync_prefix().end(), this->Namespace()) !=
+      _msg.resync_prefix().end();
+  bool full = !this->fullStateSent || resync || _msg.affinity_size() > 0 ||
+      ++this->stepsSinceFullState >= kFullStatePeriod;
+  if (full)
+  {
+    this->fullStateSent = true;
+    this->stepsSinceFullState = 0;
   }
+  ackMsg.set_full_state(full);
 
-  msgs::SerializedStateMap stateMsg;
-  if (!entities.empty())
-    this->dataPtr->ecm->State(stateMsg, entities);
-  stateMsg.set_has_one_time_component_changes(
+  auto stateMsg = ackMsg.mutable_state();
+  for (const auto &entity : entities)
+    this->dataPtr->ecm->AddEntityToMessage(*stateMsg, entity, {}, full);
+  stateMsg->set_has_one_time_component_changes(
     this->dataPtr->ecm->HasOneTimeComponentChanges());
 
-  this->stepAckPub.Publish(stateMsg);
+  this->stepAckPub.Publish(ackMsg);
 
   this->dataPtr->ecm->SetAllComponentsUnchanged();
 }
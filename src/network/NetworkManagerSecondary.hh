@@ -81,6 +81,14 @@ namespace ignition
 
       /// \brief Collection of performers associated with this secondary.
       private: std::unordered_set<Entity> performers;
+
+      /// \brief Number of steps acknowledged since the last one which
+      /// carried the full state of the performers.
+      private: unsigned int stepsSinceFullState{0};
+
+      /// \brief Whether a step with the full state of the performers has
+      /// been acknowledged yet.
+      private: bool fullStateSent{false};
     };
     }
   }  // namespace gazebo
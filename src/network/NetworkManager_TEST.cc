@@ -17,13 +17,20 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <cstdlib>
+#include <mutex>
+#include <vector>
 #include <ignition/common/Console.hh>
+#include <ignition/transport/Node.hh>
 
 #include "ignition/gazebo/EntityComponentManager.hh"
+#include "msgs/peer_control.pb.h"
+#include "msgs/simulation_step.pb.h"
 #include "NetworkManager.hh"
 #include "NetworkManagerPrimary.hh"
 #include "NetworkManagerSecondary.hh"
+#include "PeerTracker.hh"
 
 using namespace ignition::gazebo;
 
@@ -261,3 +268,92 @@ TEST(NetworkManager, Step)
 
   EXPECT_FALSE(running);
 }
+
+//////////////////////////////////////////////////
+TEST(NetworkManager, LostAck)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  EntityComponentManager ecm;
+
+  NetworkConfig confPrimary;
+  confPrimary.role = NetworkRole::SimulationPrimary;
+  confPrimary.numSecondariesExpected = 1;
+  confPrimary.maxStaleness = 5;
+
+  auto nmPrimary = NetworkManager::Create(step, ecm, nullptr, confPrimary);
+  ASSERT_NE(nullptr, nmPrimary);
+
+  // Secondary which doesn't acknowledge one of the steps
+  const uint64_t droppedSequence{3};
+  PeerInfo secondaryInfo(NetworkRole::SimulationSecondary);
+  PeerTracker secondaryTracker(secondaryInfo);
+  const auto prefix = secondaryInfo.id.substr(0, 8);
+
+  ignition::transport::Node node;
+  std::function<bool(const private_msgs::PeerControl &,
+      private_msgs::PeerControl &)> controlCb =
+      [](const private_msgs::PeerControl &_req,
+         private_msgs::PeerControl &_resp)
+      {
+        _resp.set_enable_sim(_req.enable_sim());
+        return true;
+      };
+  EXPECT_TRUE(node.Advertise(prefix + "/control", controlCb));
+
+  auto ackPub = node.Advertise<private_msgs::SimulationStepAck>("step_ack");
+
+  std::mutex mutex;
+  std::vector<uint64_t> resyncSequences;
+  std::function<void(const private_msgs::SimulationStep &)> stepCb =
+      [&](const private_msgs::SimulationStep &_msg)
+      {
+        bool resync = std::find(_msg.resync_prefix().begin(),
+            _msg.resync_prefix().end(), prefix) != _msg.resync_prefix().end();
+        if (resync)
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          resyncSequences.push_back(_msg.sequence());
+        }
+
+        if (_msg.sequence() == droppedSequence)
+          return;
+
+        private_msgs::SimulationStepAck ack;
+        ack.set_secondary_prefix(prefix);
+        ack.set_sequence(_msg.sequence());
+        ack.set_full_state(_msg.sequence() == 0 || resync);
+        ackPub.Publish(ack);
+      };
+  EXPECT_TRUE(node.Subscribe("step", stepCb));
+
+  for (int sleep = 0; sleep < 50 && !nmPrimary->Ready(); ++sleep)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+  }
+  ASSERT_TRUE(nmPrimary->Ready());
+
+  nmPrimary->Handshake();
+
+  using namespace std::chrono_literals;
+
+  auto info = UpdateInfo();
+  info.dt = std::chrono::steady_clock::duration{2ms};
+  info.paused = false;
+
+  // The later responses complete the step whose response was lost, so the
+  // primary doesn't wait for the timeout.
+  auto primary = static_cast<NetworkManagerPrimary *>(nmPrimary.get());
+  auto start = std::chrono::steady_clock::now();
+  for (info.iterations = 0; info.iterations < 20; ++info.iterations)
+  {
+    EXPECT_TRUE(primary->Step(info));
+    info.simTime += info.dt;
+  }
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);
+
+  // The secondary was asked for its full state after the lost response
+  std::lock_guard<std::mutex> lock(mutex);
+  ASSERT_FALSE(resyncSequences.empty());
+  EXPECT_GT(resyncSequences.front(), droppedSequence);
+}
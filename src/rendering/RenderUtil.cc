@@ -497,6 +497,33 @@ void RenderUtil::UpdateECM(const UpdateInfo &/*_info*/,
       });
 }
 
+//////////////////////////////////////////////////
+bool RenderUtil::UpdateECMRemovesComponents(
+    const EntityComponentManager &_ecm) const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->updateMutex);
+
+  // Commands from the last iteration
+  if (!this->dataPtr->particleCmdsToRemove.empty() ||
+      !this->dataPtr->entityLightsCmdToDelete.empty())
+  {
+    return true;
+  }
+
+  // Thermal camera properties
+  bool thermal{false};
+  _ecm.Each<components::ThermalCamera>(
+      [&](const Entity &_entity,
+        const components::ThermalCamera *)->bool
+      {
+        thermal =
+            _ecm.Component<components::TemperatureLinearResolution>(_entity)
+            || _ecm.Component<components::TemperatureRange>(_entity);
+        return !thermal;
+      });
+  return thermal;
+}
+
 //////////////////////////////////////////////////
 void RenderUtil::UpdateFromECM(const UpdateInfo &_info,
                                const EntityComponentManager &_ecm)
@@ -20,9 +20,18 @@
 #include <ignition/msgs/pose_v.pb.h>
 #include <ignition/msgs/log_playback_stats.pb.h>
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <regex>
 #include <set>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include <ignition/common/Filesystem.hh>
 #include <ignition/common/Profiler.hh>
@@ -33,6 +42,7 @@
 #include <ignition/transport/log/QueryOptions.hh>
 #include <ignition/transport/log/Log.hh>
 #include <ignition/transport/log/Message.hh>
+#include <ignition/transport/log/QualifiedTime.hh>
 
 #include <sdf/Geometry.hh>
 #include <sdf/Mesh.hh>
@@ -48,10 +58,22 @@
 #include "ignition/gazebo/components/Pose.hh"
 #include "ignition/gazebo/components/World.hh"
 
+#include "../../BlockCompression.hh"
+#include "LogRecord.hh"
+
 using namespace ignition;
 using namespace gazebo;
 using namespace systems;
 
+namespace
+{
+/// \brief Span of log time read by each prefetch query.
+constexpr std::chrono::nanoseconds kPrefetchWindow{std::chrono::seconds(10)};
+
+/// \brief Maximum number of messages read ahead.
+constexpr std::size_t kPrefetchCapacity{1000};
+}
+
 /// \brief Private LogPlayback data class.
 class ignition::gazebo::systems::LogPlaybackPrivate
 {
@@ -67,7 +89,11 @@ class ignition::gazebo::systems::LogPlaybackPrivate
   public: bool Start(EntityComponentManager &_ecm);
 
   /// \brief Replace URIs of resources in components with recorded path.
-  public: void ReplaceResourceURIs(EntityComponentManager &_ecm);
+  /// \param[in] _ecm Mutable ECM.
+  /// \param[in] _newOnly True to only replace the URIs of entities created
+  /// in this iteration.
+  public: void ReplaceResourceURIs(EntityComponentManager &_ecm,
+      bool _newOnly = false);
 
   /// \brief Prepend log path to mesh file path in the SDF element.
   /// \param[in] _uri URI of mesh in geometry
@@ -94,6 +120,63 @@ class ignition::gazebo::systems::LogPlaybackPrivate
   public: void Parse(EntityComponentManager &_ecm,
       const msgs::SerializedStateMap &_msg);
 
+  /// \brief A logged message, parsed. At most one of the messages is set,
+  /// none for messages which aren't played back, such as the SDF string.
+  public: struct ParsedMessage
+  {
+    /// \brief Time the message was recorded.
+    std::chrono::nanoseconds time;
+
+    /// \brief Poses.
+    std::unique_ptr<msgs::Pose_V> poses;
+
+    /// \brief State, from logs recorded by older versions.
+    std::unique_ptr<msgs::SerializedState> state;
+
+    /// \brief State.
+    std::unique_ptr<msgs::SerializedStateMap> stateMap;
+  };
+
+  /// \brief Decode and parse a logged message.
+  /// \param[in] _msg Logged message.
+  /// \param[out] _parsed Parsed message.
+  /// \return False if the message couldn't be parsed.
+  public: bool Parse(const transport::log::Message &_msg,
+      ParsedMessage &_parsed);
+
+  /// \brief Start reading ahead from the log.
+  /// \param[in] _dbPath Path to the log file.
+  public: void StartPrefetch(const std::string &_dbPath);
+
+  /// \brief Stop reading ahead and join the prefetch thread.
+  public: void StopPrefetch();
+
+  /// \brief Discard what was read ahead and continue reading after the
+  /// given time. Called after seeking.
+  /// \param[in] _time Messages after this time will be read.
+  public: void ResetPrefetch(const std::chrono::nanoseconds &_time);
+
+  /// \brief Take the messages read ahead up to the given time, waiting for
+  /// the prefetch thread to read them if needed.
+  /// \param[in] _time Time up to which to take messages, inclusive.
+  /// \param[out] _msgs Messages, in order.
+  public: void TakePrefetched(const std::chrono::nanoseconds &_time,
+      std::vector<ParsedMessage> &_msgs);
+
+  /// \brief Prefetch thread. Queries large windows of the log with its own
+  /// connection and parses the messages before they're needed.
+  /// \param[in] _dbPath Path to the log file.
+  public: void PrefetchLoop(const std::string &_dbPath);
+
+  /// \brief Get the type and data of a logged message, decompressing
+  /// messages which were compressed when recorded.
+  /// \param[in] _msg Logged message.
+  /// \param[out] _type Message type.
+  /// \param[out] _data Serialized message.
+  /// \return False if the message couldn't be decompressed.
+  public: bool Decode(const transport::log::Message &_msg, std::string &_type,
+      std::string &_data);
+
   /// \brief A batch of data from log file, of all pose messages
   public: transport::log::Batch batch;
 
@@ -128,6 +211,42 @@ class ignition::gazebo::systems::LogPlaybackPrivate
 
   // \brief Saves which particle emitter emitting components have changed
   public: std::unordered_map<Entity, bool> prevParticleEmitterCmds;
+
+  /// \brief Topic on which full state keyframes were recorded. Empty for
+  /// logs recorded without keyframes.
+  public: std::string keyframeTopic;
+
+  /// \brief Topic on which the time of each keyframe was recorded. Empty for
+  /// logs recorded without keyframes.
+  public: std::string keyframeIndexTopic;
+
+  /// \brief Sorted times of all keyframes in the log.
+  public: std::vector<std::chrono::nanoseconds> keyframeTimes;
+
+  /// \brief Thread which reads ahead from the log.
+  public: std::thread prefetchThread;
+
+  /// \brief Protects the prefetch state below.
+  public: std::mutex prefetchMutex;
+
+  /// \brief Signals changes to the prefetch state.
+  public: std::condition_variable prefetchCv;
+
+  /// \brief Messages read ahead, in order.
+  public: std::deque<ParsedMessage> prefetched;
+
+  /// \brief All messages up to this time have been read ahead.
+  public: std::chrono::nanoseconds prefetchedUntil{0};
+
+  /// \brief Time to continue reading after, set when seeking.
+  public: std::optional<std::chrono::nanoseconds> prefetchReset;
+
+  /// \brief Set to stop the prefetch thread.
+  public: bool stopPrefetch{false};
+
+  /// \brief End of the time range played by the last update. Steps which
+  /// continue from it are played from the prefetched messages.
+  public: std::optional<std::chrono::nanoseconds> playedUntil;
 };
 
 bool LogPlaybackPrivate::started{false};
@@ -141,6 +260,7 @@ LogPlayback::LogPlayback()
 //////////////////////////////////////////////////
 LogPlayback::~LogPlayback()
 {
+  this->dataPtr->StopPrefetch();
   if (!this->dataPtr->extDest.empty())
   {
     common::removeAll(this->dataPtr->extDest);
@@ -267,23 +387,50 @@ bool LogPlaybackPrivate::Start(EntityComponentManager &_ecm)
   // state of the world. Messages received before this are ignored.
   for (; iter != this->batch.end(); ++iter)
   {
-    auto msgType = iter->Type();
+    std::string msgType;
+    std::string data;
+    if (!this->Decode(*iter, msgType, data))
+      continue;
+
     if (msgType == "ignition.msgs.SerializedState")
     {
       msgs::SerializedState msg;
-      msg.ParseFromString(iter->Data());
+      msg.ParseFromString(data);
       this->Parse(_ecm, msg);
       break;
     }
     else if (msgType == "ignition.msgs.SerializedStateMap")
     {
       msgs::SerializedStateMap msg;
-      msg.ParseFromString(iter->Data());
+      msg.ParseFromString(data);
       this->Parse(_ecm, msg);
       break;
     }
   }
 
+  // Index keyframes, so seeking can start from the closest full state. Only
+  // the small index messages are read, the full states are loaded when
+  // seeking.
+  const std::string indexSuffix{"/keyframe_index"};
+  auto keyframes = this->log->QueryMessages(transport::log::TopicPattern(
+      std::regex(".*" + indexSuffix)));
+  for (const auto &msg : keyframes)
+  {
+    this->keyframeIndexTopic = msg.Topic();
+    this->keyframeTimes.push_back(msg.TimeReceived());
+  }
+  if (!this->keyframeIndexTopic.empty())
+  {
+    this->keyframeTopic = this->keyframeIndexTopic.substr(0,
+        this->keyframeIndexTopic.size() - indexSuffix.size()) +
+        "/keyframe_state";
+  }
+  if (!this->keyframeTimes.empty())
+  {
+    igndbg << "Found [" << this->keyframeTimes.size() << "] keyframes on ["
+           << this->keyframeTopic << "]" << std::endl;
+  }
+
   msgs::LogPlaybackStatistics logStats;
   auto startTime = convert<msgs::Time>(this->log->StartTime());
   auto endTime = convert<msgs::Time>(this->log->EndTime());
@@ -314,13 +461,236 @@ bool LogPlaybackPrivate::Start(EntityComponentManager &_ecm)
 
   this->ReplaceResourceURIs(_ecm);
 
+  this->StartPrefetch(dbPath);
+
   this->instStarted = true;
   LogPlaybackPrivate::started = true;
   return true;
 }
 
 //////////////////////////////////////////////////
-void LogPlaybackPrivate::ReplaceResourceURIs(EntityComponentManager &_ecm)
+bool LogPlaybackPrivate::Decode(const transport::log::Message &_msg,
+    std::string &_type, std::string &_data)
+{
+  _type = _msg.Type();
+
+  const std::string suffix{kCompressedTypeSuffix};
+  if (_type.size() <= suffix.size() ||
+      _type.compare(_type.size() - suffix.size(), suffix.size(), suffix) != 0)
+  {
+    _data = _msg.Data();
+    return true;
+  }
+
+  _type.erase(_type.size() - suffix.size());
+  if (!DecompressBlock(_msg.Data(), _data))
+  {
+    ignerr << "Failed to decompress message of type [" << _type
+           << "] on topic [" << _msg.Topic() << "]" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool LogPlaybackPrivate::Parse(const transport::log::Message &_msg,
+    ParsedMessage &_parsed)
+{
+  std::string msgType;
+  std::string data;
+  if (!this->Decode(_msg, msgType, data))
+    return false;
+
+  _parsed.time = _msg.TimeReceived();
+  if (msgType == "ignition.msgs.Pose_V")
+  {
+    _parsed.poses = std::make_unique<msgs::Pose_V>();
+    _parsed.poses->ParseFromString(data);
+  }
+  else if (msgType == "ignition.msgs.SerializedState")
+  {
+    _parsed.state = std::make_unique<msgs::SerializedState>();
+    _parsed.state->ParseFromString(data);
+  }
+  else if (msgType == "ignition.msgs.SerializedStateMap")
+  {
+    _parsed.stateMap = std::make_unique<msgs::SerializedStateMap>();
+    _parsed.stateMap->ParseFromString(data);
+  }
+  else if (msgType == "ignition.msgs.StringMsg")
+  {
+    // Do nothing, we assume this is the SDF string
+  }
+  else
+  {
+    ignwarn << "Trying to playback unsupported message type ["
+            << msgType << "]" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+void LogPlaybackPrivate::StartPrefetch(const std::string &_dbPath)
+{
+  this->prefetchThread = std::thread(&LogPlaybackPrivate::PrefetchLoop, this,
+      _dbPath);
+}
+
+//////////////////////////////////////////////////
+void LogPlaybackPrivate::StopPrefetch()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->prefetchMutex);
+    this->stopPrefetch = true;
+  }
+  this->prefetchCv.notify_all();
+  if (this->prefetchThread.joinable())
+    this->prefetchThread.join();
+}
+
+//////////////////////////////////////////////////
+void LogPlaybackPrivate::ResetPrefetch(const std::chrono::nanoseconds &_time)
+{
+  {
+    std::lock_guard<std::mutex> lock(this->prefetchMutex);
+    this->prefetched.clear();
+    this->prefetchedUntil = _time;
+    this->prefetchReset = _time;
+  }
+  this->prefetchCv.notify_all();
+}
+
+//////////////////////////////////////////////////
+void LogPlaybackPrivate::TakePrefetched(const std::chrono::nanoseconds &_time,
+    std::vector<ParsedMessage> &_msgs)
+{
+  std::unique_lock<std::mutex> lock(this->prefetchMutex);
+  while (true)
+  {
+    while (!this->prefetched.empty() &&
+        this->prefetched.front().time <= _time)
+    {
+      _msgs.push_back(std::move(this->prefetched.front()));
+      this->prefetched.pop_front();
+    }
+
+    if (this->prefetchedUntil >= _time || this->stopPrefetch ||
+        !this->prefetchThread.joinable())
+    {
+      break;
+    }
+
+    // Let the prefetch thread refill
+    this->prefetchCv.notify_all();
+    this->prefetchCv.wait(lock);
+  }
+  this->prefetchCv.notify_all();
+}
+
+//////////////////////////////////////////////////
+void LogPlaybackPrivate::PrefetchLoop(const std::string &_dbPath)
+{
+  // A separate connection, so the simulation thread can keep querying the
+  // log when seeking
+  transport::log::Log prefetchLog;
+  if (!prefetchLog.Open(_dbPath))
+  {
+    ignerr << "Failed to open log file [" << _dbPath << "] for reading ahead"
+           << std::endl;
+    std::lock_guard<std::mutex> lock(this->prefetchMutex);
+    this->stopPrefetch = true;
+    this->prefetchCv.notify_all();
+    return;
+  }
+  const auto logEnd = prefetchLog.EndTime();
+
+  std::chrono::nanoseconds cursor{0};
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(this->prefetchMutex);
+      if (this->prefetchReset)
+      {
+        cursor = *this->prefetchReset;
+        this->prefetchReset.reset();
+      }
+
+      // Nothing left to read until playback seeks
+      if (cursor >= logEnd)
+      {
+        this->prefetchedUntil = std::chrono::nanoseconds::max();
+        this->prefetchCv.notify_all();
+        this->prefetchCv.wait(lock, [this]
+        {
+          return this->stopPrefetch || this->prefetchReset.has_value();
+        });
+      }
+
+      if (this->stopPrefetch)
+        return;
+      if (this->prefetchReset)
+        continue;
+    }
+
+    const auto windowEnd = cursor + kPrefetchWindow;
+    auto batch = prefetchLog.QueryMessages(transport::log::AllTopics(
+        transport::log::QualifiedTimeRange(
+        transport::log::QualifiedTime(cursor,
+            transport::log::QualifiedTime::Qualifier::EXCLUSIVE),
+        transport::log::QualifiedTime(windowEnd))));
+
+    bool reset{false};
+    for (const auto &msg : batch)
+    {
+      // Keyframes duplicate the changed states, they're only used to seek
+      if (!this->keyframeTopic.empty() &&
+          (msg.Topic() == this->keyframeTopic ||
+           msg.Topic() == this->keyframeIndexTopic))
+      {
+        continue;
+      }
+
+      ParsedMessage parsed;
+      if (!this->Parse(msg, parsed))
+        continue;
+
+      std::unique_lock<std::mutex> lock(this->prefetchMutex);
+      this->prefetchCv.wait(lock, [this]
+      {
+        return this->stopPrefetch || this->prefetchReset.has_value() ||
+            this->prefetched.size() < kPrefetchCapacity;
+      });
+      if (this->stopPrefetch)
+        return;
+      if (this->prefetchReset)
+      {
+        reset = true;
+        break;
+      }
+
+      // Everything before this message has been read
+      this->prefetchedUntil = parsed.time - std::chrono::nanoseconds(1);
+      this->prefetched.push_back(std::move(parsed));
+      this->prefetchCv.notify_all();
+    }
+
+    if (reset)
+      continue;
+
+    std::lock_guard<std::mutex> lock(this->prefetchMutex);
+    if (!this->prefetchReset)
+    {
+      this->prefetchedUntil = windowEnd;
+      this->prefetchCv.notify_all();
+    }
+    cursor = windowEnd;
+  }
+}
+
+//////////////////////////////////////////////////
+void LogPlaybackPrivate::ReplaceResourceURIs(EntityComponentManager &_ecm,
+    bool _newOnly)
 {
   // For backward compatibility with log files recorded in older versions of
   //   plugin, do not prepend resource paths with logPath.
@@ -356,7 +726,7 @@ void LogPlaybackPrivate::ReplaceResourceURIs(EntityComponentManager &_ecm)
   // Loop through geometries in world. Prepend log path to URI
   // TODO(anyone): When merge forward to Citadel, handle actor skin and
   // animation files
-  _ecm.Each<components::Geometry>(
+  auto replaceGeometryUri =
       [&](const Entity &/*_entity*/, components::Geometry *_geoComp) -> bool
   {
     sdf::Geometry geoSdf = _geoComp->Data();
@@ -376,10 +746,10 @@ void LogPlaybackPrivate::ReplaceResourceURIs(EntityComponentManager &_ecm)
     }
 
     return true;
-  });
+  };
 
   // Loop through materials in world. Prepend log path to URI
-  _ecm.Each<components::Material>(
+  auto replaceMaterialUri =
       [&](const Entity &/*_entity*/, components::Material *_matComp) -> bool
   {
     sdf::Material matSdf = _matComp->Data();
@@ -393,7 +763,18 @@ void LogPlaybackPrivate::ReplaceResourceURIs(EntityComponentManager &_ecm)
     }
 
     return true;
-  });
+  };
+
+  if (_newOnly)
+  {
+    _ecm.EachNew<components::Geometry>(replaceGeometryUri);
+    _ecm.EachNew<components::Material>(replaceMaterialUri);
+  }
+  else
+  {
+    _ecm.Each<components::Geometry>(replaceGeometryUri);
+    _ecm.Each<components::Material>(replaceMaterialUri);
+  }
 }
 
 //////////////////////////////////////////////////
@@ -488,37 +869,51 @@ void LogPlayback::Update(const UpdateInfo &_info, EntityComponentManager &_ecm)
     return;
 
   // Get all messages from this timestep
-  // TODO(anyone) Jumping forward can be expensive for long jumps. For now,
-  // just playing every single step so we don't miss insertions and deletions.
   auto startTime = _info.simTime - _info.dt;
   auto endTime = _info.simTime;
 
-  bool seekRewind = false;
-  std::set<Entity> entitiesToRemove;
-  if (_info.dt < std::chrono::steady_clock::duration::zero())
+  // Each serialized state is a changed state and not an absolute state, so
+  // we need to play every single step to not miss insertions and deletions.
+  // When seeking, i.e. rewinding or jumping forward past what's read ahead,
+  // start from the latest keyframe, i.e. full state, within the range to be
+  // played instead, if the log has one.
+  const bool rewind = _info.dt < std::chrono::steady_clock::duration::zero();
+  const bool jump = rewind || _info.dt >= kPrefetchWindow;
+  std::optional<std::chrono::nanoseconds> keyframe;
+  auto keyframeIt = std::upper_bound(this->dataPtr->keyframeTimes.begin(),
+      this->dataPtr->keyframeTimes.end(), endTime);
+  if (jump && keyframeIt != this->dataPtr->keyframeTimes.begin())
   {
-    // Detected jumping back in time. This can be expensive.
-    // To rewind / seek backward in time, we also need to play every single
-    // step from the beginning so we don't miss insertions and deletions
-    // This is because each serialized state is a changed state and not an
-    // absolute state.
-    // todo(anyone) Record absolute states during recording, i.e. key frames,
-    // so that playback can jump to these states without the need to
-    // incrementally build the states from the beginning
+    --keyframeIt;
+    if (rewind || *keyframeIt > startTime)
+      keyframe = *keyframeIt;
+  }
+
+  // Steps which continue from the previous one are played from the messages
+  // read ahead.
+  const bool contiguous = !jump && this->dataPtr->playedUntil &&
+      *this->dataPtr->playedUntil == startTime;
+  this->dataPtr->playedUntil = endTime;
 
+  bool seek = false;
+  std::set<Entity> entitiesToRemove;
+  if (!contiguous && (rewind || keyframe))
+  {
     // Create a list of entities to be removed. The list will be updated later
     // as the log steps forward below
-    seekRewind = true;
+    seek = true;
     const auto &entities = _ecm.Entities().Vertices();
     for (const auto &entity : entities)
       entitiesToRemove.insert(Entity(entity.first));
 
-    startTime = std::chrono::steady_clock::duration::zero();
+    // Without keyframes, seeking backward in time needs to play every single
+    // step from the beginning. This can be expensive.
+    if (keyframe)
+      startTime = *keyframe;
+    else
+      startTime = std::chrono::steady_clock::duration::zero();
   }
 
-  this->dataPtr->batch = this->dataPtr->log->QueryMessages(
-      transport::log::AllTopics({startTime, endTime}));
-
   msgs::Pose_V queuedPose;
 
   // If new pose updates are received, make sure that only the cached poses
@@ -534,34 +929,28 @@ void LogPlayback::Update(const UpdateInfo &_info, EntityComponentManager &_ecm)
   // is called).
   bool clearCachedPoseUpdates = true;
 
-  auto iter = this->dataPtr->batch.begin();
-  while (iter != this->dataPtr->batch.end())
+  auto play = [&](LogPlaybackPrivate::ParsedMessage &_msg)
   {
-    auto msgType = iter->Type();
-
     // Only set the last pose of a sequence of poses.
-    if (msgType != "ignition.msgs.Pose_V" && queuedPose.pose_size() > 0)
+    if (!_msg.poses && queuedPose.pose_size() > 0)
     {
       this->dataPtr->Parse(queuedPose, clearCachedPoseUpdates);
       queuedPose.Clear();
     }
 
-    if (msgType == "ignition.msgs.Pose_V")
+    if (_msg.poses)
     {
       // Queue poses to be set later
-      queuedPose.ParseFromString(iter->Data());
+      queuedPose.Swap(_msg.poses.get());
     }
-    else if (msgType == "ignition.msgs.SerializedState")
+    else if (_msg.state)
     {
-      msgs::SerializedState msg;
-      msg.ParseFromString(iter->Data());
-
-      // For seeking back in time only:
+      // For seeking only:
       // While stepping, update the list of entities to be removed
       // so we do not remove any entities that are to be created
-      if (seekRewind)
+      if (seek)
       {
-        for (const auto &entIt : msg.entities())
+        for (const auto &entIt : _msg.state->entities())
         {
           Entity entity{entIt.id()};
           if (entIt.remove())
@@ -575,19 +964,16 @@ void LogPlayback::Update(const UpdateInfo &_info, EntityComponentManager &_ecm)
         }
       }
 
-      this->dataPtr->Parse(_ecm, msg);
+      this->dataPtr->Parse(_ecm, *_msg.state);
     }
-    else if (msgType == "ignition.msgs.SerializedStateMap")
+    else if (_msg.stateMap)
     {
-      msgs::SerializedStateMap msg;
-      msg.ParseFromString(iter->Data());
-
-      // For seeking back in time only:
+      // For seeking only:
       // While stepping, update the list of entities to be removed
       // so we do not remove any entities that are to be created
-      if (seekRewind)
+      if (seek)
       {
-        for (const auto &entIt : msg.entities())
+        for (const auto &entIt : _msg.stateMap->entities())
         {
           const auto &entityMsg = entIt.second;
           Entity entity{entityMsg.id()};
@@ -602,19 +988,41 @@ void LogPlayback::Update(const UpdateInfo &_info, EntityComponentManager &_ecm)
         }
       }
 
-      this->dataPtr->Parse(_ecm, msg);
+      this->dataPtr->Parse(_ecm, *_msg.stateMap);
     }
-    else if (msgType == "ignition.msgs.StringMsg")
-    {
-      // Do nothing, we assume this is the SDF string
-    }
-    else
+  };
+
+  if (contiguous)
+  {
+    std::vector<LogPlaybackPrivate::ParsedMessage> msgs;
+    this->dataPtr->TakePrefetched(endTime, msgs);
+    for (auto &msg : msgs)
+      play(msg);
+  }
+  else
+  {
+    this->dataPtr->batch = this->dataPtr->log->QueryMessages(
+        transport::log::AllTopics({startTime, endTime}));
+
+    for (const auto &msg : this->dataPtr->batch)
     {
-      ignwarn << "Trying to playback unsupported message type ["
-              << msgType << "]" << std::endl;
+      // Keyframes duplicate the changed states, only the one we're seeking
+      // from needs to be applied.
+      if (!this->dataPtr->keyframeTopic.empty() &&
+          (msg.Topic() == this->dataPtr->keyframeIndexTopic ||
+           (msg.Topic() == this->dataPtr->keyframeTopic &&
+            (!keyframe || msg.TimeReceived() != *keyframe))))
+      {
+        continue;
+      }
+
+      LogPlaybackPrivate::ParsedMessage parsed;
+      if (this->dataPtr->Parse(msg, parsed))
+        play(parsed);
     }
-    this->dataPtr->ReplaceResourceURIs(_ecm);
-    ++iter;
+
+    // Continue reading ahead from here
+    this->dataPtr->ResetPrefetch(endTime);
   }
 
   if (queuedPose.pose_size() > 0)
@@ -622,6 +1030,10 @@ void LogPlayback::Update(const UpdateInfo &_info, EntityComponentManager &_ecm)
     this->dataPtr->Parse(queuedPose, clearCachedPoseUpdates);
   }
 
+  // Fix the resource URIs of the entities created by the played states.
+  // Seeking may overwrite the components of existing entities too.
+  this->dataPtr->ReplaceResourceURIs(_ecm, contiguous);
+
   // flag changed entity poses as periodically changed based on
   // the latest LogPlaybackPrivate::Parse results
   _ecm.Each<components::Pose>(
@@ -665,7 +1077,7 @@ void LogPlayback::Update(const UpdateInfo &_info, EntityComponentManager &_ecm)
     return true;
   });
 
-  // for seek back in time only
+  // for seeking only
   // remove entities that should not be present in the current time step
   for (auto entity : entitiesToRemove)
   {
@@ -19,12 +19,21 @@
 
 #include <sys/stat.h>
 #include <ignition/msgs/stringmsg.pb.h>
+#include <ignition/msgs/time.pb.h>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <string>
 #include <fstream>
 #include <ctime>
+#include <mutex>
+#include <optional>
+#include <regex>
 #include <set>
 #include <list>
+#include <thread>
+#include <vector>
 
 #include <ignition/common/Console.hh>
 #include <ignition/common/Filesystem.hh>
@@ -36,7 +45,6 @@
 #include <ignition/plugin/Register.hh>
 #include <ignition/transport/Node.hh>
 #include <ignition/transport/log/Log.hh>
-#include <ignition/transport/log/Recorder.hh>
 
 #include <sdf/Collision.hh>
 #include <sdf/Element.hh>
@@ -59,12 +67,25 @@
 #include "ignition/gazebo/components/Visual.hh"
 #include "ignition/gazebo/components/World.hh"
 
+#include "ignition/gazebo/Conversions.hh"
 #include "ignition/gazebo/Util.hh"
 
+#include "../../BlockCompression.hh"
+
 using namespace ignition;
 using namespace ignition::gazebo;
 using namespace ignition::gazebo::systems;
 
+namespace
+{
+/// \brief Number of queued log messages above which a warning is printed.
+constexpr std::size_t kQueueWarnSize{10000};
+
+/// \brief Period at which new topics are matched against the recorded
+/// patterns.
+constexpr std::chrono::milliseconds kTopicDiscoveryPeriod{50};
+}
+
 // Private data class.
 class ignition::gazebo::systems::LogRecordPrivate
 {
@@ -105,6 +126,63 @@ class ignition::gazebo::systems::LogRecordPrivate
   /// \brief Compress model resource files and state file into one file.
   public: void CompressStateAndResources();
 
+  /// \brief Queue a message to be written to the log. The message is
+  /// serialized by the writer thread.
+  /// \param[in] _time Sim time to stamp the message with.
+  /// \param[in] _topic Topic to record the message under.
+  /// \param[in] _msg Message to write.
+  /// \param[in] _compress True to compress the message with the state
+  /// codec.
+  public: void Write(const std::chrono::steady_clock::duration &_time,
+      const std::string &_topic,
+      std::unique_ptr<google::protobuf::Message> _msg,
+      bool _compress = false);
+
+  /// \brief Subscribe to an external topic, so its messages are written to
+  /// the log.
+  /// \param[in] _topic Topic name.
+  public: void RecordTopic(const std::string &_topic);
+
+  /// \brief Subscribe to the topics which appeared since the last call and
+  /// match one of the recorded patterns.
+  public: void DiscoverTopics();
+
+  /// \brief Write queued messages to the log until stopped. Also subscribes
+  /// to new topics matching the recorded patterns.
+  public: void WriteLoop();
+
+  /// \brief Stop recording external topics, write what's left in the queue
+  /// and close the log.
+  public: void Stop();
+
+  /// \brief Message waiting to be written to the log.
+  public: struct LogEntry
+  {
+    /// \brief Sim time the message is stamped with.
+    std::chrono::nanoseconds time;
+
+    /// \brief Topic the message is recorded under.
+    std::string topic;
+
+    /// \brief Message type, filled by the writer thread for messages.
+    std::string type;
+
+    /// \brief Serialized message, filled by the writer thread for messages.
+    std::string data;
+
+    /// \brief Message to serialize, null for external messages which are
+    /// received serialized.
+    std::unique_ptr<google::protobuf::Message> msg;
+
+    /// \brief True to compress the message with the state codec.
+    bool compress{false};
+  };
+
+  /// \brief Add an entry to the queue and wake up the writer thread. Warns
+  /// if the queue keeps growing because the writer can't keep up.
+  /// \param[in] _entry Entry to write.
+  public: void Enqueue(LogEntry &&_entry);
+
   /// \brief Indicator of whether any recorder instance has ever been started.
   /// Currently, only one instance is allowed. This enforcement may be removed
   /// in the future.
@@ -113,8 +191,62 @@ class ignition::gazebo::systems::LogRecordPrivate
   /// \brief Indicator of whether this instance has been started
   public: bool instStarted{false};
 
-  /// \brief Ignition transport recorder
-  public: transport::log::Recorder recorder;
+  /// \brief Log file, only accessed by the writer thread once recording
+  /// started.
+  public: std::unique_ptr<transport::log::Log> log;
+
+  /// \brief Thread which writes to the log, so that serialization and disk
+  /// access don't slow down simulation.
+  public: std::thread writerThread;
+
+  /// \brief Messages waiting to be written.
+  public: std::vector<LogEntry> queue;
+
+  /// \brief Queue size above which the next warning about the writer
+  /// falling behind is printed. Doubled after each warning.
+  public: std::size_t queueWarnSize{kQueueWarnSize};
+
+  /// \brief Protects queue, queueWarnSize and stopWriter.
+  public: std::mutex queueMutex;
+
+  /// \brief Wakes up the writer thread.
+  public: std::condition_variable queueCv;
+
+  /// \brief Tells the writer thread to finish.
+  public: bool stopWriter{false};
+
+  /// \brief Patterns of external topics to record.
+  public: std::vector<std::regex> topicPatterns;
+
+  /// \brief Topics already matched against topicPatterns.
+  public: std::set<std::string> discoveredTopics;
+
+  /// \brief External topics being recorded.
+  public: std::set<std::string> recordedTopics;
+
+  /// \brief True once recording stopped, after which no more topics are
+  /// subscribed to. Protected by recordedTopicsMutex.
+  public: bool topicsStopped{false};
+
+  /// \brief Protects recordedTopics.
+  public: std::mutex recordedTopicsMutex;
+
+  /// \brief Topics written directly by this system, which aren't recorded
+  /// through transport even if they match a pattern.
+  public: std::set<std::string> directTopics;
+
+  /// \brief Topic for the SDF string.
+  public: std::string sdfTopic;
+
+  /// \brief Topic for state changes.
+  public: std::string stateTopic;
+
+  /// \brief Topic for full state keyframes.
+  public: std::string keyframeTopic;
+
+  /// \brief Topic with the time of each keyframe, so playback can index
+  /// keyframes without reading them.
+  public: std::string keyframeIndexTopic;
 
   /// \brief Directory in which to place log file
   public: std::string logPath{""};
@@ -122,12 +254,12 @@ class ignition::gazebo::systems::LogRecordPrivate
   /// \brief File path to write compressed file
   public: std::string cmpPath{""};
 
-  /// \brief Clock used to timestamp recorded messages with sim time.
+  /// \brief Sim time in nanoseconds, used to timestamp external messages.
   /// This is not the timestamp on the header, rather a logging-specific stamp.
   /// This stamp is used by LogPlayback to step through logs.
   /// In case there's disagreement between these stamps, the one in the
   /// header should be the most accurate.
-  public: std::unique_ptr<transport::NetworkClock> clock;
+  public: std::atomic<int64_t> simTime{0};
 
   /// \brief Name of this world
   public: std::string worldName{""};
@@ -135,7 +267,8 @@ class ignition::gazebo::systems::LogRecordPrivate
   /// \brief SDF of this plugin
   public: std::shared_ptr<const sdf::Element> sdf{nullptr};
 
-  /// \brief Transport node for publishing SDF string to be recorded
+  /// \brief Transport node for publishing the recorded messages to other
+  /// subscribers, and for recording external topics.
   public: transport::Node node;
 
   /// \brief Publisher for SDF string
@@ -144,6 +277,20 @@ class ignition::gazebo::systems::LogRecordPrivate
   /// \brief Publisher for state changes
   public: transport::Node::Publisher statePub;
 
+  /// \brief Publisher for full state keyframes
+  public: transport::Node::Publisher keyframePub;
+
+  /// \brief Whether keyframes are recorded.
+  public: bool recordKeyframes{false};
+
+  /// \brief Sim time between full state keyframes. Zero, the default,
+  /// disables keyframes.
+  public: std::chrono::steady_clock::duration keyframePeriod{
+      std::chrono::steady_clock::duration::zero()};
+
+  /// \brief Sim time of the last keyframe, if any was recorded.
+  public: std::optional<std::chrono::steady_clock::duration> lastKeyframe;
+
   /// \brief Message holding SDF string of world
   public: msgs::StringMsg sdfMsg;
 
@@ -156,6 +303,9 @@ class ignition::gazebo::systems::LogRecordPrivate
   /// \brief Compress log files at the end
   public: bool compress{false};
 
+  /// \brief Codec used to compress each state message.
+  public: BlockCodec stateCodec{BlockCodec::NONE};
+
   /// \brief List of saved models if record with resources is enabled.
   public: std::set<std::string> savedModels;
 };
@@ -186,8 +336,7 @@ LogRecord::~LogRecord()
 {
   if (this->dataPtr->instStarted)
   {
-    // Use ign-transport directly
-    this->dataPtr->recorder.Stop();
+    this->dataPtr->Stop();
 
     if (this->dataPtr->compress)
       this->dataPtr->CompressStateAndResources();
@@ -211,6 +360,36 @@ void LogRecord::Configure(const Entity &_entity,
     false).first);
 
   this->dataPtr->compress = _sdf->Get<bool>("compress", false).first;
+
+  auto stateCompression = _sdf->Get<std::string>("state_compression",
+      "none").first;
+  if (!BlockCodecFromName(stateCompression, this->dataPtr->stateCodec))
+  {
+    ignwarn << "Unknown <state_compression> [" << stateCompression
+            << "], must be one of none, lz and zstd. States will not be "
+            << "compressed." << std::endl;
+    this->dataPtr->stateCodec = BlockCodec::NONE;
+  }
+  else if (!BlockCodecAvailable(this->dataPtr->stateCodec))
+  {
+    ignwarn << "<state_compression> [" << stateCompression
+            << "] isn't available in this build, using [lz] instead."
+            << std::endl;
+    this->dataPtr->stateCodec = BlockCodec::LZ;
+  }
+
+  auto keyframePeriod = _sdf->Get<double>("keyframe_period",
+      std::chrono::duration<double>(this->dataPtr->keyframePeriod).count());
+  if (keyframePeriod.first < 0.0)
+  {
+    ignwarn << "Invalid <keyframe_period> [" << keyframePeriod.first
+            << "], must be non-negative. Keyframes will not be recorded."
+            << std::endl;
+    keyframePeriod.first = 0.0;
+  }
+  this->dataPtr->keyframePeriod =
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(keyframePeriod.first));
   this->dataPtr->cmpPath = _sdf->Get<std::string>("compress_path", "").first;
 
   // If plugin is specified in both the SDF tag and on command line, only
@@ -287,6 +466,7 @@ bool LogRecordPrivate::Start(const std::string &_logPath,
   auto validSdfTopic = transport::TopicUtils::AsValidTopic(sdfTopic);
   if (!validSdfTopic.empty())
   {
+    this->sdfTopic = validSdfTopic;
     this->sdfPub = this->node.Advertise(validSdfTopic,
         this->sdfMsg.GetTypeName());
   }
@@ -301,6 +481,7 @@ bool LogRecordPrivate::Start(const std::string &_logPath,
   auto validStateTopic = transport::TopicUtils::AsValidTopic(stateTopic);
   if (!validStateTopic.empty())
   {
+    this->stateTopic = validStateTopic;
     this->statePub = this->node.Advertise<msgs::SerializedStateMap>(
         validStateTopic);
   }
@@ -310,6 +491,29 @@ bool LogRecordPrivate::Start(const std::string &_logPath,
            << stateTopic << "]." << std::endl;
   }
 
+  // Full states are recorded on their own topic, so playback can find them
+  // without going through the changed states.
+  std::string keyframeTopic = "/world/" + this->worldName + "/keyframe_state";
+  auto validKeyframeTopic = transport::TopicUtils::AsValidTopic(keyframeTopic);
+  auto validKeyframeIndexTopic = transport::TopicUtils::AsValidTopic(
+      "/world/" + this->worldName + "/keyframe_index");
+  if (this->keyframePeriod > std::chrono::steady_clock::duration::zero())
+  {
+    if (!validKeyframeTopic.empty() && !validKeyframeIndexTopic.empty())
+    {
+      this->keyframeTopic = validKeyframeTopic;
+      this->keyframeIndexTopic = validKeyframeIndexTopic;
+      this->keyframePub = this->node.Advertise<msgs::SerializedStateMap>(
+          validKeyframeTopic);
+      this->recordKeyframes = true;
+    }
+    else
+    {
+      ignerr << "Failed to generate valid topic to publish keyframes. Tried ["
+             << keyframeTopic << "]." << std::endl;
+    }
+  }
+
   // Append file name
   std::string dbPath = common::joinPaths(this->logPath, "state.tlog");
   if (common::exists(dbPath))
@@ -319,16 +523,37 @@ bool LogRecordPrivate::Start(const std::string &_logPath,
   }
   ignmsg << "Recording to log file [" << dbPath << "]" << std::endl;
 
+  // This loads the sql schema
+  this->log = std::make_unique<transport::log::Log>();
+  if (!this->log->Open(dbPath, std::ios_base::out))
+  {
+    ignerr << "Failed to open log file [" << dbPath << "]. "
+           << "Recording will not take place." << std::endl;
+    this->log.reset();
+    return false;
+  }
+
+  // The SDF and the state are written directly, without going through
+  // transport
+  igndbg << "Recording default topic[" << this->sdfTopic << "].\n";
+  igndbg << "Recording default topic[" << this->stateTopic << "].\n";
+  this->directTopics.insert(this->sdfTopic);
+  this->directTopics.insert(this->stateTopic);
+  if (this->recordKeyframes)
+  {
+    igndbg << "Recording default topic[" << this->keyframeTopic << "].\n";
+    igndbg << "Recording default topic[" << this->keyframeIndexTopic
+           << "].\n";
+    this->directTopics.insert(this->keyframeTopic);
+    this->directTopics.insert(this->keyframeIndexTopic);
+  }
+
   // Add default topics if no topics were specified.
   std::string dynPoseTopic = "/world/" + this->worldName +
     "/dynamic_pose/info";
 
   igndbg << "Recording default topic[" << dynPoseTopic << "].\n";
-  igndbg << "Recording default topic[" << sdfTopic << "].\n";
-  igndbg << "Recording default topic[" << stateTopic << "].\n";
-  this->recorder.AddTopic(dynPoseTopic);
-  this->recorder.AddTopic(sdfTopic);
-  this->recorder.AddTopic(stateTopic);
+  this->RecordTopic(dynPoseTopic);
 
   // Get the topics to record, if any.
   if (this->sdf->HasElement("record_topic"))
@@ -343,35 +568,209 @@ bool LogRecordPrivate::Start(const std::string &_logPath,
       std::string topic = recordTopicElem->Get<std::string>();
       if (std::regex_match(topic, regexMatch))
       {
-        this->recorder.AddTopic(std::regex(topic));
+        // Topics matching the pattern are subscribed to as they're
+        // discovered, see DiscoverTopics
+        this->topicPatterns.emplace_back(topic);
         igndbg << "Recording topic[" << topic << "] as regular expression.\n";
       }
       else
       {
-        this->recorder.AddTopic(topic);
+        this->RecordTopic(topic);
         igndbg << "Recording topic[" << topic << "] as plain topic.\n";
       }
       recordTopicElem = recordTopicElem->GetNextElement("record_topic");
     }
   }
 
-  // Timestamp messages with sim time and republish that time on
-  // a ~/log/clock topic (which we don't really need).
-  // Note that the message headers should also have a timestamp
-  auto clockTopic = "/world/" + this->worldName + "/log/clock";
-  this->clock = std::make_unique<transport::NetworkClock>(clockTopic,
-      transport::NetworkClock::TimeBase::SIM);
-  this->recorder.Sync(this->clock.get());
+  // Subscribe to matching topics which already exist before the first step
+  // is recorded, the writer thread picks up those which appear later
+  this->DiscoverTopics();
 
-  // This calls Log::Open() and loads sql schema
-  if (this->recorder.Start(dbPath) ==
-      ignition::transport::log::RecorderError::SUCCESS)
+  this->writerThread = std::thread(&LogRecordPrivate::WriteLoop, this);
+  this->instStarted = true;
+  return true;
+}
+
+//////////////////////////////////////////////////
+void LogRecordPrivate::Write(const std::chrono::steady_clock::duration &_time,
+    const std::string &_topic, std::unique_ptr<google::protobuf::Message> _msg,
+    bool _compress)
+{
+  LogEntry entry;
+  entry.time = std::chrono::duration_cast<std::chrono::nanoseconds>(_time);
+  entry.topic = _topic;
+  entry.msg = std::move(_msg);
+  entry.compress = _compress && this->stateCodec != BlockCodec::NONE;
+
+  this->Enqueue(std::move(entry));
+}
+
+//////////////////////////////////////////////////
+void LogRecordPrivate::Enqueue(LogEntry &&_entry)
+{
   {
-    this->instStarted = true;
-    return true;
+    std::lock_guard<std::mutex> lock(this->queueMutex);
+    this->queue.push_back(std::move(_entry));
+
+    // Messages aren't dropped, but memory grows while the disk can't keep
+    // up
+    if (this->queue.size() >= this->queueWarnSize)
+    {
+      ignwarn << "[" << this->queue.size() << "] messages waiting to be "
+              << "written to the log, the disk may be too slow for the "
+              << "recorded topics." << std::endl;
+      this->queueWarnSize *= 2;
+    }
+  }
+  this->queueCv.notify_one();
+}
+
+//////////////////////////////////////////////////
+void LogRecordPrivate::RecordTopic(const std::string &_topic)
+{
+  if (this->directTopics.count(_topic) > 0)
+    return;
+
+  // Hold the lock while subscribing, so the writer thread can't subscribe
+  // to a newly discovered topic after Stop unsubscribed from all of them
+  std::lock_guard<std::mutex> lock(this->recordedTopicsMutex);
+  if (this->topicsStopped || !this->recordedTopics.insert(_topic).second)
+    return;
+
+  // External messages are already serialized, and stamped with the sim time
+  // at which they're received
+  std::function<void(const char *, const std::size_t,
+      const transport::MessageInfo &)> cb =
+      [this](const char *_data, const std::size_t _size,
+      const transport::MessageInfo &_info)
+  {
+    LogEntry entry;
+    entry.time = std::chrono::nanoseconds(this->simTime.load());
+    entry.topic = _info.Topic();
+    entry.type = _info.Type();
+    entry.data.assign(_data, _size);
+
+    this->Enqueue(std::move(entry));
+  };
+
+  if (!this->node.SubscribeRaw(_topic, cb))
+  {
+    ignerr << "Failed to subscribe to topic [" << _topic
+           << "] for recording." << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////
+void LogRecordPrivate::WriteLoop()
+{
+  std::vector<LogEntry> batch;
+  std::string compressed;
+  auto lastDiscovery = std::chrono::steady_clock::now();
+  const auto timeout = this->topicPatterns.empty() ?
+      std::chrono::milliseconds(500) : kTopicDiscoveryPeriod;
+  bool insertFailed{false};
+  while (true)
+  {
+    bool stop{false};
+    {
+      std::unique_lock<std::mutex> lock(this->queueMutex);
+      this->queueCv.wait_for(lock, timeout, [&]
+      {
+        return this->stopWriter || !this->queue.empty();
+      });
+      batch.swap(this->queue);
+      stop = this->stopWriter;
+    }
+
+    // Write everything queued meanwhile in one go, the log groups inserts
+    // into transactions
+    for (auto &entry : batch)
+    {
+      if (entry.msg)
+      {
+        entry.type = entry.msg->GetTypeName();
+        entry.msg->SerializeToString(&entry.data);
+      }
+
+      // Compressed messages get a different type, so tools which don't
+      // know about compression don't try to parse them
+      if (entry.compress &&
+          CompressBlock(entry.data, this->stateCodec, compressed))
+      {
+        entry.type += kCompressedTypeSuffix;
+        entry.data.swap(compressed);
+      }
+
+      if (!this->log->InsertMessage(entry.time, entry.topic, entry.type,
+          entry.data.data(), entry.data.size()) && !insertFailed)
+      {
+        ignerr << "Failed to write message on topic [" << entry.topic
+               << "] to the log." << std::endl;
+        insertFailed = true;
+      }
+    }
+    batch.clear();
+
+    if (stop)
+      break;
+
+    // Pick up topics which appeared since the last check
+    auto now = std::chrono::steady_clock::now();
+    if (!this->topicPatterns.empty() &&
+        now - lastDiscovery >= kTopicDiscoveryPeriod)
+    {
+      this->DiscoverTopics();
+      lastDiscovery = now;
+    }
   }
-  else
-    return false;
+}
+
+//////////////////////////////////////////////////
+void LogRecordPrivate::DiscoverTopics()
+{
+  if (this->topicPatterns.empty())
+    return;
+
+  // Transport's node doesn't notify about new topics, so the topic list is
+  // checked often, and only topics which weren't seen yet are matched
+  std::vector<std::string> topics;
+  this->node.TopicList(topics);
+  for (const auto &topic : topics)
+  {
+    if (!this->discoveredTopics.insert(topic).second)
+      continue;
+
+    for (const auto &pattern : this->topicPatterns)
+    {
+      if (std::regex_match(topic, pattern))
+      {
+        this->RecordTopic(topic);
+        break;
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+void LogRecordPrivate::Stop()
+{
+  // No more external messages
+  {
+    std::lock_guard<std::mutex> lock(this->recordedTopicsMutex);
+    this->topicsStopped = true;
+    for (const auto &topic : this->recordedTopics)
+      this->node.Unsubscribe(topic);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(this->queueMutex);
+    this->stopWriter = true;
+  }
+  this->queueCv.notify_one();
+  if (this->writerThread.joinable())
+    this->writerThread.join();
+
+  this->log.reset();
 }
 
 //////////////////////////////////////////////////
@@ -648,7 +1047,8 @@ void LogRecord::PreUpdate(const UpdateInfo &_info,
   // Safe guard to prevent seg faults if recorder could not be started
   if (!this->dataPtr->instStarted)
     return;
-  this->dataPtr->clock->SetTime(_info.simTime);
+  this->dataPtr->simTime = std::chrono::duration_cast<
+      std::chrono::nanoseconds>(_info.simTime).count();
 }
 
 //////////////////////////////////////////////////
@@ -691,21 +1091,44 @@ void LogRecord::PostUpdate(const UpdateInfo &_info,
             worldSdfComp->Data().Element()->ToString(""));
 
         this->dataPtr->sdfPub.Publish(this->dataPtr->sdfMsg);
+        this->dataPtr->Write(_info.simTime, this->dataPtr->sdfTopic,
+            std::make_unique<msgs::StringMsg>(this->dataPtr->sdfMsg));
         this->dataPtr->sdfPublished = true;
       }
     }
   }
 
-  // TODO(louise) Use the SceneBroadcaster's topic once that publishes
-  // the changed state
-  // \todo(anyone) A potential enhancement here is have a keyframe mechanism
-  // to store complete state periodically, and then store incremental from
-  // that. It would reduce some of the compute on replaying
-  // (especially in tools like plotting or seeking through logs).
-  msgs::SerializedStateMap stateMsg;
-  _ecm.ChangedState(stateMsg);
-  if (!stateMsg.entities().empty())
-    this->dataPtr->statePub.Publish(stateMsg);
+  // The state is handed to the writer thread, which serializes it. It's
+  // only published for other subscribers.
+  auto stateMsg = std::make_unique<msgs::SerializedStateMap>();
+  _ecm.ChangedState(*stateMsg);
+  if (!stateMsg->entities().empty())
+  {
+    if (this->dataPtr->statePub.HasConnections())
+      this->dataPtr->statePub.Publish(*stateMsg);
+    this->dataPtr->Write(_info.simTime, this->dataPtr->stateTopic,
+        std::move(stateMsg), true);
+  }
+
+  // Periodically store the complete state, so that playback can seek
+  // without replaying all changes from the beginning. Restart the period
+  // if time jumped back.
+  if (this->dataPtr->recordKeyframes &&
+      (!this->dataPtr->lastKeyframe ||
+       _info.simTime < *this->dataPtr->lastKeyframe ||
+       _info.simTime - *this->dataPtr->lastKeyframe >=
+       this->dataPtr->keyframePeriod))
+  {
+    auto keyframeMsg = std::make_unique<msgs::SerializedStateMap>();
+    _ecm.State(*keyframeMsg, {}, {}, true);
+    if (this->dataPtr->keyframePub.HasConnections())
+      this->dataPtr->keyframePub.Publish(*keyframeMsg);
+    this->dataPtr->Write(_info.simTime, this->dataPtr->keyframeTopic,
+        std::move(keyframeMsg), true);
+    this->dataPtr->Write(_info.simTime, this->dataPtr->keyframeIndexTopic,
+        std::make_unique<msgs::Time>(convert<msgs::Time>(_info.simTime)));
+    this->dataPtr->lastKeyframe = _info.simTime;
+  }
 
   // If there are new models loaded, save meshes and textures
   if (this->dataPtr->RecordResources() && _ecm.HasNewEntities())
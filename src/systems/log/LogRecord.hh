@@ -33,6 +33,10 @@ namespace systems
   // Forward declarations.
   class LogRecordPrivate;
 
+  /// \brief Suffix appended to the type of messages which were compressed
+  /// when recorded, see `<state_compression>`.
+  constexpr char kCompressedTypeSuffix[] = "+compressed";
+
   /// \class LogRecord LogRecord.hh ignition/gazebo/systems/log/LogRecord.hh
   /// \brief Log state recorder
   class LogRecord:
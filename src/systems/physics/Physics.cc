@@ -754,6 +754,99 @@ void Physics::Update(const UpdateInfo &_info, EntityComponentManager &_ecm)
   }
 }
 
+//////////////////////////////////////////////////
+std::unordered_set<ComponentTypeId> Physics::ReadComponents() const
+{
+  return {
+      components::BatterySoC::typeId,
+      components::CanonicalLink::typeId,
+      components::ChildLinkName::typeId,
+      components::Collision::typeId,
+      components::CollisionElement::typeId,
+      components::DetachableJoint::typeId,
+      components::Geometry::typeId,
+      components::Gravity::typeId,
+      components::HaltMotion::typeId,
+      components::Inertial::typeId,
+      components::Joint::typeId,
+      components::JointAxis::typeId,
+      components::JointType::typeId,
+      components::Link::typeId,
+      components::Model::typeId,
+      components::ModelCanonicalLink::typeId,
+      components::Name::typeId,
+      components::ParentEntity::typeId,
+      components::ParentLinkName::typeId,
+      components::PhysicsEnginePlugin::typeId,
+      components::SelfCollide::typeId,
+      components::Static::typeId,
+      components::ThreadPitch::typeId,
+      components::World::typeId};
+}
+
+//////////////////////////////////////////////////
+std::unordered_set<ComponentTypeId> Physics::WriteComponents() const
+{
+  // Commands are cleared once applied
+  return {
+      components::AngularAcceleration::typeId,
+      components::AngularVelocity::typeId,
+      components::AngularVelocityCmd::typeId,
+      components::AxisAlignedBox::typeId,
+      components::ContactSensorData::typeId,
+      components::ExternalWorldWrenchCmd::typeId,
+      components::JointForceCmd::typeId,
+      components::JointPosition::typeId,
+      components::JointPositionReset::typeId,
+      components::JointVelocity::typeId,
+      components::JointVelocityCmd::typeId,
+      components::JointVelocityReset::typeId,
+      components::LinearAcceleration::typeId,
+      components::LinearVelocity::typeId,
+      components::LinearVelocityCmd::typeId,
+      components::PhysicsCollisionDetector::typeId,
+      components::PhysicsSolver::typeId,
+      components::Pose::typeId,
+      components::SlipComplianceCmd::typeId,
+      components::WorldAngularAcceleration::typeId,
+      components::WorldAngularVelocity::typeId,
+      components::WorldLinearAcceleration::typeId,
+      components::WorldLinearVelocity::typeId,
+      components::WorldPose::typeId,
+      components::WorldPoseCmd::typeId};
+}
+
+//////////////////////////////////////////////////
+bool Physics::NeedsExclusiveAccess(const EntityComponentManager &_ecm)
+{
+  if (!this->dataPtr->engine)
+    return false;
+
+  // New worlds get solver and collision detector components, and pose
+  // commands from the previous iteration are removed.
+  if (_ecm.HasNewEntities() || !this->dataPtr->worldPoseCmdsToRemove.empty())
+    return true;
+
+  // Joint resets are removed once applied
+  bool reset{false};
+  _ecm.Each<components::JointPositionReset>(
+      [&](const Entity &, const components::JointPositionReset *) -> bool
+      {
+        reset = true;
+        return false;
+      });
+  if (reset)
+    return true;
+
+  _ecm.Each<components::JointVelocityReset>(
+      [&](const Entity &, const components::JointVelocityReset *) -> bool
+      {
+        reset = true;
+        return false;
+      });
+  return reset;
+}
+
 //////////////////////////////////////////////////
 void PhysicsPrivate::CreatePhysicsEntities(const EntityComponentManager &_ecm)
 {
@@ -2913,6 +3006,7 @@ physics::FrameData3d PhysicsPrivate::LinkFrameDataAtOffset(
 IGNITION_ADD_PLUGIN(Physics,
                     ignition::gazebo::System,
                     Physics::ISystemConfigure,
-                    Physics::ISystemUpdate)
+                    Physics::ISystemUpdate,
+                    Physics::ISystemComponentAccess)
 
 IGNITION_ADD_PLUGIN_ALIAS(Physics, "ignition::gazebo::systems::Physics")
@@ -19,6 +19,7 @@
 
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <ignition/physics/FindFeatures.hh>
 #include <ignition/physics/RequestFeatures.hh>
@@ -67,7 +68,8 @@ namespace systems
   class Physics:
     public System,
     public ISystemConfigure,
-    public ISystemUpdate
+    public ISystemUpdate,
+    public ISystemComponentAccess
   {
     /// \brief Constructor
     public: explicit Physics();
@@ -85,6 +87,22 @@ namespace systems
     public: void Update(const UpdateInfo &_info,
                 EntityComponentManager &_ecm) final;
 
+    // Documentation inherited
+    public: std::unordered_set<ComponentTypeId>
+                ReadComponents() const final;
+
+    // Documentation inherited
+    public: std::unordered_set<ComponentTypeId>
+                WriteComponents() const final;
+
+    /// \brief Exclusive access is needed to add components to new worlds
+    /// and to remove pose commands and joint resets once applied.
+    /// \param[in] _ecm The entity component manager.
+    /// \return True if components will be created or removed during
+    /// Update.
+    public: bool NeedsExclusiveAccess(
+                const EntityComponentManager &_ecm) final;
+
     /// \brief Private data pointer.
     private: std::unique_ptr<PhysicsPrivate> dataPtr;
   };
@@ -17,19 +17,35 @@
 
 #include "SceneBroadcaster.hh"
 
+#include <ignition/msgs/param.pb.h>
 #include <ignition/msgs/scene.pb.h>
+#include <ignition/msgs/stringmsg_v.pb.h>
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 
 #include <ignition/common/Profiler.hh>
+#include <ignition/math/Pose3.hh>
 #include <ignition/math/graph/Graph.hh>
 #include <ignition/plugin/Register.hh>
 #include <ignition/transport/Node.hh>
 
 #include "ignition/gazebo/components/CastShadows.hh"
+#include "ignition/gazebo/components/Factory.hh"
 #include "ignition/gazebo/components/Geometry.hh"
 #include "ignition/gazebo/components/Light.hh"
 #include "ignition/gazebo/components/Link.hh"
@@ -45,12 +61,20 @@
 #include "ignition/gazebo/Conversions.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
 
+#include "../../SharedMemoryRing.hh"
+
 using namespace std::chrono_literals;
 
 using namespace ignition;
 using namespace gazebo;
 using namespace systems;
 
+namespace
+{
+/// \brief Time after which a state filter without subscribers is removed.
+constexpr std::chrono::seconds kStateFilterTimeout{10s};
+}
+
 // Private data class.
 class ignition::gazebo::systems::SceneBroadcasterPrivate
 {
@@ -81,6 +105,32 @@ class ignition::gazebo::systems::SceneBroadcasterPrivate
   /// \param[out] _res Response containing the last available full state.
   public: void StateAsyncService(const ignition::msgs::StringMsg &_req);
 
+  /// \brief Callback for the shared memory service, which tells clients on
+  /// the same host where to read the state from.
+  /// \param[out] _res Name and token of the shared memory buffer.
+  /// \return True if the state is written to shared memory.
+  public: bool StateSharedMemoryService(ignition::msgs::StringMsg_V &_res);
+
+  /// \brief Callback for the state filter service, which registers a
+  /// filter for subscribers which only need part of the state.
+  /// \param[in] _req Filter parameters, all of them optional:
+  /// * "components": Comma-separated names of the component types to
+  ///   publish, all types if empty.
+  /// * "entity": Only publish this entity and its descendants, given as
+  ///   an integer or, for IDs which don't fit in 32 bits, a string.
+  /// * "hz": Maximum publish rate, defaults to the state rate.
+  /// Filters without subscribers are removed after a while.
+  /// \param[out] _res Topic where the filtered state is published.
+  /// \return True if successful.
+  public: bool StateFilterService(const ignition::msgs::Param &_req,
+      ignition::msgs::StringMsg &_res);
+
+  /// \brief Publish the state for all filters which are due.
+  /// \param[in] _info The update information
+  /// \param[in] _manager The entity component manager
+  public: void FilteredStateUpdate(const UpdateInfo &_info,
+      const EntityComponentManager &_manager);
+
   /// \brief Updates the scene graph when entities are added
   /// \param[in] _manager The entity component manager
   public: void SceneGraphAddEntities(const EntityComponentManager &_manager);
@@ -140,24 +190,83 @@ class ignition::gazebo::systems::SceneBroadcasterPrivate
   public: static void RemoveFromGraph(const Entity _entity,
                                       SceneGraphType &_graph);
 
+  /// \brief Pose stream published on one of the pose topics.
+  public: struct PoseStream
+  {
+    /// \brief Publisher for the stream.
+    transport::Node::Publisher pub;
+
+    /// \brief Minimum time between publications.
+    std::chrono::steady_clock::duration period;
+
+    /// \brief Last time the stream was published.
+    std::chrono::steady_clock::time_point lastPubTime;
+
+    /// \brief Last time all poses were published.
+    std::chrono::steady_clock::time_point lastKeyframeTime;
+
+    /// \brief Last published pose of each entity, only kept when only
+    /// changed poses are published. Poses are compared against it when the
+    /// stream is due, so the ECM isn't walked on other iterations.
+    std::unordered_map<Entity, math::Pose3d> published;
+
+    /// \brief Message being built, reused across publications.
+    msgs::Pose_V msg;
+
+    /// \brief True if the stream is being published this iteration.
+    bool due{false};
+
+    /// \brief True if all poses are being published this iteration.
+    bool keyframe{false};
+  };
+
   /// \brief Create and send out pose updates.
   /// \param[in] _info The update information
   /// \param[in] _manager The entity component manager
   public: void PoseUpdate(const UpdateInfo &_info,
     const EntityComponentManager &_manager);
 
+  /// \brief Check whether a pose goes in a stream this iteration, and add
+  /// it if so.
+  /// \param[in] _stream Stream to add to.
+  /// \param[in] _entity Entity with the pose.
+  /// \param[in] _name Name of the entity.
+  /// \param[in] _pose Current pose.
+  public: void AddPose(PoseStream &_stream, const Entity _entity,
+      const std::string &_name, const math::Pose3d &_pose);
+
+  /// \brief Publish a stream if it's due this iteration.
+  /// \param[in] _stream Stream to publish.
+  /// \param[in] _info The update information
+  public: void PublishPoses(PoseStream &_stream, const UpdateInfo &_info);
+
   /// \brief Transport node.
   public: std::unique_ptr<transport::Node> node{nullptr};
 
-  /// \brief Pose publisher.
-  public: transport::Node::Publisher posePub;
+  /// \brief Poses of all models, links, visuals and lights.
+  public: PoseStream poseStream;
 
-  /// \brief Dynamic pose publisher, for non-static model poses
-  public: transport::Node::Publisher dyPosePub;
+  /// \brief Poses of non-static models and their links.
+  public: PoseStream dyPoseStream;
 
   /// \brief Rate at which to publish dynamic poses
   public: int dyPoseHertz{60};
 
+  /// \brief If true, pose messages only contain the poses which changed
+  /// since the previous message, except for periodic keyframes with all
+  /// poses.
+  public: bool changedPosesOnly{false};
+
+  /// \brief Time between keyframes when only changed poses are published.
+  public: std::chrono::steady_clock::duration poseKeyframePeriod{
+      std::chrono::seconds(1)};
+
+  /// \brief When only changed poses are published, poses which moved less
+  /// than this since they were last published are held back until the
+  /// next keyframe. The distance is the translation in meters plus the
+  /// rotation in radians.
+  public: double poseTolerance{0.0};
+
   /// \brief Scene publisher
   public: transport::Node::Publisher scenePub;
 
@@ -208,6 +317,62 @@ class ignition::gazebo::systems::SceneBroadcasterPrivate
 
   /// \brief A list of async state requests
   public: std::unordered_set<std::string> stateRequests;
+
+  /// \brief Size in bytes of the shared memory buffer for the state, zero to
+  /// disable it.
+  public: std::size_t stateRingSize{16 * 1024 * 1024};
+
+  /// \brief Shared memory buffer where the state is written for clients on
+  /// the same host, in addition to the state topic.
+  public: std::unique_ptr<SharedMemoryRing> stateRing;
+
+  /// \brief True once a client asked for the shared memory buffer. There's
+  /// no way to know when readers go away, so the state keeps being written
+  /// from then on.
+  public: std::atomic<bool> stateRingReaders{false};
+
+  /// \brief Reused buffer for the serialized state.
+  public: std::string stateRingData;
+
+  /// \brief True once the user was warned about a state which didn't fit in
+  /// the shared memory buffer.
+  public: bool stateRingWarned{false};
+
+  /// \brief State subset requested through the state filter service.
+  public: struct StateFilter
+  {
+    /// \brief Component types to publish, empty for all.
+    std::unordered_set<ComponentTypeId> types;
+
+    /// \brief Root of the subtree to publish, null for all entities.
+    Entity entity{kNullEntity};
+
+    /// \brief Minimum time between publications.
+    std::chrono::steady_clock::duration period;
+
+    /// \brief Topic where the filtered state is published.
+    std::string topic;
+
+    /// \brief Publisher for the filtered state.
+    transport::Node::Publisher pub;
+
+    /// \brief Last time the filtered state was published.
+    std::chrono::time_point<std::chrono::system_clock> lastPubTime;
+
+    /// \brief Last time the filter had subscribers or was requested.
+    std::chrono::time_point<std::chrono::system_clock> lastUsedTime;
+  };
+
+  /// \brief Filters registered by subscribers. Subscribers asking for the
+  /// same filter share it, so it is only serialized once per publication.
+  /// The key describes the filter.
+  public: std::map<std::string, StateFilter> stateFilters;
+
+  /// \brief Number used in the topic of the next state filter.
+  public: unsigned int nextStateFilterId{0u};
+
+  /// \brief Protects stateFilters and nextStateFilterId.
+  public: std::mutex stateFiltersMutex;
 };
 
 //////////////////////////////////////////////////
@@ -236,11 +401,30 @@ void SceneBroadcaster::Configure(
   auto readHertz = _sdf->Get<int>("dynamic_pose_hertz", 60);
   this->dataPtr->dyPoseHertz = readHertz.first;
 
+  this->dataPtr->changedPosesOnly =
+      _sdf->Get<bool>("changed_poses_only", false).first;
+
+  auto keyframeHertz = _sdf->Get<double>("pose_keyframe_hertz", 1.0);
+  if (keyframeHertz.first > 0.0)
+  {
+    this->dataPtr->poseKeyframePeriod = std::chrono::duration_cast<
+        std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(1.0 / keyframeHertz.first));
+  }
+
+  this->dataPtr->poseTolerance =
+      std::max(0.0, _sdf->Get<double>("pose_tolerance", 0.0).first);
+
   auto stateHerz = _sdf->Get<int>("state_hertz", 60);
   this->dataPtr->statePublishPeriod =
       std::chrono::duration<int64_t, std::ratio<1, 1000>>(
       std::chrono::milliseconds(1000/stateHerz.first));
 
+  auto ringSize = _sdf->Get<int>("state_shared_memory_size",
+      static_cast<int>(this->dataPtr->stateRingSize));
+  this->dataPtr->stateRingSize =
+      static_cast<std::size_t>(std::max(0, ringSize.first));
+
   // Add to graph
   {
     std::lock_guard<std::mutex> lock(this->dataPtr->graphMutex);
@@ -263,11 +447,7 @@ void SceneBroadcaster::PostUpdate(const UpdateInfo &_info,
   // TODO(louise) Get <scene> from SDF
 
   // Create and send pose update if transport connections exist.
-  if (this->dataPtr->dyPosePub.HasConnections() ||
-      this->dataPtr->posePub.HasConnections())
-  {
-    this->dataPtr->PoseUpdate(_info, _manager);
-  }
+  this->dataPtr->PoseUpdate(_info, _manager);
 
   // call SceneGraphRemoveEntities at the end of this update cycle so that
   // removed entities are removed from the scene graph for the next update cycle
@@ -288,8 +468,10 @@ void SceneBroadcaster::PostUpdate(const UpdateInfo &_info,
   auto now = std::chrono::system_clock::now();
   bool itsPubTime = !_info.paused && (now - this->dataPtr->lastStatePubTime >
        this->dataPtr->statePublishPeriod);
-  auto shouldPublish = this->dataPtr->statePub.HasConnections() &&
-       (changeEvent || itsPubTime);
+  bool ringReaders = this->dataPtr->stateRingReaders &&
+       this->dataPtr->stateRing != nullptr;
+  auto shouldPublish = (this->dataPtr->statePub.HasConnections() ||
+       ringReaders) && (changeEvent || itsPubTime);
 
   if (this->dataPtr->stateServiceRequest || shouldPublish)
   {
@@ -298,11 +480,20 @@ void SceneBroadcaster::PostUpdate(const UpdateInfo &_info,
 
     set(this->dataPtr->stepMsg.mutable_stats(), _info);
 
-    // Publish full state if there are change events
-    if (changeEvent || this->dataPtr->stateServiceRequest)
+    // Full state on demand, or if going back in time
+    bool fullState = this->dataPtr->stateServiceRequest || jumpBackInTime;
+    if (fullState)
     {
       _manager.State(*this->dataPtr->stepMsg.mutable_state(), {}, {}, true);
     }
+    // Only the entities affected by change events: new entities in full,
+    // removed entities and changed or removed components. Subscribers keep
+    // track of the rest, getting the full state through the state services.
+    else if (changeEvent)
+    {
+      IGN_PROFILE("SceneBroadcast::PostUpdate ChangedState");
+      _manager.ChangedState(*this->dataPtr->stepMsg.mutable_state());
+    }
     // Otherwise publish just periodic change components
     else
     {
@@ -338,6 +529,88 @@ void SceneBroadcaster::PostUpdate(const UpdateInfo &_info,
       this->dataPtr->statePub.Publish(this->dataPtr->stepMsg);
       this->dataPtr->lastStatePubTime = now;
     }
+
+    // Same-host clients read the same messages from shared memory. Full
+    // states are keyframes which readers can resync from.
+    if (ringReaders && (shouldPublish || fullState))
+    {
+      IGN_PROFILE("SceneBroadcast::PostUpdate Write State");
+      this->dataPtr->stepMsg.SerializeToString(&this->dataPtr->stateRingData);
+      if (!this->dataPtr->stateRing->Write(this->dataPtr->stateRingData,
+          fullState) && !this->dataPtr->stateRingWarned)
+      {
+        ignwarn << "State of [" << this->dataPtr->stateRingData.size()
+                << "] bytes doesn't fit in shared memory, clients will "
+                << "request it through transport instead. Increase "
+                << "<state_shared_memory_size> to avoid this." << std::endl;
+        this->dataPtr->stateRingWarned = true;
+      }
+      this->dataPtr->lastStatePubTime = now;
+    }
+  }
+
+  this->dataPtr->FilteredStateUpdate(_info, _manager);
+}
+
+//////////////////////////////////////////////////
+void SceneBroadcasterPrivate::FilteredStateUpdate(const UpdateInfo &_info,
+    const EntityComponentManager &_manager)
+{
+  if (_info.paused)
+    return;
+
+  std::lock_guard<std::mutex> lock(this->stateFiltersMutex);
+  auto now = std::chrono::system_clock::now();
+  for (auto filterIt = this->stateFilters.begin();
+       filterIt != this->stateFilters.end();)
+  {
+    auto &filter = filterIt->second;
+
+    // Stop publishing filters which nobody subscribed to for a while
+    if (!filter.pub.HasConnections())
+    {
+      if (now - filter.lastUsedTime > kStateFilterTimeout)
+      {
+        igndbg << "Removing unused state filter [" << filter.topic << "]"
+               << std::endl;
+        filterIt = this->stateFilters.erase(filterIt);
+      }
+      else
+      {
+        ++filterIt;
+      }
+      continue;
+    }
+    filter.lastUsedTime = now;
+
+    if (now - filter.lastPubTime < filter.period)
+    {
+      ++filterIt;
+      continue;
+    }
+
+    IGN_PROFILE("SceneBroadcast::FilteredStateUpdate Publish");
+
+    // Filtered subscribers may skip steps, so each message carries the whole
+    // subset instead of only what changed.
+    std::unordered_set<Entity> entities;
+    if (filter.entity != kNullEntity)
+    {
+      entities = _manager.Descendants(filter.entity);
+      if (entities.empty())
+      {
+        ++filterIt;
+        continue;
+      }
+    }
+
+    msgs::SerializedStepMap msg;
+    set(msg.mutable_stats(), _info);
+    _manager.State(*msg.mutable_state(), entities, filter.types, true);
+
+    filter.pub.Publish(msg);
+    filter.lastPubTime = now;
+    ++filterIt;
   }
 }
 
@@ -347,9 +620,40 @@ void SceneBroadcasterPrivate::PoseUpdate(const UpdateInfo &_info,
 {
   IGN_PROFILE("SceneBroadcast::PoseUpdate");
 
-  msgs::Pose_V poseMsg, dyPoseMsg;
-  bool dyPoseConnections = this->dyPosePub.HasConnections();
-  bool poseConnections = this->posePub.HasConnections();
+  // Throttle here instead of using transport::AdvertiseMessageOptions so
+  // that changes in skipped iterations make it into the next message
+  auto now = std::chrono::steady_clock::now();
+  bool poseConnections = this->poseStream.pub.HasConnections();
+  bool dyPoseConnections = this->dyPoseStream.pub.HasConnections();
+  bool due{false};
+  for (auto [stream, connections] : {
+      std::make_pair(&this->poseStream, poseConnections),
+      std::make_pair(&this->dyPoseStream, dyPoseConnections)})
+  {
+    // Subscribers which connect later start with a keyframe
+    if (!connections)
+    {
+      stream->due = false;
+      stream->published.clear();
+      stream->lastKeyframeTime = {};
+      continue;
+    }
+
+    stream->due = now - stream->lastPubTime >= stream->period;
+    stream->keyframe = !this->changedPosesOnly ||
+        now - stream->lastKeyframeTime >= this->poseKeyframePeriod;
+    stream->msg.Clear();
+    due = due || stream->due;
+
+    // Keyframes add all entities back, which forgets removed ones
+    if (stream->due && stream->keyframe)
+      stream->published.clear();
+  }
+
+  // Changed poses are found by comparing against the published ones, so
+  // there's nothing to keep track of between publications
+  if (!due)
+    return;
 
   // Models
   _manager.Each<components::Model, components::Name, components::Pose,
@@ -361,20 +665,14 @@ void SceneBroadcasterPrivate::PoseUpdate(const UpdateInfo &_info,
       {
         if (poseConnections)
         {
-          // Add to pose msg
-          auto pose = poseMsg.add_pose();
-          msgs::Set(pose, _poseComp->Data());
-          pose->set_name(_nameComp->Data());
-          pose->set_id(_entity);
+          this->AddPose(this->poseStream, _entity, _nameComp->Data(),
+              _poseComp->Data());
         }
 
         if (dyPoseConnections && !_staticComp->Data())
         {
-          // Add to dynamic pose msg
-          auto dyPose = dyPoseMsg.add_pose();
-          msgs::Set(dyPose, _poseComp->Data());
-          dyPose->set_name(_nameComp->Data());
-          dyPose->set_id(_entity);
+          this->AddPose(this->dyPoseStream, _entity, _nameComp->Data(),
+              _poseComp->Data());
         }
         return true;
       });
@@ -387,13 +685,10 @@ void SceneBroadcasterPrivate::PoseUpdate(const UpdateInfo &_info,
           const components::Pose *_poseComp,
           const components::ParentEntity *_parentComp) -> bool
       {
-        // Add to pose msg
         if (poseConnections)
         {
-          auto pose = poseMsg.add_pose();
-          msgs::Set(pose, _poseComp->Data());
-          pose->set_name(_nameComp->Data());
-          pose->set_id(_entity);
+          this->AddPose(this->poseStream, _entity, _nameComp->Data(),
+              _poseComp->Data());
         }
 
         // Check whether parent model is static
@@ -401,41 +696,25 @@ void SceneBroadcasterPrivate::PoseUpdate(const UpdateInfo &_info,
           _parentComp->Data());
         if (dyPoseConnections && !staticComp->Data())
         {
-          // Add to dynamic pose msg
-          auto dyPose = dyPoseMsg.add_pose();
-          msgs::Set(dyPose, _poseComp->Data());
-          dyPose->set_name(_nameComp->Data());
-          dyPose->set_id(_entity);
+          this->AddPose(this->dyPoseStream, _entity, _nameComp->Data(),
+              _poseComp->Data());
         }
 
         return true;
       });
 
-  if (dyPoseConnections)
-  {
-    // Set the time stamp in the header
-    dyPoseMsg.mutable_header()->mutable_stamp()->CopyFrom(
-        convert<msgs::Time>(_info.simTime));
-
-    this->dyPosePub.Publish(dyPoseMsg);
-  }
+  this->PublishPoses(this->dyPoseStream, _info);
 
-  // Visuals
   if (poseConnections)
   {
-    poseMsg.mutable_header()->mutable_stamp()->CopyFrom(
-        convert<msgs::Time>(_info.simTime));
-
+    // Visuals
     _manager.Each<components::Visual, components::Name, components::Pose>(
       [&](const Entity &_entity, const components::Visual *,
           const components::Name *_nameComp,
           const components::Pose *_poseComp) -> bool
       {
-        // Add to pose msg
-        auto pose = poseMsg.add_pose();
-        msgs::Set(pose, _poseComp->Data());
-        pose->set_name(_nameComp->Data());
-        pose->set_id(_entity);
+        this->AddPose(this->poseStream, _entity, _nameComp->Data(),
+            _poseComp->Data());
         return true;
       });
 
@@ -445,16 +724,83 @@ void SceneBroadcasterPrivate::PoseUpdate(const UpdateInfo &_info,
             const components::Name *_nameComp,
             const components::Pose *_poseComp) -> bool
         {
-          // Add to pose msg
-          auto pose = poseMsg.add_pose();
-          msgs::Set(pose, _poseComp->Data());
-          pose->set_name(_nameComp->Data());
-          pose->set_id(_entity);
+          this->AddPose(this->poseStream, _entity, _nameComp->Data(),
+              _poseComp->Data());
           return true;
         });
+  }
+
+  this->PublishPoses(this->poseStream, _info);
+}
+
+//////////////////////////////////////////////////
+void SceneBroadcasterPrivate::AddPose(PoseStream &_stream,
+    const Entity _entity, const std::string &_name, const math::Pose3d &_pose)
+{
+  if (!_stream.due)
+    return;
 
-    this->posePub.Publish(poseMsg);
+  if (!_stream.keyframe)
+  {
+    // Skip poses which didn't change since they were last published.
+    // Small motions wait for a larger one or for the next keyframe.
+    auto publishedIt = _stream.published.find(_entity);
+    if (publishedIt != _stream.published.end())
+    {
+      const auto &published = publishedIt->second;
+      if (this->poseTolerance > 0.0)
+      {
+        double distance = (_pose.Pos() - published.Pos()).Length() +
+            (_pose.Rot().Inverse() * published.Rot()).Euler().Length();
+        if (distance < this->poseTolerance)
+          return;
+      }
+      else if (_pose == published)
+      {
+        return;
+      }
+    }
   }
+
+  if (this->changedPosesOnly)
+    _stream.published[_entity] = _pose;
+
+  auto pose = _stream.msg.add_pose();
+  msgs::Set(pose, _pose);
+  pose->set_name(_name);
+  pose->set_id(_entity);
+}
+
+//////////////////////////////////////////////////
+void SceneBroadcasterPrivate::PublishPoses(PoseStream &_stream,
+    const UpdateInfo &_info)
+{
+  if (!_stream.due)
+    return;
+
+  // Set the time stamp in the header
+  _stream.msg.mutable_header()->mutable_stamp()->CopyFrom(
+      convert<msgs::Time>(_info.simTime));
+
+  if (this->changedPosesOnly)
+  {
+    // Let subscribers know whether poses which aren't in the message are
+    // unchanged, or the entities are gone
+    auto data = _stream.msg.mutable_header()->add_data();
+    data->set_key("keyframe");
+    data->add_value(_stream.keyframe ? "true" : "false");
+  }
+
+  auto now = std::chrono::steady_clock::now();
+  if (_stream.keyframe)
+    _stream.lastKeyframeTime = now;
+  _stream.lastPubTime = now;
+
+  // Nothing moved
+  if (!_stream.keyframe && _stream.msg.pose_size() == 0)
+    return;
+
+  _stream.pub.Publish(_stream.msg);
 }
 
 //////////////////////////////////////////////////
@@ -510,6 +856,38 @@ void SceneBroadcasterPrivate::SetupTransport(const std::string &_worldName)
   ignmsg << "Serving full state (async) on [" << opts.NameSpace() << "/"
          << stateAsyncService << "]" << std::endl;
 
+  // State shared memory service
+#ifndef _WIN32
+  if (this->stateRingSize > 0)
+  {
+    // The process ID keeps servers on the same host from clashing
+    std::string ringName = "/ign_gazebo_state_" + std::to_string(getpid()) +
+        "_" + ns.substr(1);
+    std::replace(ringName.begin() + 1, ringName.end(), '/', '_');
+    this->stateRing = SharedMemoryRing::Create(ringName, this->stateRingSize);
+  }
+#endif
+
+  if (this->stateRing)
+  {
+    std::string stateSharedMemoryService{"state/shared_memory"};
+
+    this->node->Advertise(stateSharedMemoryService,
+        &SceneBroadcasterPrivate::StateSharedMemoryService, this);
+
+    ignmsg << "Serving state shared memory on [" << opts.NameSpace() << "/"
+           << stateSharedMemoryService << "]" << std::endl;
+  }
+
+  // State filter service
+  std::string stateFilterService{"state/filter"};
+
+  this->node->Advertise(stateFilterService,
+      &SceneBroadcasterPrivate::StateFilterService, this);
+
+  ignmsg << "Serving state filters on [" << opts.NameSpace() << "/"
+         << stateFilterService << "]" << std::endl;
+
   // Scene info topic
   std::string sceneTopic{ns + "/scene/info"};
 
@@ -539,10 +917,9 @@ void SceneBroadcasterPrivate::SetupTransport(const std::string &_worldName)
   // Pose info publisher
   std::string poseTopic{"pose/info"};
 
-  transport::AdvertiseMessageOptions poseAdvertOpts;
-  poseAdvertOpts.SetMsgsPerSec(60);
-  this->posePub = this->node->Advertise<msgs::Pose_V>(poseTopic,
-      poseAdvertOpts);
+  this->poseStream.pub = this->node->Advertise<msgs::Pose_V>(poseTopic);
+  this->poseStream.period = std::chrono::duration_cast<
+      std::chrono::steady_clock::duration>(std::chrono::milliseconds(1000/60));
 
   ignmsg << "Publishing pose messages on [" << opts.NameSpace() << "/"
          << poseTopic << "]" << std::endl;
@@ -550,10 +927,10 @@ void SceneBroadcasterPrivate::SetupTransport(const std::string &_worldName)
   // Dynamic pose info publisher
   std::string dyPoseTopic{"dynamic_pose/info"};
 
-  transport::AdvertiseMessageOptions dyPoseAdvertOpts;
-  dyPoseAdvertOpts.SetMsgsPerSec(this->dyPoseHertz);
-  this->dyPosePub = this->node->Advertise<msgs::Pose_V>(dyPoseTopic,
-      dyPoseAdvertOpts);
+  this->dyPoseStream.pub = this->node->Advertise<msgs::Pose_V>(dyPoseTopic);
+  this->dyPoseStream.period = std::chrono::duration_cast<
+      std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(1.0 / std::max(1, this->dyPoseHertz)));
 
   ignmsg << "Publishing dynamic pose messages on [" << opts.NameSpace() << "/"
          << dyPoseTopic << "]" << std::endl;
@@ -586,6 +963,129 @@ void SceneBroadcasterPrivate::StateAsyncService(
   this->stateRequests.insert(_req.data());
 }
 
+//////////////////////////////////////////////////
+bool SceneBroadcasterPrivate::StateSharedMemoryService(
+    ignition::msgs::StringMsg_V &_res)
+{
+  if (!this->stateRing)
+    return false;
+
+  _res.add_data(this->stateRing->Name());
+  _res.add_data(std::to_string(this->stateRing->Token()));
+  this->stateRingReaders = true;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool SceneBroadcasterPrivate::StateFilterService(
+    const ignition::msgs::Param &_req, ignition::msgs::StringMsg &_res)
+{
+  StateFilter filter;
+  filter.period = this->statePublishPeriod;
+
+  auto it = _req.params().find("components");
+  if (it != _req.params().end())
+  {
+    // Component types are identified by the name they're registered with
+    std::map<std::string, ComponentTypeId> typesByName;
+    for (auto typeId : components::Factory::Instance()->TypeIds())
+      typesByName[components::Factory::Instance()->Name(typeId)] = typeId;
+
+    std::stringstream names(it->second.string_value());
+    std::string name;
+    while (std::getline(names, name, ','))
+    {
+      if (name.empty())
+        continue;
+
+      auto typeIt = typesByName.find(name);
+      if (typeIt == typesByName.end())
+      {
+        ignerr << "Unknown component type [" << name
+               << "] requested for state filter." << std::endl;
+        return false;
+      }
+      filter.types.insert(typeIt->second);
+    }
+  }
+
+  // Entity IDs may not fit in the 32-bit integers supported by
+  // msgs::Any, so they can also be passed as strings
+  it = _req.params().find("entity");
+  if (it != _req.params().end())
+  {
+    if (it->second.type() == msgs::Any::STRING)
+    {
+      try
+      {
+        std::size_t end;
+        filter.entity = std::stoull(it->second.string_value(), &end);
+        if (end != it->second.string_value().size())
+          throw std::invalid_argument(it->second.string_value());
+      }
+      catch (const std::exception &)
+      {
+        ignerr << "Invalid entity [" << it->second.string_value()
+               << "] requested for state filter." << std::endl;
+        return false;
+      }
+    }
+    else if (it->second.type() == msgs::Any::INT32 &&
+        it->second.int_value() >= 0)
+    {
+      filter.entity = static_cast<Entity>(it->second.int_value());
+    }
+    else
+    {
+      ignerr << "State filter entity must be a non-negative integer or a "
+             << "string." << std::endl;
+      return false;
+    }
+  }
+
+  it = _req.params().find("hz");
+  if (it != _req.params().end() && it->second.double_value() > 0.0)
+  {
+    filter.period = std::chrono::duration_cast<
+        std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(1.0 / it->second.double_value()));
+  }
+
+  // Describe the filter so subscribers asking for the same one share it
+  std::vector<ComponentTypeId> sortedTypes(filter.types.begin(),
+      filter.types.end());
+  std::sort(sortedTypes.begin(), sortedTypes.end());
+  std::ostringstream key;
+  key << filter.entity << "/" << filter.period.count();
+  for (auto type : sortedTypes)
+    key << "/" << type;
+
+  std::lock_guard<std::mutex> lock(this->stateFiltersMutex);
+  auto filterIt = this->stateFilters.find(key.str());
+  if (filterIt == this->stateFilters.end())
+  {
+    filter.topic = this->node->Options().NameSpace() + "/state/filtered/" +
+        std::to_string(this->nextStateFilterId++);
+    filter.pub = this->node->Advertise<msgs::SerializedStepMap>(filter.topic);
+    if (!filter.pub)
+    {
+      ignerr << "Failed to advertise filtered state on [" << filter.topic
+             << "]" << std::endl;
+      return false;
+    }
+
+    ignmsg << "Publishing filtered state on [" << filter.topic << "]"
+           << std::endl;
+    filterIt = this->stateFilters.emplace(key.str(), std::move(filter)).first;
+  }
+
+  // Give the requester time to subscribe
+  filterIt->second.lastUsedTime = std::chrono::system_clock::now();
+
+  _res.set_data(filterIt->second.topic);
+  return true;
+}
+
 //////////////////////////////////////////////////
 bool SceneBroadcasterPrivate::StateService(
     ignition::msgs::SerializedStepMap &_res)
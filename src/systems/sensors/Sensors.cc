@@ -40,8 +40,14 @@
 #include "ignition/gazebo/components/Camera.hh"
 #include "ignition/gazebo/components/DepthCamera.hh"
 #include "ignition/gazebo/components/GpuLidar.hh"
+#include "ignition/gazebo/components/Light.hh"
+#include "ignition/gazebo/components/LightCmd.hh"
+#include "ignition/gazebo/components/ParticleEmitter.hh"
+#include "ignition/gazebo/components/Pose.hh"
 #include "ignition/gazebo/components/RenderEngineServerPlugin.hh"
 #include "ignition/gazebo/components/RgbdCamera.hh"
+#include "ignition/gazebo/components/Temperature.hh"
+#include "ignition/gazebo/components/TemperatureRange.hh"
 #include "ignition/gazebo/components/ThermalCamera.hh"
 #include "ignition/gazebo/components/World.hh"
 #include "ignition/gazebo/Events.hh"
@@ -64,6 +70,10 @@ class ignition::gazebo::systems::SensorsPrivate
   /// \brief used to store whether rendering objects have been created.
   public: bool initialized = false;
 
+  /// \brief Whether the ECM is updated on the coming Update. Latched
+  /// before the phase, since initialized is set by the rendering thread.
+  public: bool updateEcm{false};
+
   /// \brief Main rendering interface
   public: RenderUtil renderUtil;
 
@@ -417,12 +427,39 @@ void Sensors::Update(const UpdateInfo &_info,
                      EntityComponentManager &_ecm)
 {
   IGN_PROFILE("Sensors::Update");
-  if (this->dataPtr->running && this->dataPtr->initialized)
+  if (this->dataPtr->updateEcm)
   {
     this->dataPtr->renderUtil.UpdateECM(_info, _ecm);
   }
 }
 
+//////////////////////////////////////////////////
+std::unordered_set<ComponentTypeId> Sensors::ReadComponents() const
+{
+  return {components::ThermalCamera::typeId};
+}
+
+//////////////////////////////////////////////////
+std::unordered_set<ComponentTypeId> Sensors::WriteComponents() const
+{
+  return {
+      components::Light::typeId,
+      components::LightCmd::typeId,
+      components::ParticleEmitterCmd::typeId,
+      components::Pose::typeId,
+      components::TemperatureLinearResolution::typeId,
+      components::TemperatureRange::typeId};
+}
+
+//////////////////////////////////////////////////
+bool Sensors::NeedsExclusiveAccess(const EntityComponentManager &_ecm)
+{
+  this->dataPtr->updateEcm =
+      this->dataPtr->running && this->dataPtr->initialized;
+  return this->dataPtr->updateEcm &&
+      this->dataPtr->renderUtil.UpdateECMRemovesComponents(_ecm);
+}
+
 //////////////////////////////////////////////////
 void Sensors::PostUpdate(const UpdateInfo &_info,
                          const EntityComponentManager &_ecm)
@@ -610,7 +647,8 @@ std::string Sensors::CreateSensor(const Entity &_entity,
 IGNITION_ADD_PLUGIN(Sensors, System,
   Sensors::ISystemConfigure,
   Sensors::ISystemUpdate,
-  Sensors::ISystemPostUpdate
+  Sensors::ISystemPostUpdate,
+  Sensors::ISystemComponentAccess
 )
 
 IGNITION_ADD_PLUGIN_ALIAS(Sensors, "ignition::gazebo::systems::Sensors")
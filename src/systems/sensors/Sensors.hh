@@ -19,6 +19,7 @@
 
 #include <memory>
 #include <string>
+#include <unordered_set>
 
 #include <ignition/gazebo/config.hh>
 #include <ignition/gazebo/System.hh>
@@ -42,7 +43,8 @@ namespace systems
     public System,
     public ISystemConfigure,
     public ISystemUpdate,
-    public ISystemPostUpdate
+    public ISystemPostUpdate,
+    public ISystemComponentAccess
   {
     /// \brief Constructor
     public: explicit Sensors();
@@ -64,6 +66,21 @@ namespace systems
     public: void PostUpdate(const UpdateInfo &_info,
                             const EntityComponentManager &_ecm) final;
 
+    // Documentation inherited
+    public: std::unordered_set<ComponentTypeId>
+                ReadComponents() const final;
+
+    // Documentation inherited
+    public: std::unordered_set<ComponentTypeId>
+                WriteComponents() const final;
+
+    /// \brief Exclusive access is needed when processed commands or thermal
+    /// camera properties are about to be removed from the ECM.
+    /// \param[in] _ecm The entity component manager.
+    /// \return True if components will be removed during Update.
+    public: bool NeedsExclusiveAccess(
+                const EntityComponentManager &_ecm) final;
+
     /// \brief Create a rendering sensor from sdf
     /// \param[in] _entity Entity of the sensor
     /// \param[in] _sdf SDF description of the sensor
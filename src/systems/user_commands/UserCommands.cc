@@ -24,6 +24,8 @@
 #include <ignition/msgs/pose.pb.h>
 #include <ignition/msgs/physics.pb.h>
 
+#include <cstddef>
+#include <iterator>
 #include <string>
 #include <utility>
 #include <vector>
@@ -343,6 +345,11 @@ class ignition::gazebo::systems::UserCommandsPrivate
   /// \brief Queue of commands pending execution.
   public: std::vector<std::unique_ptr<UserCommandBase>> pendingCmds;
 
+  /// \brief Number of commands at the front of pendingCmds which were
+  /// pending when exclusive access was last requested, and may be executed
+  /// on the coming PreUpdate.
+  public: std::size_t readyCmds{0};
+
   /// \brief Ignition communication node.
   public: transport::Node node;
 
@@ -485,15 +492,23 @@ void UserCommands::PreUpdate(const UpdateInfo &/*_info*/,
     EntityComponentManager &)
 {
   IGN_PROFILE("UserCommands::PreUpdate");
-  // make a copy the cmds so execution does not block receiving other
-  // incoming cmds
+  // Commands received after NeedsExclusiveAccess wait for the next
+  // iteration, since this phase may be run concurrently with other systems.
+  // Commands are taken from the queue, so execution does not block receiving
+  // other incoming cmds.
   std::vector<std::unique_ptr<UserCommandBase>> cmds;
   {
     std::lock_guard<std::mutex> lock(this->dataPtr->pendingMutex);
-    if (this->dataPtr->pendingCmds.empty())
+    if (this->dataPtr->readyCmds == 0)
       return;
-    cmds = std::move(this->dataPtr->pendingCmds);
-    this->dataPtr->pendingCmds.clear();
+
+    auto ready = this->dataPtr->pendingCmds.begin() +
+        static_cast<std::ptrdiff_t>(this->dataPtr->readyCmds);
+    cmds.assign(std::make_move_iterator(this->dataPtr->pendingCmds.begin()),
+        std::make_move_iterator(ready));
+    this->dataPtr->pendingCmds.erase(this->dataPtr->pendingCmds.begin(),
+        ready);
+    this->dataPtr->readyCmds = 0;
   }
 
   // TODO(louise) Record current world state for undo
@@ -513,6 +528,34 @@ void UserCommands::PreUpdate(const UpdateInfo &/*_info*/,
   // TODO(louise) Clear redo list
 }
 
+//////////////////////////////////////////////////
+std::unordered_set<ComponentTypeId> UserCommands::ReadComponents() const
+{
+  return {components::Light::typeId, components::Model::typeId,
+      components::Name::typeId, components::ParentEntity::typeId,
+      components::World::typeId};
+}
+
+//////////////////////////////////////////////////
+std::unordered_set<ComponentTypeId> UserCommands::WriteComponents() const
+{
+  return {components::ContactSensorData::typeId, components::LightCmd::typeId,
+      components::PhysicsCmd::typeId, components::Pose::typeId,
+      components::WorldPoseCmd::typeId};
+}
+
+//////////////////////////////////////////////////
+bool UserCommands::NeedsExclusiveAccess(const EntityComponentManager &)
+{
+  // Commands may create or remove entities and components, so they're only
+  // executed with exclusive access. The queue is left as is; only the number
+  // of commands pending now is kept, so that PreUpdate doesn't execute
+  // commands received in between.
+  std::lock_guard<std::mutex> lock(this->dataPtr->pendingMutex);
+  this->dataPtr->readyCmds = this->dataPtr->pendingCmds.size();
+  return this->dataPtr->readyCmds > 0;
+}
+
 //////////////////////////////////////////////////
 bool UserCommandsPrivate::CreateServiceMultiple(
     const msgs::EntityFactory_V &_req, msgs::Boolean &_res)
@@ -1234,7 +1277,8 @@ bool DisableCollisionCommand::Execute()
 
 IGNITION_ADD_PLUGIN(UserCommands, System,
   UserCommands::ISystemConfigure,
-  UserCommands::ISystemPreUpdate
+  UserCommands::ISystemPreUpdate,
+  UserCommands::ISystemComponentAccess
 )
 
 IGNITION_ADD_PLUGIN_ALIAS(UserCommands,
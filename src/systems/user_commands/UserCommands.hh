@@ -18,6 +18,7 @@
 #define IGNITION_GAZEBO_SYSTEMS_USERCOMMANDS_HH_
 
 #include <memory>
+#include <unordered_set>
 #include <ignition/gazebo/config.hh>
 #include <ignition/gazebo/System.hh>
 
@@ -57,7 +58,8 @@ namespace systems
   class UserCommands:
     public System,
     public ISystemConfigure,
-    public ISystemPreUpdate
+    public ISystemPreUpdate,
+    public ISystemComponentAccess
   {
     /// \brief Constructor
     public: explicit UserCommands();
@@ -79,6 +81,26 @@ namespace systems
     public: void PreUpdate(const UpdateInfo &_info,
                            EntityComponentManager &_ecm) final;
 
+    /// \brief Components which commands look up entities by.
+    /// \return Light, Model, Name, ParentEntity and World.
+    public: std::unordered_set<ComponentTypeId>
+                ReadComponents() const final;
+
+    /// \brief Components which commands set. Commands also create and
+    /// remove entities, so they're only executed with exclusive access.
+    /// \return ContactSensorData, LightCmd, PhysicsCmd, Pose and
+    /// WorldPoseCmd.
+    public: std::unordered_set<ComponentTypeId>
+                WriteComponents() const final;
+
+    /// \brief Check whether commands were received, which will be executed
+    /// on the coming PreUpdate. Commands received afterwards wait for the
+    /// next iteration.
+    /// \param[in] _ecm The entity component manager.
+    /// \return True if there are commands to execute.
+    public: bool NeedsExclusiveAccess(
+                const EntityComponentManager &_ecm) final;
+
     /// \brief Private data pointer.
     private: std::unique_ptr<UserCommandsPrivate> dataPtr;
   };
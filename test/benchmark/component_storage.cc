@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "ignition/gazebo/components/Pose.hh"
+#include "ignition/gazebo/detail/ComponentStorageBase.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Create `_st.range(0)` components, then remove them in random
+/// order. Items per second counts both creations and removals.
+static void CreateRemove(benchmark::State &_st)
+{
+  const int count = _st.range(0);
+  const components::Pose pose(math::Pose3d(1, 2, 3, 0, 0, 0));
+
+  std::vector<ComponentId> ids(count);
+  std::mt19937 rng(1234);
+
+  for (auto _ : _st)
+  {
+    ComponentStorage<components::Pose> storage;
+    for (int i = 0; i < count; ++i)
+      ids[i] = storage.Create(&pose).first;
+
+    _st.PauseTiming();
+    std::shuffle(ids.begin(), ids.end(), rng);
+    _st.ResumeTiming();
+
+    for (const auto id : ids)
+    {
+      if (!storage.Remove(id))
+        _st.SkipWithError("Failed to remove component");
+    }
+  }
+  _st.SetItemsProcessed(_st.iterations() * count * 2);
+}
+
+/// \brief Look up `_st.range(0)` components by id in random order.
+static void Lookup(benchmark::State &_st)
+{
+  const int count = _st.range(0);
+  const components::Pose pose(math::Pose3d(1, 2, 3, 0, 0, 0));
+
+  ComponentStorage<components::Pose> storage;
+  std::vector<ComponentId> ids(count);
+  for (int i = 0; i < count; ++i)
+    ids[i] = storage.Create(&pose).first;
+
+  std::mt19937 rng(1234);
+  std::shuffle(ids.begin(), ids.end(), rng);
+
+  for (auto _ : _st)
+  {
+    for (const auto id : ids)
+      benchmark::DoNotOptimize(storage.Component(id));
+  }
+  _st.SetItemsProcessed(_st.iterations() * count);
+}
+
+/// \brief Steady-state churn: remove and recreate components in a storage
+/// that holds `_st.range(0)` components, as happens with command components.
+static void Churn(benchmark::State &_st)
+{
+  const int count = _st.range(0);
+  const components::Pose pose(math::Pose3d(1, 2, 3, 0, 0, 0));
+
+  ComponentStorage<components::Pose> storage;
+  std::vector<ComponentId> ids(count);
+  for (int i = 0; i < count; ++i)
+    ids[i] = storage.Create(&pose).first;
+
+  std::mt19937 rng(1234);
+  std::uniform_int_distribution<int> dist(0, count - 1);
+
+  for (auto _ : _st)
+  {
+    auto &id = ids[dist(rng)];
+    storage.Remove(id);
+    id = storage.Create(&pose).first;
+  }
+  _st.SetItemsProcessed(_st.iterations() * 2);
+}
+
+BENCHMARK(CreateRemove)
+  ->Arg(1000)
+  ->Arg(10000)
+  ->Arg(100000)
+  ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(Lookup)
+  ->Arg(1000)
+  ->Arg(10000)
+  ->Arg(100000)
+  ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(Churn)
+  ->Arg(1000)
+  ->Arg(100000);
+
+// OSX needs the semicolon, Ubuntu complains that there's an extra ';'
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+BENCHMARK_MAIN();
+#pragma GCC diagnostic pop
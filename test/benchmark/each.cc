@@ -359,6 +359,55 @@ BENCHMARK_DEFINE_F(ManyComponentFixture, Each10ComponentNoCache)
   }
 }
 
+/// Per-entity work for the serial vs parallel comparison: integrate the
+/// velocities into the pose.
+static void Integrate(Pose *_pose, const LinearVelocity *_linVel,
+    const AngularVelocity *_angVel)
+{
+  constexpr double dt{0.001};
+  auto &pose = _pose->Data();
+  pose.Pos() += pose.Rot().RotateVector(_linVel->Data()) * dt;
+  pose.Rot() = pose.Rot() * math::Quaterniond(_angVel->Data() * dt);
+  pose.Rot().Normalize();
+}
+
+BENCHMARK_DEFINE_F(ManyComponentFixture, IntegrateSerial)
+(benchmark::State &_st)
+{
+  for (auto _ : _st)
+  {
+    for (int eachIter = 0; eachIter < kEachIterations; eachIter++)
+    {
+      mgr->Each<Pose, LinearVelocity, AngularVelocity>(
+          [&](const Entity &, Pose *_pose, LinearVelocity *_linVel,
+              AngularVelocity *_angVel)->bool
+          {
+            Integrate(_pose, _linVel, _angVel);
+            return true;
+          });
+    }
+  }
+  _st.SetItemsProcessed(_st.iterations() * kEachIterations * _st.range(0));
+}
+
+BENCHMARK_DEFINE_F(ManyComponentFixture, IntegrateParallel)
+(benchmark::State &_st)
+{
+  for (auto _ : _st)
+  {
+    for (int eachIter = 0; eachIter < kEachIterations; eachIter++)
+    {
+      mgr->EachParallel<Pose, LinearVelocity, AngularVelocity>(
+          [&](const Entity &, Pose *_pose, LinearVelocity *_linVel,
+              AngularVelocity *_angVel)
+          {
+            Integrate(_pose, _linVel, _angVel);
+          });
+    }
+  }
+  _st.SetItemsProcessed(_st.iterations() * kEachIterations * _st.range(0));
+}
+
 /// Method to generate test argument combinations.  google/benchmark does
 /// powers of 2 by default, which looks kind of ugly.
 static void EachTestArgs(benchmark::internal::Benchmark *_b)
@@ -390,36 +439,54 @@ BENCHMARK_REGISTER_F(ManyComponentFixture, Each1ComponentNoCache)
   ->Arg(10)
   ->Arg(100)
   ->Arg(1000)
+  ->Arg(10000)
   ->Unit(benchmark::kMillisecond);
 
 BENCHMARK_REGISTER_F(ManyComponentFixture, Each1ComponentCache)
   ->Arg(10)
   ->Arg(100)
   ->Arg(1000)
+  ->Arg(10000)
   ->Unit(benchmark::kMillisecond);
 
 BENCHMARK_REGISTER_F(ManyComponentFixture, Each5ComponentNoCache)
   ->Arg(10)
   ->Arg(100)
   ->Arg(1000)
+  ->Arg(10000)
   ->Unit(benchmark::kMillisecond);
 
 BENCHMARK_REGISTER_F(ManyComponentFixture, Each5ComponentCache)
   ->Arg(10)
   ->Arg(100)
   ->Arg(1000)
+  ->Arg(10000)
   ->Unit(benchmark::kMillisecond);
 
 BENCHMARK_REGISTER_F(ManyComponentFixture, Each10ComponentNoCache)
   ->Arg(10)
   ->Arg(100)
   ->Arg(1000)
+  ->Arg(10000)
   ->Unit(benchmark::kMillisecond);
 
 BENCHMARK_REGISTER_F(ManyComponentFixture, Each10ComponentCache)
   ->Arg(10)
   ->Arg(100)
   ->Arg(1000)
+  ->Arg(10000)
+  ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_REGISTER_F(ManyComponentFixture, IntegrateSerial)
+  ->Arg(1000)
+  ->Arg(10000)
+  ->Arg(100000)
+  ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_REGISTER_F(ManyComponentFixture, IntegrateParallel)
+  ->Arg(1000)
+  ->Arg(10000)
+  ->Arg(100000)
   ->Unit(benchmark::kMillisecond);
 
 // OSX needs the semicolon, Ubuntu complains that there's an extra ';'
@@ -130,6 +130,108 @@ void BM_Serialize5Component(benchmark::State &_st)
   _st.counters["num_components"] = 5;
 }
 
+// NOLINTNEXTLINE
+void BM_SerializeStateMap(benchmark::State &_st)
+{
+  // Unlike the benchmarks above, the same manager is serialized on every
+  // iteration, as is done by the scene broadcaster and log recorder.
+  auto entityCount = _st.range(0);
+  auto mgr = std::make_unique<EntityComponentManager>();
+  for (int ii = 0; ii < entityCount; ++ii)
+  {
+    auto e = mgr->CreateEntity();
+    mgr->CreateComponent(e, IntComponent(ii));
+    mgr->CreateComponent(e, UIntComponent(ii));
+    mgr->CreateComponent(e, DoubleComponent(ii));
+    mgr->CreateComponent(e, StringComponent("foobar"));
+    mgr->CreateComponent(e, BoolComponent(ii%2));
+  }
+
+  size_t stateEntities = 0;
+  for (auto _: _st)
+  {
+    msgs::SerializedStateMap stateMsg;
+    mgr->State(stateMsg, {}, {}, true);
+    stateEntities = stateMsg.entities().size();
+  }
+
+  if (stateEntities != static_cast<size_t>(entityCount))
+    _st.SkipWithError("Failed to serialize all entities");
+
+  _st.counters["num_entities"] = entityCount;
+  _st.counters["num_components"] = 5;
+  _st.SetItemsProcessed(_st.iterations() * entityCount);
+}
+
+// NOLINTNEXTLINE
+void BM_SetStateMap(benchmark::State &_st)
+{
+  // State is applied on top of existing entities, as is done every
+  // iteration by GUI clients, network secondaries and log playback.
+  auto entityCount = _st.range(0);
+  EntityComponentManager srcMgr;
+  for (int ii = 0; ii < entityCount; ++ii)
+  {
+    auto e = srcMgr.CreateEntity();
+    srcMgr.CreateComponent(e, IntComponent(ii));
+    srcMgr.CreateComponent(e, UIntComponent(ii));
+    srcMgr.CreateComponent(e, DoubleComponent(ii));
+    srcMgr.CreateComponent(e, StringComponent("foobar"));
+    srcMgr.CreateComponent(e, BoolComponent(ii%2));
+  }
+
+  msgs::SerializedStateMap stateMsg;
+  srcMgr.State(stateMsg, {}, {}, true);
+
+  EntityComponentManager mgr;
+  mgr.SetState(stateMsg);
+
+  for (auto _: _st)
+  {
+    mgr.SetState(stateMsg);
+  }
+
+  if (mgr.EntityCount() != static_cast<size_t>(entityCount))
+    _st.SkipWithError("Failed to set all entities");
+
+  _st.counters["num_entities"] = entityCount;
+  _st.counters["num_components"] = 5;
+  _st.SetItemsProcessed(_st.iterations() * entityCount);
+}
+
+// NOLINTNEXTLINE
+void BM_SetState(benchmark::State &_st)
+{
+  auto entityCount = _st.range(0);
+  EntityComponentManager srcMgr;
+  for (int ii = 0; ii < entityCount; ++ii)
+  {
+    auto e = srcMgr.CreateEntity();
+    srcMgr.CreateComponent(e, IntComponent(ii));
+    srcMgr.CreateComponent(e, UIntComponent(ii));
+    srcMgr.CreateComponent(e, DoubleComponent(ii));
+    srcMgr.CreateComponent(e, StringComponent("foobar"));
+    srcMgr.CreateComponent(e, BoolComponent(ii%2));
+  }
+
+  auto stateMsg = srcMgr.State();
+
+  EntityComponentManager mgr;
+  mgr.SetState(stateMsg);
+
+  for (auto _: _st)
+  {
+    mgr.SetState(stateMsg);
+  }
+
+  if (mgr.EntityCount() != static_cast<size_t>(entityCount))
+    _st.SkipWithError("Failed to set all entities");
+
+  _st.counters["num_entities"] = entityCount;
+  _st.counters["num_components"] = 5;
+  _st.SetItemsProcessed(_st.iterations() * entityCount);
+}
+
 // NOLINTNEXTLINE
 BENCHMARK(BM_Serialize1Component)
   ->Arg(10)
@@ -148,6 +250,24 @@ BENCHMARK(BM_Serialize5Component)
   ->Arg(1000)
   ->Unit(benchmark::kMillisecond);
 
+// NOLINTNEXTLINE
+BENCHMARK(BM_SerializeStateMap)
+  ->Arg(1000)
+  ->Arg(10000)
+  ->Unit(benchmark::kMillisecond);
+
+// NOLINTNEXTLINE
+BENCHMARK(BM_SetStateMap)
+  ->Arg(1000)
+  ->Arg(10000)
+  ->Unit(benchmark::kMillisecond);
+
+// NOLINTNEXTLINE
+BENCHMARK(BM_SetState)
+  ->Arg(1000)
+  ->Arg(10000)
+  ->Unit(benchmark::kMillisecond);
+
 // OSX needs the semicolon, Ubuntu complains that there's an extra ';'
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wpedantic"
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+
+#include <ignition/math/Pose3.hh>
+
+#include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/Pose.hh"
+
+#include "../../src/BlockCompression.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Serialize a state similar to the one recorded each step: every
+/// entity has a name, and the poses changed.
+/// \param[in] _entityCount Number of entities.
+/// \return Serialized state.
+std::string serializedState(int _entityCount)
+{
+  EntityComponentManager ecm;
+  for (int i = 0; i < _entityCount; ++i)
+  {
+    auto e = ecm.CreateEntity();
+    ecm.CreateComponent(e, components::Name("model_" + std::to_string(i)));
+    ecm.CreateComponent(e, components::Pose(
+        math::Pose3d(i * 0.1, i * 0.2, 0.5, 0, 0, i * 0.01)));
+  }
+
+  msgs::SerializedStateMap stateMsg;
+  ecm.State(stateMsg);
+
+  std::string data;
+  stateMsg.SerializeToString(&data);
+  return data;
+}
+
+// NOLINTNEXTLINE
+void BM_CompressState(benchmark::State &_st)
+{
+  auto codec = static_cast<BlockCodec>(_st.range(0));
+  if (!BlockCodecAvailable(codec))
+  {
+    _st.SkipWithError("Codec not available");
+    return;
+  }
+
+  auto data = serializedState(_st.range(1));
+  std::string compressed;
+  for (auto _ : _st)
+  {
+    CompressBlock(data, codec, compressed);
+  }
+
+  _st.SetBytesProcessed(_st.iterations() * data.size());
+  _st.counters["bytes_per_step"] = compressed.size();
+  _st.counters["ratio"] = static_cast<double>(data.size()) /
+      compressed.size();
+}
+
+// NOLINTNEXTLINE
+void BM_DecompressState(benchmark::State &_st)
+{
+  auto codec = static_cast<BlockCodec>(_st.range(0));
+  if (!BlockCodecAvailable(codec))
+  {
+    _st.SkipWithError("Codec not available");
+    return;
+  }
+
+  auto data = serializedState(_st.range(1));
+  std::string compressed;
+  CompressBlock(data, codec, compressed);
+
+  std::string decompressed;
+  for (auto _ : _st)
+  {
+    DecompressBlock(compressed, decompressed);
+  }
+
+  _st.SetBytesProcessed(_st.iterations() * data.size());
+  _st.counters["bytes_per_step"] = compressed.size();
+}
+
+// NOLINTNEXTLINE
+BENCHMARK(BM_CompressState)
+  ->ArgsProduct({{static_cast<int>(BlockCodec::NONE),
+      static_cast<int>(BlockCodec::LZ), static_cast<int>(BlockCodec::ZSTD)},
+      {100, 1000, 10000}})
+  ->Unit(benchmark::kMicrosecond);
+
+// NOLINTNEXTLINE
+BENCHMARK(BM_DecompressState)
+  ->ArgsProduct({{static_cast<int>(BlockCodec::NONE),
+      static_cast<int>(BlockCodec::LZ), static_cast<int>(BlockCodec::ZSTD)},
+      {100, 1000, 10000}})
+  ->Unit(benchmark::kMicrosecond);
+
+// OSX needs the semicolon, Ubuntu complains that there's an extra ';'
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+BENCHMARK_MAIN();
+#pragma GCC diagnostic pop
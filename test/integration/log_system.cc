@@ -23,7 +23,11 @@
 #ifndef __APPLE__
 #include <filesystem>
 #endif
+#include <iterator>
+#include <map>
+#include <mutex>
 #include <numeric>
+#include <set>
 #include <string>
 
 #include <ignition/common/Console.hh>
@@ -32,6 +36,7 @@
 #include <ignition/fuel_tools/Zip.hh>
 #include <ignition/transport/Node.hh>
 #include <ignition/transport/log/Batch.hh>
+#include <ignition/transport/log/Descriptor.hh>
 #include <ignition/transport/log/Log.hh>
 #include <ignition/transport/log/MsgIter.hh>
 #include <ignition/transport/log/Playback.hh>
@@ -1703,3 +1708,370 @@ TEST_F(LogSystemTest, LogTopics)
   this->CreateLogsDir();
 #endif
 }
+
+/////////////////////////////////////////////////
+TEST_F(LogSystemTest, LogKeyframes)
+{
+  // Create temp directory to store log
+  this->CreateLogsDir();
+
+  // Record
+  {
+    const auto recordSdfPath = common::joinPaths(
+      std::string(PROJECT_SOURCE_PATH), "test", "worlds",
+      "log_record_dbl_pendulum.sdf");
+
+    sdf::Root recordSdfRoot;
+    this->ChangeLogPath(recordSdfRoot, recordSdfPath, "LogRecord",
+        this->logDir);
+    EXPECT_EQ(1u, recordSdfRoot.WorldCount());
+
+    // Record a keyframe every 2 seconds
+    sdf::ElementPtr pluginElt =
+        recordSdfRoot.WorldByIndex(0)->Element()->GetElement("plugin");
+    while (pluginElt != nullptr &&
+        pluginElt->GetAttribute("name")->GetAsString().find("LogRecord") ==
+        std::string::npos)
+    {
+      pluginElt = pluginElt->GetNextElement("plugin");
+    }
+    ASSERT_NE(nullptr, pluginElt);
+    sdf::ElementPtr periodElt = std::make_shared<sdf::Element>();
+    periodElt->SetName("keyframe_period");
+    pluginElt->AddElementDescription(periodElt);
+    periodElt = pluginElt->GetElement("keyframe_period");
+    periodElt->AddValue("double", "0", false, "");
+    periodElt->Set<double>(2.0);
+
+    ServerConfig recordServerConfig;
+    recordServerConfig.SetSdfString(recordSdfRoot.Element()->ToString(""));
+
+    // Run long enough for a forward seek to skip past what playback reads
+    // ahead
+    Server recordServer(recordServerConfig);
+    recordServer.Run(true, 12000, false);
+  }
+
+  auto logFile = common::joinPaths(this->logDir, "state.tlog");
+  ASSERT_TRUE(common::exists(logFile));
+
+  // There's a small index message for each keyframe
+  {
+    transport::log::Log log;
+    ASSERT_TRUE(log.Open(logFile));
+
+    auto indexBatch = log.QueryMessages(transport::log::TopicPattern(
+        std::regex(".*/keyframe_index")));
+    auto keyframeBatch = log.QueryMessages(transport::log::TopicPattern(
+        std::regex(".*/keyframe_state")));
+    int indexCount = std::distance(indexBatch.begin(), indexBatch.end());
+    int keyframeCount = std::distance(keyframeBatch.begin(),
+        keyframeBatch.end());
+    EXPECT_EQ(6, indexCount);
+    EXPECT_EQ(indexCount, keyframeCount);
+  }
+
+  // Playback
+  ServerConfig config;
+  config.SetLogPlaybackPath(this->logDir);
+  Server server(config);
+
+  std::map<Entity, math::Pose3d> poses;
+  test::Relay testSystem;
+  testSystem.OnPostUpdate(
+      [&](const UpdateInfo &, const EntityComponentManager &_ecm)
+      {
+        poses.clear();
+        _ecm.Each<components::Pose>(
+            [&](const Entity &_entity, const components::Pose *_pose)->bool
+            {
+              poses[_entity] = _pose->Data();
+              return true;
+            });
+      });
+  server.AddSystem(testSystem.systemPtr);
+  server.Run(true, 10, false);
+  auto posesStart = poses;
+  EXPECT_FALSE(posesStart.empty());
+
+  transport::Node node;
+  msgs::LogPlaybackControl req;
+  msgs::Boolean res;
+  bool result{false};
+  unsigned int timeout = 1000;
+  std::string service{"/world/log_pendulum/playback/control"};
+
+  auto seek = [&](int _sec)
+  {
+    req.Clear();
+    req.mutable_seek()->set_sec(_sec);
+    EXPECT_TRUE(node.Request(service, req, timeout, res, result));
+    EXPECT_TRUE(result);
+    EXPECT_TRUE(res.data());
+
+    // Run 2 iterations because control messages are processed in the end of
+    // an update cycle
+    server.Run(true, 2, false);
+    return poses;
+  };
+
+  // Jump forward, starting from the keyframe at 10s
+  auto posesA = seek(11);
+  EXPECT_EQ(posesStart.size(), posesA.size());
+  EXPECT_NE(posesStart, posesA);
+
+  // Seek back, starting from the keyframe at 4s
+  auto posesB = seek(5);
+  EXPECT_EQ(posesStart.size(), posesB.size());
+  EXPECT_NE(posesA, posesB);
+
+  // Step forward again, replaying the changes since 5s, which must reach the
+  // same state as the keyframe
+  EXPECT_EQ(posesA, seek(11));
+
+  // Seek back again
+  EXPECT_EQ(posesB, seek(5));
+
+  // Rewind
+  req.Clear();
+  req.set_rewind(true);
+  EXPECT_TRUE(node.Request(service, req, timeout, res, result));
+  EXPECT_TRUE(result);
+  EXPECT_TRUE(res.data());
+  server.Run(true, 2, false);
+  EXPECT_EQ(posesStart.size(), poses.size());
+
+  this->RemoveLogsDir();
+}
+
+/////////////////////////////////////////////////
+TEST_F(LogSystemTest, LogRecordReplaysState)
+{
+  // Create temp directory to store log
+  this->CreateLogsDir();
+
+  // Poses of all entities at each recorded iteration
+  std::map<std::chrono::steady_clock::duration,
+      std::map<Entity, math::Pose3d>> recordedPoses;
+  auto allPoses = [](const EntityComponentManager &_ecm)
+  {
+    std::map<Entity, math::Pose3d> poses;
+    _ecm.Each<components::Pose>(
+        [&](const Entity &_entity, const components::Pose *_pose)->bool
+        {
+          poses[_entity] = _pose->Data();
+          return true;
+        });
+    return poses;
+  };
+
+  // Record
+  {
+    const auto recordSdfPath = common::joinPaths(
+      std::string(PROJECT_SOURCE_PATH), "test", "worlds",
+      "log_record_dbl_pendulum.sdf");
+
+    ServerConfig recordServerConfig;
+    recordServerConfig.SetSdfFile(recordSdfPath);
+    recordServerConfig.SetUseLogRecord(true);
+    recordServerConfig.SetLogRecordPath(this->logDir);
+
+    test::Relay recordedPoseTester;
+    recordedPoseTester.OnPostUpdate(
+        [&](const UpdateInfo &_info, const EntityComponentManager &_ecm)
+        {
+          recordedPoses[_info.simTime] = allPoses(_ecm);
+        });
+
+    // Everything queued for the writer thread is in the log once the server
+    // is destroyed
+    Server recordServer(recordServerConfig);
+    recordServer.AddSystem(recordedPoseTester.systemPtr);
+    recordServer.Run(true, 500, false);
+  }
+  EXPECT_EQ(500u, recordedPoses.size());
+
+  auto logFile = common::joinPaths(this->logDir, "state.tlog");
+  ASSERT_TRUE(common::exists(logFile));
+
+  // The log has the same topics as when it was written from the simulation
+  // thread, each with messages in time order
+  {
+    transport::log::Log log;
+    ASSERT_TRUE(log.Open(logFile));
+
+    std::set<std::string> topics;
+    for (const auto &topic : log.Descriptor()->TopicsToMsgTypesToId())
+      topics.insert(topic.first);
+    EXPECT_EQ((std::set<std::string>{
+        "/world/log_pendulum/changed_state",
+        "/world/log_pendulum/dynamic_pose/info",
+        "/world/log_pendulum/sdf"}), topics);
+
+    for (const auto &topic : topics)
+    {
+      auto batch = log.QueryMessages(transport::log::TopicList(topic));
+      std::chrono::nanoseconds lastTime{0};
+      int count{0};
+      for (const auto &msg : batch)
+      {
+        EXPECT_LE(lastTime, msg.TimeReceived()) << topic;
+        lastTime = msg.TimeReceived();
+        ++count;
+      }
+      EXPECT_LT(0, count) << topic;
+    }
+  }
+
+  // Playback reaches the same state at every recorded iteration
+  ServerConfig playServerConfig;
+  playServerConfig.SetLogPlaybackPath(this->logDir);
+  Server playServer(playServerConfig);
+
+  int compared{0};
+  test::Relay playbackPoseTester;
+  playbackPoseTester.OnPostUpdate(
+      [&](const UpdateInfo &_info, const EntityComponentManager &_ecm)
+      {
+        auto recordedIt = recordedPoses.find(_info.simTime);
+        if (recordedIt == recordedPoses.end())
+          return;
+
+        auto played = allPoses(_ecm);
+        for (const auto &[entity, pose] : recordedIt->second)
+        {
+          auto playedIt = played.find(entity);
+          ASSERT_NE(played.end(), playedIt) << entity;
+          EXPECT_EQ(pose, playedIt->second) << entity;
+        }
+        ++compared;
+      });
+  playServer.AddSystem(playbackPoseTester.systemPtr);
+  playServer.Run(true, 500, false);
+  EXPECT_EQ(500, compared);
+
+  this->RemoveLogsDir();
+}
+
+/////////////////////////////////////////////////
+TEST_F(LogSystemTest, LogPlaybackPrefetch)
+{
+  // Create temp directory to store log
+  this->CreateLogsDir();
+
+  // Poses of all entities every 100 iterations, keyed by sim time
+  std::map<std::chrono::steady_clock::duration,
+      std::map<Entity, math::Pose3d>> recordedPoses;
+  auto allPoses = [](const EntityComponentManager &_ecm)
+  {
+    std::map<Entity, math::Pose3d> poses;
+    _ecm.Each<components::Pose>(
+        [&](const Entity &_entity, const components::Pose *_pose)->bool
+        {
+          poses[_entity] = _pose->Data();
+          return true;
+        });
+    return poses;
+  };
+
+  // Record a log longer than what playback reads ahead at once, without
+  // keyframes
+  {
+    const auto recordSdfPath = common::joinPaths(
+      std::string(PROJECT_SOURCE_PATH), "test", "worlds",
+      "log_record_dbl_pendulum.sdf");
+
+    ServerConfig recordServerConfig;
+    recordServerConfig.SetSdfFile(recordSdfPath);
+    recordServerConfig.SetUseLogRecord(true);
+    recordServerConfig.SetLogRecordPath(this->logDir);
+
+    test::Relay recordedPoseTester;
+    recordedPoseTester.OnPostUpdate(
+        [&](const UpdateInfo &_info, const EntityComponentManager &_ecm)
+        {
+          if (_info.iterations % 100 == 0)
+            recordedPoses[_info.simTime] = allPoses(_ecm);
+        });
+
+    Server recordServer(recordServerConfig);
+    recordServer.AddSystem(recordedPoseTester.systemPtr);
+    recordServer.Run(true, 12000, false);
+  }
+  ASSERT_EQ(120u, recordedPoses.size());
+
+  // Playback, comparing against the recorded poses whenever the sim time
+  // matches
+  ServerConfig playServerConfig;
+  playServerConfig.SetLogPlaybackPath(this->logDir);
+  Server playServer(playServerConfig);
+
+  std::mutex mutex;
+  int compared{0};
+  std::chrono::steady_clock::duration lastComparedTime{0};
+  test::Relay playbackPoseTester;
+  playbackPoseTester.OnPostUpdate(
+      [&](const UpdateInfo &_info, const EntityComponentManager &_ecm)
+      {
+        auto recordedIt = recordedPoses.find(_info.simTime);
+        if (recordedIt == recordedPoses.end())
+          return;
+
+        auto played = allPoses(_ecm);
+        for (const auto &[entity, pose] : recordedIt->second)
+        {
+          auto playedIt = played.find(entity);
+          ASSERT_NE(played.end(), playedIt) << entity;
+          EXPECT_EQ(pose, playedIt->second) << entity << " at "
+              << _info.simTime.count();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        ++compared;
+        lastComparedTime = _info.simTime;
+      });
+  playServer.AddSystem(playbackPoseTester.systemPtr);
+
+  // Continuous stepping, across the end of the first prefetch window at 10 s
+  playServer.Run(true, 11000, false);
+  EXPECT_EQ(110, compared);
+
+  transport::Node node;
+  msgs::LogPlaybackControl req;
+  msgs::Boolean res;
+  bool result{false};
+  unsigned int timeout = 1000;
+  std::string service{"/world/log_pendulum/playback/control"};
+
+  // Rewind, which replays the log from the start
+  req.Clear();
+  req.set_rewind(true);
+  EXPECT_TRUE(node.Request(service, req, timeout, res, result));
+  EXPECT_TRUE(result);
+  EXPECT_TRUE(res.data());
+  compared = 0;
+  playServer.Run(true, 1000, false);
+  EXPECT_LE(9, compared);
+
+  // Jump forward further than what's read ahead. There are no keyframes, so
+  // all changes in between are read from the log.
+  req.Clear();
+  req.mutable_seek()->set_sec(11);
+  EXPECT_TRUE(node.Request(service, req, timeout, res, result));
+  EXPECT_TRUE(result);
+  EXPECT_TRUE(res.data());
+  compared = 0;
+  playServer.Run(true, 500, false);
+  EXPECT_LE(4, compared);
+
+  // Keep playing until the end of the log, where playback pauses
+  playServer.Run(false, 0, false);
+  for (int sleep = 0; sleep < 300 && !*playServer.Paused(); ++sleep)
+    IGN_SLEEP_MS(100);
+  EXPECT_TRUE(*playServer.Paused());
+
+  std::lock_guard<std::mutex> lock(mutex);
+  EXPECT_EQ(recordedPoses.rbegin()->first, lastComparedTime);
+
+  this->RemoveLogsDir();
+}
@@ -122,7 +122,9 @@ TEST_F(NetworkHandshake, Handshake)
 }
 
 /////////////////////////////////////////////////
-TEST_F(NetworkHandshake, Updates)
+// Run a primary and a secondary simulating physics, and check the primary
+// publishes the poses computed by the secondary.
+void checkUpdates(unsigned int _maxStaleness)
 {
   auto pluginElem = std::make_shared<sdf::Element>();
   pluginElem->SetName("plugin");
@@ -145,6 +147,7 @@ TEST_F(NetworkHandshake, Updates)
   // the same process causes a segfault, see
   // https://github.com/ignitionrobotics/ign-gazebo/issues/18
   configPrimary.SetNetworkSecondaries(1);
+  configPrimary.SetNetworkMaxStaleness(_maxStaleness);
   configPrimary.SetSdfFile(std::string(PROJECT_SOURCE_PATH) +
       "/test/worlds/performers.sdf");
   configPrimary.AddPlugin(primaryPluginInfo);
@@ -225,3 +228,16 @@ TEST_F(NetworkHandshake, Updates)
   serverPrimary.reset();
   serverSecondary1.reset();
 }
+
+/////////////////////////////////////////////////
+TEST_F(NetworkHandshake, Updates)
+{
+  checkUpdates(0);
+}
+
+/////////////////////////////////////////////////
+TEST_F(NetworkHandshake, PipelinedUpdates)
+{
+  // The secondary may run up to 2 steps ahead of the primary
+  checkUpdates(2);
+}
@@ -18,16 +18,23 @@
 #include <gtest/gtest.h>
 #include <google/protobuf/util/message_differencer.h>
 
+#include <mutex>
+#include <set>
 #include <thread>
 
 #include <ignition/common/Console.hh>
 #include <ignition/common/Util.hh>
+#include <ignition/msgs/empty.pb.h>
+#include <ignition/msgs/param.pb.h>
+#include <ignition/msgs/stringmsg_v.pb.h>
 #include <ignition/transport/Node.hh>
 
+#include "ignition/gazebo/components/Pose.hh"
 #include "ignition/gazebo/Server.hh"
 #include "ignition/gazebo/test_config.hh"
 
 #include "../helpers/EnvTestFixture.hh"
+#include "../../src/SharedMemoryRing.hh"
 
 using namespace ignition;
 
@@ -87,6 +94,103 @@ TEST_P(SceneBroadcasterTest, PoseInfo)
   EXPECT_TRUE(received);
 }
 
+/////////////////////////////////////////////////
+TEST_P(SceneBroadcasterTest, ChangedPoses)
+{
+  // A falling box over a static ground, keyframes too far apart to happen
+  // during the test
+  std::string sdf = R"(
+    <?xml version="1.0" ?>
+    <sdf version="1.6">
+      <world name="default">
+        <plugin
+          filename="ignition-gazebo-physics-system"
+          name="ignition::gazebo::systems::Physics">
+        </plugin>
+        <plugin
+          filename="ignition-gazebo-scene-broadcaster-system"
+          name="ignition::gazebo::systems::SceneBroadcaster">
+          <changed_poses_only>true</changed_poses_only>
+          <pose_keyframe_hertz>0.01</pose_keyframe_hertz>
+        </plugin>
+        <model name="ground">
+          <static>true</static>
+          <link name="ground_link">
+            <collision name="ground_collision">
+              <geometry><box><size>10 10 1</size></box></geometry>
+            </collision>
+            <visual name="ground_visual">
+              <geometry><box><size>10 10 1</size></box></geometry>
+            </visual>
+          </link>
+        </model>
+        <model name="box">
+          <pose>0 0 100 0 0 0</pose>
+          <link name="box_link">
+            <collision name="box_collision">
+              <geometry><box><size>1 1 1</size></box></geometry>
+            </collision>
+          </link>
+        </model>
+      </world>
+    </sdf>)";
+
+  ignition::gazebo::ServerConfig serverConfig;
+  serverConfig.SetSdfString(sdf);
+  gazebo::Server server(serverConfig);
+
+  std::mutex mutex;
+  int keyframes{0};
+  int deltas{0};
+  std::function<void(const msgs::Pose_V &)> cb = [&](const msgs::Pose_V &_msg)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_TRUE(_msg.has_header());
+    ASSERT_EQ(1, _msg.header().data_size());
+    EXPECT_EQ("keyframe", _msg.header().data(0).key());
+    ASSERT_EQ(1, _msg.header().data(0).value_size());
+
+    std::set<std::string> names;
+    for (const auto &pose : _msg.pose())
+      names.insert(pose.name());
+
+    // Keyframes have all poses, the rest only what moved
+    if (_msg.header().data(0).value(0) == "true")
+    {
+      EXPECT_EQ(5u, names.size());
+      EXPECT_EQ(1u, names.count("ground"));
+      ++keyframes;
+    }
+    else
+    {
+      EXPECT_EQ(1u, names.count("box"));
+      EXPECT_EQ(0u, names.count("ground"));
+      EXPECT_EQ(0u, names.count("ground_link"));
+      EXPECT_EQ(0u, names.count("ground_visual"));
+      ++deltas;
+    }
+  };
+
+  transport::Node node;
+  EXPECT_TRUE(node.Subscribe("/world/default/pose/info", cb));
+
+  unsigned int sleep{0u};
+  unsigned int maxSleep{30u};
+  while (sleep++ < maxSleep)
+  {
+    server.Run(true, 100, false);
+    IGN_SLEEP_MS(100);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (deltas > 3)
+      break;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  EXPECT_EQ(1, keyframes);
+  EXPECT_LT(3, deltas);
+}
+
 /////////////////////////////////////////////////
 TEST_P(SceneBroadcasterTest, SceneInfo)
 {
@@ -509,6 +613,245 @@ TEST_P(SceneBroadcasterTest, State)
   EXPECT_TRUE(received);
 }
 
+/////////////////////////////////////////////////
+TEST_P(SceneBroadcasterTest, StateChangeEvent)
+{
+  // Start server
+  ignition::gazebo::ServerConfig serverConfig;
+  serverConfig.SetSdfFile(std::string(PROJECT_SOURCE_PATH) +
+      "/test/worlds/shapes.sdf");
+
+  gazebo::Server server(serverConfig);
+  const std::size_t initEntityCount = 24;
+  EXPECT_EQ(initEntityCount, *server.EntityCount());
+
+  server.Run(true, 1, false);
+
+  transport::Node node;
+
+  // Only check the message which carries the spawned model
+  std::mutex mutex;
+  bool received{false};
+  int entityCount{0};
+  std::function<void(const msgs::SerializedStepMap &)> cb =
+      [&](const msgs::SerializedStepMap &_msg)
+  {
+    for (const auto &entity : _msg.state().entities())
+    {
+      for (const auto &comp : entity.second.components())
+      {
+        if (comp.second.component().find("spawned_model") !=
+            std::string::npos)
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (!received)
+            entityCount = _msg.state().entities_size();
+          received = true;
+        }
+      }
+    }
+  };
+  EXPECT_TRUE(node.Subscribe("/world/default/state", cb));
+
+  // Let the subscription be discovered
+  server.Run(true, 100, false);
+
+  // Spawn a model
+  {
+    auto modelStr = R"(
+<?xml version="1.0" ?>
+<sdf version='1.6'>
+  <model name='spawned_model'>
+    <link name='link'>
+      <visual name='visual'>
+        <geometry><sphere><radius>1.0</radius></sphere></geometry>
+      </visual>
+    </link>
+  </model>
+</sdf>)";
+
+    msgs::EntityFactory req;
+    msgs::Boolean res;
+    bool result;
+    unsigned int timeout = 5000;
+    req.set_sdf(modelStr);
+    EXPECT_TRUE(node.Request("/world/default/create",
+          req, timeout, res, result));
+    EXPECT_TRUE(result);
+    EXPECT_TRUE(res.data());
+  }
+
+  unsigned int sleep{0u};
+  unsigned int maxSleep{30u};
+  while (sleep++ < maxSleep)
+  {
+    server.Run(true, 1, false);
+    IGN_SLEEP_MS(100);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (received)
+      break;
+  }
+
+  // The change event only carries the new model, link and visual, and
+  // entities which changed during the same iteration, not the whole world.
+  std::lock_guard<std::mutex> lock(mutex);
+  EXPECT_TRUE(received);
+  EXPECT_LE(3, entityCount);
+  EXPECT_GT(static_cast<int>(initEntityCount), entityCount);
+}
+
+/////////////////////////////////////////////////
+TEST_P(SceneBroadcasterTest, StateFilter)
+{
+  // Start server
+  ignition::gazebo::ServerConfig serverConfig;
+  serverConfig.SetSdfFile(std::string(PROJECT_SOURCE_PATH) +
+      "/test/worlds/shapes.sdf");
+
+  gazebo::Server server(serverConfig);
+  server.Run(true, 1, false);
+
+  transport::Node node;
+
+  // Register a filter for poses
+  auto requestFilter = [&](const std::string &_components, double _hz)
+  {
+    msgs::Param req;
+    msgs::StringMsg res;
+    bool result{false};
+    unsigned int timeout = 5000;
+
+    auto &params = *req.mutable_params();
+    params["components"].set_type(msgs::Any::STRING);
+    params["components"].set_string_value(_components);
+    params["hz"].set_type(msgs::Any::DOUBLE);
+    params["hz"].set_double_value(_hz);
+
+    EXPECT_TRUE(node.Request("/world/default/state/filter", req, timeout,
+        res, result));
+    EXPECT_TRUE(result);
+    return res.data();
+  };
+
+  auto poseTopic = requestFilter("ign_gazebo_components.Pose", 10.0);
+  EXPECT_FALSE(poseTopic.empty());
+
+  // The same filter is shared, a different one gets its own topic
+  EXPECT_EQ(poseTopic, requestFilter("ign_gazebo_components.Pose", 10.0));
+  EXPECT_NE(poseTopic, requestFilter("ign_gazebo_components.Name", 10.0));
+
+  // Entities can be given as strings, which hold any ID
+  {
+    msgs::Param req;
+    msgs::StringMsg res;
+    bool result{false};
+    unsigned int timeout = 5000;
+
+    auto &params = *req.mutable_params();
+    params["entity"].set_type(msgs::Any::STRING);
+    params["entity"].set_string_value("18446744073709551614");
+    EXPECT_TRUE(node.Request("/world/default/state/filter", req, timeout,
+        res, result));
+    EXPECT_TRUE(result);
+    EXPECT_FALSE(res.data().empty());
+    EXPECT_NE(poseTopic, res.data());
+
+    params["entity"].set_string_value("model");
+    EXPECT_TRUE(node.Request("/world/default/state/filter", req, timeout,
+        res, result));
+    EXPECT_FALSE(result);
+  }
+
+  std::mutex mutex;
+  int received{0};
+  std::function<void(const msgs::SerializedStepMap &)> cb =
+      [&](const msgs::SerializedStepMap &_msg)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_LT(0, _msg.state().entities_size());
+    for (const auto &entity : _msg.state().entities())
+    {
+      for (const auto &comp : entity.second.components())
+      {
+        EXPECT_EQ(gazebo::components::Pose::typeId, comp.second.type());
+      }
+    }
+    ++received;
+  };
+  EXPECT_TRUE(node.Subscribe(poseTopic, cb));
+
+  unsigned int sleep{0u};
+  unsigned int maxSleep{30u};
+  while (sleep++ < maxSleep)
+  {
+    server.Run(true, 100, false);
+    IGN_SLEEP_MS(100);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (received > 0)
+      break;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  EXPECT_LT(0, received);
+}
+
+/////////////////////////////////////////////////
+// Shared memory isn't supported on Windows
+#ifndef _WIN32
+TEST_P(SceneBroadcasterTest, StateSharedMemory)
+{
+  // Start server
+  ignition::gazebo::ServerConfig serverConfig;
+  serverConfig.SetSdfFile(std::string(PROJECT_SOURCE_PATH) +
+      "/test/worlds/shapes.sdf");
+
+  gazebo::Server server(serverConfig);
+  server.Run(true, 1, false);
+
+  // Find the shared memory
+  transport::Node node;
+  msgs::Empty req;
+  msgs::StringMsg_V res;
+  bool result{false};
+  unsigned int timeout = 5000;
+  EXPECT_TRUE(node.Request("/world/default/state/shared_memory", req,
+      timeout, res, result));
+  EXPECT_TRUE(result);
+  ASSERT_EQ(2, res.data_size());
+
+  auto ring = gazebo::SharedMemoryRing::Open(res.data(0),
+      std::stoull(res.data(1)));
+  ASSERT_NE(nullptr, ring);
+
+  // The state is written periodically
+  std::string data;
+  bool keyframe{false};
+  uint64_t lost{0};
+  uint64_t lastIterations{0};
+  int received{0};
+  for (int i = 0; i < 5; ++i)
+  {
+    server.Run(true, 100, false);
+    IGN_SLEEP_MS(100);
+
+    while (ring->Read(data, keyframe, lost))
+    {
+      msgs::SerializedStepMap msg;
+      ASSERT_TRUE(msg.ParseFromString(data));
+      EXPECT_LT(lastIterations, msg.stats().iterations());
+      EXPECT_LT(0, msg.state().entities_size());
+      EXPECT_EQ(0u, lost);
+      lastIterations = msg.stats().iterations();
+      ++received;
+    }
+  }
+  EXPECT_LT(0, received);
+  EXPECT_FALSE(ring->Closed());
+}
+#endif
+
 /////////////////////////////////////////////////
 TEST_P(SceneBroadcasterTest, StateStatic)
 {
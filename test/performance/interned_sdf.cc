@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <fstream>
+#include <functional>
+#include <string>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+#include <ignition/common/Console.hh>
+#include <sdf/Link.hh>
+#include <sdf/Model.hh>
+#include <sdf/Root.hh>
+#include <sdf/Visual.hh>
+#include <sdf/World.hh>
+
+#include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/components/Camera.hh"
+#include "ignition/gazebo/components/Geometry.hh"
+#include "ignition/gazebo/components/Material.hh"
+
+#include "../../src/InternedSdf.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Get the resident set size of this process.
+/// \return Size in bytes, zero if unknown.
+std::size_t residentSetSize()
+{
+#ifdef __linux__
+  std::ifstream statm("/proc/self/statm");
+  std::size_t pages{0};
+  std::size_t resident{0};
+  statm >> pages >> resident;
+  return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#else
+  return 0;
+#endif
+}
+
+/// \brief Generate a world with one model, which has mesh visuals with
+/// materials, and a camera.
+/// \param[in] _index Index of the model, to give it a unique name.
+/// \return SDF string.
+std::string robotWorld(int _index)
+{
+  std::string sdf = "<?xml version='1.0'?><sdf version='1.6'>"
+      "<world name='default'>";
+  sdf += "<model name='robot_" + std::to_string(_index) +
+      "'><link name='base'>";
+  for (int v = 0; v < 4; ++v)
+  {
+    sdf += "<visual name='visual_" + std::to_string(v) + "'>"
+        "<geometry><mesh><uri>meshes/robot.dae</uri>"
+        "<submesh><name>part_" + std::to_string(v) + "</name></submesh>"
+        "<scale>1 1 1</scale></mesh></geometry>"
+        "<material><ambient>0.3 0.3 0.3 1</ambient>"
+        "<diffuse>0.7 0.7 0.7 1</diffuse>"
+        "<pbr><metal><albedo_map>albedo.png</albedo_map>"
+        "<normal_map>normal.png</normal_map></metal></pbr>"
+        "</material></visual>";
+  }
+  sdf += "<sensor name='camera' type='camera'><camera>"
+      "<horizontal_fov>1.047</horizontal_fov>"
+      "<image><width>320</width><height>240</height></image>"
+      "<clip><near>0.1</near><far>100</far></clip>"
+      "</camera><update_rate>30</update_rate></sensor>";
+  sdf += "</link></model></world></sdf>";
+  return sdf;
+}
+
+/////////////////////////////////////////////////
+TEST(InternedSdfPerformance, Memory)
+{
+  common::Console::SetVerbosity(4);
+
+  if (residentSetSize() == 0)
+  {
+    ignwarn << "Can't measure memory on this platform" << std::endl;
+    return;
+  }
+
+  const int count = 2000;
+
+  // Spawn every model from its own SDF, as the factory service does, and
+  // create its SDF-backed components in an ECM. Get how much the resident
+  // set grew once the loaded descriptions are gone, leaving only what the
+  // components keep alive.
+  auto populate = [&](EntityComponentManager &_ecm, bool _intern)
+  {
+    const auto before = residentSetSize();
+    for (int m = 0; m < count; ++m)
+    {
+      sdf::Root root;
+      EXPECT_TRUE(root.LoadSdfString(robotWorld(m)).empty());
+      auto link = root.WorldByIndex(0)->ModelByIndex(0)->LinkByIndex(0);
+      for (uint64_t v = 0; v < link->VisualCount(); ++v)
+      {
+        auto visual = link->VisualByIndex(v);
+        auto entity = _ecm.CreateEntity();
+        if (_intern)
+        {
+          _ecm.CreateComponent(entity,
+              components::Geometry(InternSdf(*visual->Geom())));
+          _ecm.CreateComponent(entity,
+              components::Material(InternSdf(*visual->Material())));
+        }
+        else
+        {
+          _ecm.CreateComponent(entity, components::Geometry(*visual->Geom()));
+          _ecm.CreateComponent(entity,
+              components::Material(*visual->Material()));
+        }
+      }
+
+      auto entity = _ecm.CreateEntity();
+      if (_intern)
+      {
+        _ecm.CreateComponent(entity,
+            components::Camera(InternSdf(*link->SensorByIndex(0))));
+      }
+      else
+      {
+        _ecm.CreateComponent(entity,
+            components::Camera(*link->SensorByIndex(0)));
+      }
+    }
+    return residentSetSize() - before;
+  };
+
+  // Both are kept alive, so that neither reuses memory freed by the other
+  EntityComponentManager internedEcm;
+  EntityComponentManager copiedEcm;
+  const auto interned = populate(internedEcm, true);
+  const auto copied = populate(copiedEcm, false);
+
+  igndbg << "\nSDF-backed components of [" << count << "] models:\n"
+         << "Copied: " << copied / 1024 << " KiB\n"
+         << "Interned: " << interned / 1024 << " KiB ("
+         << InternedSdfCount() << " shared elements)\n";
+
+  // One geometry per visual, since their submeshes differ, one material
+  // shared by all visuals, and one camera
+  EXPECT_EQ(6u, InternedSdfCount());
+  EXPECT_LT(interned, copied);
+}
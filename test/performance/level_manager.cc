@@ -18,6 +18,8 @@
 
 #include <gtest/gtest.h>
 #include <array>
+#include <sstream>
+#include <string>
 
 #include <ignition/math/Stopwatch.hh>
 #include <ignition/common/Console.hh>
@@ -77,3 +79,110 @@ TEST(LevelManagerPerfrormance, LevelVsNoLevel)
 
   EXPECT_LE(levelsDuration.count(), nolevelsDuration.count());
 }
+
+/////////////////////////////////////////////////
+/// \brief Generate a world with a grid of levels, each containing one
+/// static model, and performers spread over the grid.
+/// \param[in] _levelsX Number of levels along X.
+/// \param[in] _levelsY Number of levels along Y.
+/// \param[in] _performers Number of performers.
+/// \return SDF string.
+std::string LevelGridWorld(std::size_t _levelsX, std::size_t _levelsY,
+    std::size_t _performers)
+{
+  const double levelSize = 20.0;
+
+  std::ostringstream models;
+  std::ostringstream levels;
+  for (std::size_t x = 0; x < _levelsX; ++x)
+  {
+    for (std::size_t y = 0; y < _levelsY; ++y)
+    {
+      const std::string name = "tile_" + std::to_string(x) + "_" +
+          std::to_string(y);
+      const double posX = x * levelSize;
+      const double posY = y * levelSize;
+
+      models
+        << "<model name='" << name << "'>"
+        << "  <pose>" << posX << " " << posY << " 0 0 0 0</pose>"
+        << "  <static>true</static>"
+        << "  <link name='link'>"
+        << "    <collision name='collision'>"
+        << "      <geometry><box><size>5 5 0.5</size></box></geometry>"
+        << "    </collision>"
+        << "  </link>"
+        << "</model>";
+
+      levels
+        << "<level name='level_" << name << "'>"
+        << "  <pose>" << posX << " " << posY << " 0 0 0 0</pose>"
+        << "  <geometry><box><size>" << levelSize << " " << levelSize
+        << " 100</size></box></geometry>"
+        << "  <buffer>2</buffer>"
+        << "  <ref>" << name << "</ref>"
+        << "</level>";
+    }
+  }
+
+  std::ostringstream performers;
+  for (std::size_t i = 0; i < _performers; ++i)
+  {
+    const std::string name = "vehicle_" + std::to_string(i);
+    const double posX = (i * 7 % _levelsX) * levelSize;
+    const double posY = (i * 3 % _levelsY) * levelSize;
+
+    models
+      << "<model name='" << name << "'>"
+      << "  <pose>" << posX << " " << posY << " 1 0 0 0</pose>"
+      << "  <link name='link'/>"
+      << "</model>";
+
+    performers
+      << "<performer name='perf_" << name << "'>"
+      << "  <ref>" << name << "</ref>"
+      << "  <geometry><box><size>2 2 2</size></box></geometry>"
+      << "</performer>";
+  }
+
+  return std::string("<?xml version='1.0'?>") +
+      "<sdf version='1.6'>"
+      "<world name='default'>" + models.str() +
+      "<plugin name='ignition::gazebo' filename='dummy'>" +
+      performers.str() + levels.str() +
+      "</plugin>"
+      "</world>"
+      "</sdf>";
+}
+
+/////////////////////////////////////////////////
+TEST(LevelManagerPerfrormance, ManyLevels)
+{
+  using namespace std::chrono;
+
+  common::Console::SetVerbosity(4);
+
+  const std::size_t iters = 1000;
+
+  for (std::size_t levels : {100u, 1000u})
+  {
+    ignition::gazebo::ServerConfig serverConfig;
+    serverConfig.SetSdfString(LevelGridWorld(levels / 25, 25, 50));
+    serverConfig.SetUseLevels(true);
+
+    gazebo::Server server(serverConfig);
+    server.SetUpdatePeriod(1ns);
+
+    math::Stopwatch watch;
+    watch.Start(true);
+    server.Run(true, iters, false);
+    watch.Stop();
+
+    ASSERT_TRUE(server.IterationCount().has_value());
+    EXPECT_EQ(iters, *server.IterationCount());
+
+    igndbg << "\n" << levels << " levels, 50 performers: "
+           << duration_cast<microseconds>(watch.ElapsedRunTime()).count() /
+              iters << " us per iteration\n";
+  }
+}
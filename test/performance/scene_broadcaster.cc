@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Util.hh>
+#include <ignition/msgs/serialized_map.pb.h>
+#include <ignition/transport/Node.hh>
+
+#include "ignition/gazebo/components/Model.hh"
+#include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/ParentEntity.hh"
+#include "ignition/gazebo/components/Pose.hh"
+#include "ignition/gazebo/components/World.hh"
+#include "ignition/gazebo/Server.hh"
+#include "ignition/gazebo/test_config.hh"  // NOLINT(build/include)
+
+#include "../helpers/Relay.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/////////////////////////////////////////////////
+/// \brief Generate a world with static models and the scene broadcaster.
+/// \param[in] _models Number of models.
+/// \return SDF string.
+std::string ModelsWorld(std::size_t _models)
+{
+  std::ostringstream models;
+  for (std::size_t i = 0; i < _models; ++i)
+  {
+    models
+      << "<model name='box_" << i << "'>"
+      << "  <pose>" << i % 100 << " " << i / 100 << " 0.5 0 0 0</pose>"
+      << "  <static>true</static>"
+      << "  <link name='link'>"
+      << "    <visual name='visual'>"
+      << "      <geometry><box><size>0.5 0.5 0.5</size></box></geometry>"
+      << "    </visual>"
+      << "  </link>"
+      << "</model>";
+  }
+
+  return std::string("<?xml version='1.0'?>") +
+      "<sdf version='1.6'>"
+      "<world name='default'>" + models.str() +
+      "<plugin"
+      "  filename='ignition-gazebo-scene-broadcaster-system'"
+      "  name='ignition::gazebo::systems::SceneBroadcaster'>"
+      "</plugin>"
+      "</world>"
+      "</sdf>";
+}
+
+/////////////////////////////////////////////////
+TEST(SceneBroadcasterPerformance, SpawnLatency)
+{
+  using namespace std::chrono;
+
+  common::Console::SetVerbosity(4);
+
+  ignition::common::setenv("IGN_GAZEBO_SYSTEM_PLUGIN_PATH",
+         (std::string(PROJECT_BINARY_PATH) + "/lib").c_str());
+
+  // Spawn an entity every few iterations
+  const std::size_t spawnPeriod = 20;
+  const std::size_t spawns = 50;
+
+  for (std::size_t modelCount : {100u, 1000u, 10000u})
+  {
+    ServerConfig serverConfig;
+    serverConfig.SetSdfString(ModelsWorld(modelCount));
+
+    gazebo::Server server(serverConfig);
+    server.SetUpdatePeriod(1ns);
+
+    std::mutex mutex;
+    Entity spawned{kNullEntity};
+    steady_clock::time_point spawnTime;
+    steady_clock::duration totalLatency{0};
+    std::size_t totalBytes{0};
+    std::size_t received{0};
+
+    test::Relay spawner;
+    spawner.OnPreUpdate(
+      [&](const UpdateInfo &_info, EntityComponentManager &_ecm)
+      {
+        if (_info.iterations % spawnPeriod != 0)
+          return;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto world = _ecm.EntityByComponents(components::World());
+        spawned = _ecm.CreateEntity();
+        _ecm.CreateComponent(spawned, components::Model());
+        _ecm.CreateComponent(spawned,
+            components::Name("spawned_" + std::to_string(spawned)));
+        _ecm.CreateComponent(spawned, components::Pose());
+        _ecm.CreateComponent(spawned, components::ParentEntity(world));
+        spawnTime = steady_clock::now();
+      });
+    server.AddSystem(spawner.systemPtr);
+
+    transport::Node node;
+    std::function<void(const msgs::SerializedStepMap &)> cb =
+        [&](const msgs::SerializedStepMap &_msg)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (spawned == kNullEntity ||
+          _msg.state().entities().find(spawned) ==
+          _msg.state().entities().end())
+      {
+        return;
+      }
+
+      totalLatency += steady_clock::now() - spawnTime;
+      totalBytes += _msg.ByteSizeLong();
+      ++received;
+      spawned = kNullEntity;
+    };
+    EXPECT_TRUE(node.Subscribe("/world/default/state", cb));
+
+    // Let the subscription be discovered before spawning
+    IGN_SLEEP_MS(500);
+
+    // Leave time for each message to be delivered before the next spawn
+    for (std::size_t i = 0; i < spawns; ++i)
+    {
+      server.Run(true, spawnPeriod, false);
+      IGN_SLEEP_MS(10);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_LT(0u, received);
+    if (received == 0)
+      continue;
+
+    igndbg << "\n" << modelCount << " models: "
+           << duration_cast<microseconds>(totalLatency).count() / received
+           << " us spawn-to-receive latency, "
+           << totalBytes / received << " bytes per change event ("
+           << received << " / " << spawns << " received)\n";
+  }
+}